@@ -0,0 +1,402 @@
+#ifndef II_GAME_COMMON_BINARY_H
+#define II_GAME_COMMON_BINARY_H
+#include "game/common/enum.h"
+#include "game/common/math.h"
+#include "game/common/random.h"
+#include "game/common/struct_tuple.h"
+#include "game/common/ustring.h"
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Compact binary encoding mirroring the overload set of Printer, so that anything that can be
+// dumped (in particular any DEBUG_STRUCT_TUPLE type) can also be written and read back exactly.
+// Integers are little-endian regardless of platform, but function pointers are stored relative to
+// an anchor function in this binary: data containing them is only meaningful to the build that
+// wrote it.
+namespace ii {
+namespace detail {
+inline void binary_function_anchor() {}
+
+inline std::intptr_t binary_function_base() {
+  return reinterpret_cast<std::intptr_t>(&binary_function_anchor);
+}
+}  // namespace detail
+
+// Fast non-cryptographic hash of encoded data (e.g. for checksums). Independent of platform.
+inline std::uint64_t hash_bytes(std::span<const std::uint8_t> bytes, std::uint64_t seed = 0) {
+  static constexpr std::uint64_t kMultiplier = 0x9e3779b97f4a7c15;
+  auto mix = [](std::uint64_t h, std::uint64_t v) {
+    h = (h ^ v) * kMultiplier;
+    return h ^ (h >> 29);
+  };
+  auto h = mix(seed, bytes.size());
+  std::size_t i = 0;
+  while (i < bytes.size()) {
+    std::uint64_t v = 0;
+    for (std::size_t j = 0; j < 8 && i < bytes.size(); ++i, ++j) {
+      v |= static_cast<std::uint64_t>(bytes[i]) << (8 * j);
+    }
+    h = mix(h, v);
+  }
+  return mix(h, h >> 32);
+}
+
+class BinaryWriter {
+public:
+  std::vector<std::uint8_t> extract() { return std::move(bytes_); }
+  std::span<const std::uint8_t> bytes() const { return bytes_; }
+  void reserve(std::size_t size) { bytes_.reserve(size); }
+  // Discards everything written, keeping the allocation for reuse.
+  void clear() { bytes_.clear(); }
+
+  BinaryWriter& put_bytes(std::span<const std::uint8_t> data) {
+    bytes_.insert(bytes_.end(), data.begin(), data.end());
+    return *this;
+  }
+
+  BinaryWriter& put_size(std::size_t size) { return put(static_cast<std::uint32_t>(size)); }
+
+  BinaryWriter& put(bool b) { return put(static_cast<std::uint8_t>(b ? 1 : 0)); }
+
+  template <std::integral T>
+  BinaryWriter& put(T v) {
+    auto u = static_cast<std::make_unsigned_t<T>>(v);
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+      bytes_.push_back(static_cast<std::uint8_t>(u >> (8 * i)));
+    }
+    return *this;
+  }
+
+  BinaryWriter& put(Enum auto v) { return put(to_underlying(v)); }
+  BinaryWriter& put(float v) { return put(std::bit_cast<std::uint32_t>(v)); }
+  BinaryWriter& put(fixed v) { return put(v.to_internal()); }
+  BinaryWriter& put(std::monostate) { return *this; }
+  BinaryWriter& put(const RandomEngine& engine) { return put(engine.state()); }
+
+  template <typename R, typename... Args>
+  BinaryWriter& put(R (*const v)(Args...)) {
+    put(v != nullptr);
+    if (v) {
+      put(static_cast<std::int64_t>(reinterpret_cast<std::intptr_t>(v) -
+                                    detail::binary_function_base()));
+    }
+    return *this;
+  }
+
+  template <glm::length_t N, typename T, glm::qualifier Q>
+  BinaryWriter& put(const glm::vec<N, T, Q>& v) {
+    for (glm::length_t i = 0; i < N; ++i) {
+      put(v[i]);
+    }
+    return *this;
+  }
+
+  template <typename C>
+  BinaryWriter& put(const std::basic_string<C>& s) {
+    put_size(s.size());
+    for (auto c : s) {
+      put(c);
+    }
+    return *this;
+  }
+
+  BinaryWriter& put(const ustring& s) {
+    put(s.encoding());
+    switch (s.encoding()) {
+    case ustring_encoding::kAscii:
+    case ustring_encoding::kUtf8:
+      return put(s.utf8());
+    case ustring_encoding::kUtf16:
+      return put(s.utf16());
+    case ustring_encoding::kUtf32:
+      return put(s.utf32());
+    }
+    return *this;
+  }
+
+  template <typename T>
+  BinaryWriter& put(const std::optional<T>& v) {
+    put(v.has_value());
+    return v ? put(*v) : *this;
+  }
+
+  template <typename T>
+  BinaryWriter& put(const std::vector<T>& v) {
+    put_size(v.size());
+    for (const auto& e : v) {
+      put(e);
+    }
+    return *this;
+  }
+
+  template <typename K, typename V>
+  BinaryWriter& put(const std::map<K, V>& v) {
+    put_size(v.size());
+    for (const auto& pair : v) {
+      put(pair.first).put(pair.second);
+    }
+    return *this;
+  }
+
+  template <typename T, std::size_t N>
+  BinaryWriter& put(const std::array<T, N>& v) {
+    for (const auto& e : v) {
+      put(e);
+    }
+    return *this;
+  }
+
+  template <typename T, typename U>
+  BinaryWriter& put(const std::pair<T, U>& v) {
+    return put(v.first).put(v.second);
+  }
+
+  template <typename... Args>
+  BinaryWriter& put(const std::tuple<Args...>& v) {
+    std::apply([&](const auto&... x) { (put(x), ...); }, v);
+    return *this;
+  }
+
+  template <typename T>
+  BinaryWriter& put(const struct_tuple_member_entry<T>& v) {
+    return put(v.value);
+  }
+
+  BinaryWriter& put(const DebugStructTuple auto& v) { return put(to_debug_tuple(v)); }
+
+private:
+  std::vector<std::uint8_t> bytes_;
+};
+
+class BinaryReader {
+public:
+  BinaryReader(std::span<const std::uint8_t> bytes) : bytes_{bytes} {}
+
+  // Reading past the end (or otherwise invalid data) sets a sticky failure flag; values read after
+  // failure are left in some valid but unspecified state.
+  bool ok() const { return ok_; }
+  bool at_end() const { return position_ == bytes_.size(); }
+  std::size_t remaining() const { return bytes_.size() - position_; }
+  void fail() { ok_ = false; }
+
+  std::span<const std::uint8_t> get_bytes(std::size_t size) {
+    if (!ok_ || size > remaining()) {
+      fail();
+      return {};
+    }
+    auto data = bytes_.subspan(position_, size);
+    position_ += size;
+    return data;
+  }
+
+  BinaryReader& get_size(std::size_t& size) {
+    std::uint32_t v = 0;
+    get(v);
+    // Every element takes at least a byte, so anything larger is certainly corrupt; checking here
+    // avoids huge allocations.
+    if (v > remaining()) {
+      fail();
+      v = 0;
+    }
+    size = v;
+    return *this;
+  }
+
+  BinaryReader& get(bool& b) {
+    std::uint8_t v = 0;
+    get(v);
+    b = v != 0;
+    return *this;
+  }
+
+  template <std::integral T>
+  BinaryReader& get(T& v) {
+    auto data = get_bytes(sizeof(T));
+    std::make_unsigned_t<T> u = 0;
+    for (std::size_t i = 0; i < data.size(); ++i) {
+      u |= static_cast<std::make_unsigned_t<T>>(static_cast<std::make_unsigned_t<T>>(data[i])
+                                                << (8 * i));
+    }
+    v = static_cast<T>(u);
+    return *this;
+  }
+
+  template <Enum E>
+  BinaryReader& get(E& v) {
+    std::underlying_type_t<E> u{};
+    get(u);
+    v = E{u};
+    return *this;
+  }
+
+  BinaryReader& get(float& v) {
+    std::uint32_t u = 0;
+    get(u);
+    v = std::bit_cast<float>(u);
+    return *this;
+  }
+
+  BinaryReader& get(fixed& v) {
+    std::int64_t u = 0;
+    get(u);
+    v = fixed::from_internal(u);
+    return *this;
+  }
+
+  BinaryReader& get(std::monostate&) { return *this; }
+
+  BinaryReader& get(RandomEngine& engine) {
+    std::uint32_t state = 0;
+    get(state);
+    engine.set_state(state);
+    return *this;
+  }
+
+  template <typename R, typename... Args>
+  BinaryReader& get(R (*&v)(Args...)) {
+    bool has_value = false;
+    std::int64_t offset = 0;
+    if (get(has_value); has_value) {
+      get(offset);
+    }
+    v = has_value && ok_ ? reinterpret_cast<R (*)(Args...)>(
+                               static_cast<std::intptr_t>(offset) + detail::binary_function_base())
+                         : nullptr;
+    return *this;
+  }
+
+  template <glm::length_t N, typename T, glm::qualifier Q>
+  BinaryReader& get(glm::vec<N, T, Q>& v) {
+    for (glm::length_t i = 0; i < N; ++i) {
+      get(v[i]);
+    }
+    return *this;
+  }
+
+  template <typename C>
+  BinaryReader& get(std::basic_string<C>& s) {
+    std::size_t size = 0;
+    get_size(size);
+    s.resize(size);
+    for (auto& c : s) {
+      get(c);
+    }
+    return *this;
+  }
+
+  BinaryReader& get(ustring& s) {
+    ustring_encoding e{};
+    get(e);
+    switch (e) {
+    case ustring_encoding::kAscii:
+    case ustring_encoding::kUtf8: {
+      std::string v;
+      get(v);
+      s = e == ustring_encoding::kAscii ? ustring::ascii(std::move(v))
+                                        : ustring::utf8(std::move(v));
+      break;
+    }
+    case ustring_encoding::kUtf16: {
+      std::u16string v;
+      get(v);
+      s = ustring::utf16(std::move(v));
+      break;
+    }
+    case ustring_encoding::kUtf32: {
+      std::u32string v;
+      get(v);
+      s = ustring::utf32(std::move(v));
+      break;
+    }
+    default:
+      fail();
+    }
+    return *this;
+  }
+
+  template <typename T>
+  BinaryReader& get(std::optional<T>& v) {
+    bool has_value = false;
+    if (get(has_value); has_value && ok_) {
+      get(v.emplace());
+    } else {
+      v.reset();
+    }
+    return *this;
+  }
+
+  template <typename T>
+  BinaryReader& get(std::vector<T>& v) {
+    std::size_t size = 0;
+    get_size(size);
+    v.resize(size);
+    for (auto& e : v) {
+      get(e);
+    }
+    return *this;
+  }
+
+  template <typename K, typename V>
+  BinaryReader& get(std::map<K, V>& v) {
+    std::size_t size = 0;
+    get_size(size);
+    v.clear();
+    for (std::size_t i = 0; i < size && ok_; ++i) {
+      K key{};
+      V value{};
+      get(key).get(value);
+      v.insert_or_assign(std::move(key), std::move(value));
+    }
+    return *this;
+  }
+
+  template <typename T, std::size_t N>
+  BinaryReader& get(std::array<T, N>& v) {
+    for (auto& e : v) {
+      get(e);
+    }
+    return *this;
+  }
+
+  template <typename T, typename U>
+  BinaryReader& get(std::pair<T, U>& v) {
+    return get(v.first).get(v.second);
+  }
+
+  template <typename... Args>
+  BinaryReader& get(std::tuple<Args...>&& v) {
+    std::apply([&](auto&... x) { (get(x), ...); }, v);
+    return *this;
+  }
+
+  template <typename T>
+  BinaryReader& get(struct_tuple_member_entry<T>& v) {
+    return get(v.value);
+  }
+
+  template <DebugStructTuple T>
+  BinaryReader& get(T& v) {
+    return get(to_debug_tuple(v));
+  }
+
+private:
+  std::span<const std::uint8_t> bytes_;
+  std::size_t position_ = 0;
+  bool ok_ = true;
+};
+
+}  // namespace ii
+
+#endif
@@ -0,0 +1,121 @@
+#include "game/common/job_pool.h"
+
+namespace ii {
+namespace {
+
+struct current_worker_t {
+  const JobPool* pool = nullptr;
+  std::uint32_t index = 0;
+};
+
+thread_local current_worker_t current_worker;
+
+}  // namespace
+
+std::uint32_t JobPool::default_worker_count() {
+  auto n = std::thread::hardware_concurrency();
+  return n ? n - 1 : 0u;
+}
+
+JobPool::JobPool(std::uint32_t worker_count) {
+  for (std::uint32_t i = 0; i <= worker_count; ++i) {
+    queues_.emplace_back(std::make_unique<queue>());
+  }
+  for (std::uint32_t i = 0; i < worker_count; ++i) {
+    workers_.emplace_back([this, i] { worker_loop(i); });
+  }
+}
+
+JobPool::~JobPool() {
+  {
+    std::lock_guard lock{wake_mutex_};
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+std::optional<std::uint32_t> JobPool::worker_index() const {
+  if (current_worker.pool == this) {
+    return current_worker.index;
+  }
+  return std::nullopt;
+}
+
+void JobPool::parallel_for(std::size_t count, const std::function<void(std::size_t)>& f) {
+  if (workers_.empty() || count <= 1) {
+    for (std::size_t i = 0; i < count; ++i) {
+      f(i);
+    }
+    return;
+  }
+
+  auto index = worker_index();
+  auto queue_index = index ? *index + 1 : 0;
+  std::atomic<std::size_t> remaining{count};
+  // Counted before pushing, so that the count never drops below the number of jobs queued.
+  {
+    std::lock_guard lock{wake_mutex_};
+    queued_ += count;
+  }
+  {
+    auto& q = *queues_[queue_index];
+    std::lock_guard lock{q.mutex};
+    // Pushed in reverse, so that this thread (popping from the back) starts with the first job.
+    for (std::size_t i = count; i > 0; --i) {
+      q.jobs.emplace_back(job{&f, i - 1, &remaining});
+    }
+  }
+  wake_.notify_all();
+
+  while (remaining.load(std::memory_order_acquire)) {
+    if (!run_one(queue_index)) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+bool JobPool::run_one(std::size_t queue_index) {
+  std::optional<job> j;
+  {
+    auto& q = *queues_[queue_index];
+    std::lock_guard lock{q.mutex};
+    if (!q.jobs.empty()) {
+      j = q.jobs.back();
+      q.jobs.pop_back();
+    }
+  }
+  for (std::size_t k = 1; !j && k < queues_.size(); ++k) {
+    auto& q = *queues_[(queue_index + k) % queues_.size()];
+    std::lock_guard lock{q.mutex};
+    if (!q.jobs.empty()) {
+      j = q.jobs.front();
+      q.jobs.pop_front();
+    }
+  }
+  if (!j) {
+    return false;
+  }
+  --queued_;
+  (*j->f)(j->i);
+  j->remaining->fetch_sub(1, std::memory_order_acq_rel);
+  return true;
+}
+
+void JobPool::worker_loop(std::uint32_t index) {
+  current_worker = {this, index};
+  while (true) {
+    if (run_one(index + 1)) {
+      continue;
+    }
+    std::unique_lock lock{wake_mutex_};
+    wake_.wait(lock, [&] { return stop_ || queued_.load(); });
+    if (stop_) {
+      return;
+    }
+  }
+}
+
+}  // namespace ii
@@ -0,0 +1,71 @@
+#ifndef II_GAME_COMMON_JOB_POOL_H
+#define II_GAME_COMMON_JOB_POOL_H
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace ii {
+
+// Small work-stealing thread pool for running short, independent jobs in parallel. Each worker has
+// its own queue, and takes work from the other queues when its own is empty. Threads waiting on a
+// batch of jobs help run them, so parallel_for() may safely be called from inside a job.
+class JobPool {
+public:
+  // Suggested number of worker threads: one fewer than the number of hardware threads, as the
+  // calling thread also runs jobs.
+  static std::uint32_t default_worker_count();
+
+  explicit JobPool(std::uint32_t worker_count);
+  ~JobPool();
+  JobPool(JobPool&&) = delete;
+  JobPool(const JobPool&) = delete;
+  JobPool& operator=(JobPool&&) = delete;
+  JobPool& operator=(const JobPool&) = delete;
+
+  std::uint32_t worker_count() const { return static_cast<std::uint32_t>(workers_.size()); }
+  // Maximum number of jobs that may run at once (workers plus the calling thread).
+  std::uint32_t concurrency() const { return worker_count() + 1; }
+  // Index of the calling thread if it's one of this pool's workers, in [0, worker_count()).
+  std::optional<std::uint32_t> worker_index() const;
+
+  // Calls f(i) for each i in [0, count), in parallel and in no particular order, and waits until
+  // all calls have returned.
+  void parallel_for(std::size_t count, const std::function<void(std::size_t)>& f);
+
+private:
+  struct job {
+    const std::function<void(std::size_t)>* f = nullptr;
+    std::size_t i = 0;
+    std::atomic<std::size_t>* remaining = nullptr;
+  };
+
+  struct queue {
+    std::mutex mutex;
+    std::deque<job> jobs;
+  };
+
+  // Runs one job, preferring the back of the given queue and otherwise stealing from the front of
+  // the others. Returns false if there was nothing to run.
+  bool run_one(std::size_t queue_index);
+  void worker_loop(std::uint32_t index);
+
+  // Queue 0 is shared by threads outside the pool; queue i + 1 belongs to worker i.
+  std::vector<std::unique_ptr<queue>> queues_;
+  std::vector<std::thread> workers_;
+  std::atomic<std::size_t> queued_{0};
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+  bool stop_ = false;
+};
+
+}  // namespace ii
+
+#endif
@@ -2,7 +2,10 @@
 #define II_GAME_COMMON_PRINTER_H
 #include "game/common/enum.h"
 #include "game/common/math.h"
+#include "game/common/random.h"
 #include "game/common/struct_tuple.h"
+#include "game/common/ustring.h"
+#include "game/common/ustring_convert.h"
 #include <array>
 #include <concepts>
 #include <map>
@@ -101,6 +104,18 @@ public:
         .put(')');
   }
 
+  template <glm::length_t N, typename T, glm::qualifier Q>
+  Printer& put(const glm::vec<N, T, Q>& v) {
+    std::stringstream ss;
+    for (glm::length_t i = 0; i < N; ++i) {
+      ss << (i ? ", " : "") << v[i];
+    }
+    return put('{').put(ss.str()).put('}');
+  }
+
+  Printer& put(const ustring& s) { return put('"').put(to_utf8(s)).put('"'); }
+  Printer& put(const RandomEngine& engine) { return put(engine.state()); }
+
   template <typename T>
   Printer& put(const std::optional<T>& v) {
     return v ? put('<').put(*v).put('>') : put("nullopt");
@@ -148,6 +163,11 @@ public:
     return put(']');
   }
 
+  template <typename T, typename U>
+  Printer& put(const std::pair<T, U>& v) {
+    return put('(').put(v.first).put(", ").put(v.second).put(')');
+  }
+
   template <typename... Args>
   Printer& put(const std::tuple<Args...>& v) {
     put('(');
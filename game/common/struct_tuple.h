@@ -14,33 +14,39 @@
 #define FE_IMPL(macro, a1, ...) macro(a1) __VA_OPT__(, FE_AGAIN FE_PARENS(macro, __VA_ARGS__))
 #define FE_AGAIN() FE_IMPL
 
+// Entries refer to the members of the reflected struct rather than copying them, so the same tuple
+// can be used both to inspect a value (printing, writing) and to overwrite it (reading).
 template <typename T>
 struct struct_tuple_member_entry {
   const char* name;
-  T value;
+  T& value;
 };
 template <typename T>
-inline auto make_struct_tuple_member_entry(const char* name, T&& t) {
-  return struct_tuple_member_entry<std::decay_t<T>>{name, std::forward<T>(t)};
+inline auto make_struct_tuple_member_entry(const char* name, T& t) {
+  return struct_tuple_member_entry<T>{name, t};
 }
 
+// For components, the tuple must list every member making up the component's state: snapshots
+// save and restore exactly the listed members.
 #define DEBUG_STRUCT_TUPLE_MEMBER(member) ::make_struct_tuple_member_entry(#member, x.member)
-#define DEBUG_STRUCT_TUPLE(struct_name, ...)                                    \
-  inline const char* to_debug_name(const struct_name*) { return #struct_name; } \
-  inline auto to_debug_tuple(const struct_name& x) {                            \
-    (void)x;                                                                    \
-    return std::tuple{FOR_EACH(DEBUG_STRUCT_TUPLE_MEMBER, __VA_ARGS__)};        \
-  }
-#define TEMPLATE_DEBUG_STRUCT_TUPLE(struct_name, ...)                    \
-  template <typename T>                                                  \
-  inline const char* to_debug_name(const struct_name<T>*) {              \
-    return #struct_name;                                                 \
-  }                                                                      \
-  template <typename T>                                                  \
-  inline auto to_debug_tuple(const struct_name<T>& x) {                  \
+#define DEBUG_STRUCT_TUPLE_BODY(...)                                     \
+  {                                                                      \
     (void)x;                                                             \
     return std::tuple{FOR_EACH(DEBUG_STRUCT_TUPLE_MEMBER, __VA_ARGS__)}; \
   }
+#define DEBUG_STRUCT_TUPLE(struct_name, ...)                                            \
+  inline const char* to_debug_name(const struct_name*) { return #struct_name; }         \
+  inline auto to_debug_tuple(const struct_name& x) DEBUG_STRUCT_TUPLE_BODY(__VA_ARGS__) \
+  inline auto to_debug_tuple(struct_name& x) DEBUG_STRUCT_TUPLE_BODY(__VA_ARGS__)
+#define TEMPLATE_DEBUG_STRUCT_TUPLE(struct_name, ...)                                      \
+  template <typename T>                                                                    \
+  inline const char* to_debug_name(const struct_name<T>*) {                                \
+    return #struct_name;                                                                   \
+  }                                                                                        \
+  template <typename T>                                                                    \
+  inline auto to_debug_tuple(const struct_name<T>& x) DEBUG_STRUCT_TUPLE_BODY(__VA_ARGS__) \
+  template <typename T>                                                                    \
+  inline auto to_debug_tuple(struct_name<T>& x) DEBUG_STRUCT_TUPLE_BODY(__VA_ARGS__)
 
 template <typename T>
 concept DebugStructTuple = requires(T x) {
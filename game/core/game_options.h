@@ -12,6 +12,10 @@ struct game_options_t {
   std::vector<std::uint32_t> replay_remote_players;
   std::uint64_t replay_min_tick_delivery_delay = 0;
   std::uint64_t replay_max_tick_delivery_delay = 0;
+  // Advance canonical state of networked games on a separate thread.
+  bool canonical_worker = false;
+  // Speculatively predict alternative remote inputs in networked games.
+  bool speculative_prediction = false;
 
   // Should probably be in-game options.
   bool windowed = false;
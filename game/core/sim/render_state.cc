@@ -8,7 +8,6 @@
 #include "game/mixer/mixer.h"
 #include "game/render/gl_renderer.h"
 #include <algorithm>
-#include <unordered_map>
 
 namespace ii {
 namespace {
@@ -26,78 +25,82 @@ RenderState::RenderState(std::uint32_t seed) : engine_{seed} {}
 void RenderState::handle_output(ISimState& state,
                                 std::vector<render::background::update>& background_updates,
                                 Mixer* mixer, SimInputAdapter* input) {
-  struct sound_average {
-    std::size_t count = 0;
-    float volume = 0.f;
-    float pan = 0.f;
-    float pitch = 0.f;
-  };
-
-  std::unordered_map<sound, sound_average> sound_map;
-  std::vector<bool> rumbled;
+  sounds_.clear();
+  rumbled_.assign(input ? input->player_count() : 0u, false);
   if (input) {
-    rumbled.resize(input->player_count());
     rumble_.resize(input->player_count());
   }
 
+  // Delayed entries are kept whole; everything else is handled now, except that sounds are kept
+  // until there's a mixer to play them.
   auto& output = state.output();
-  for (auto it = output.entries.begin(); it != output.entries.end();) {
-    auto& e = it->e;
-    if (e.delay_ticks) {
-      --e.delay_ticks;
-      ++it;
-      continue;
-    }
-
-    if (e.background) {
+  auto due = [&](std::uint32_t i) { return !output.entries[i].delay_ticks; };
+  for (auto& e : output.entries) {
+    if (!e.delay_ticks && e.background) {
       if (e.background->parallax == render::background::parallax::kLegacy_Stars) {
         handle_legacy_stars_change();
       }
       background_updates.emplace_back(*e.background);
       e.background.reset();
     }
+  }
 
-    // Particles.
-    particles_.insert(particles_.end(), e.particles.begin(), e.particles.end());
-    e.particles.clear();
-
-    // Rumble.
-    if (input) {
-      for (const auto& rumble : e.rumble) {
-        auto freq_to_u16 = [](float f) {
-          return static_cast<std::uint16_t>(std::clamp(f, 0.f, 1.f) * static_cast<float>(0xffff));
-        };
-        if (rumble.player_id < input->player_count()) {
-          rumble_t r{rumble.time_ticks, freq_to_u16(rumble.lf), freq_to_u16(rumble.hf)};
-          rumble_[rumble.player_id].emplace_back(r);
-          rumbled[rumble.player_id] = true;
-        }
-      }
+  // Particles.
+  for (const auto& p : output.particles) {
+    if (due(p.entry)) {
+      particles_.emplace_back(p.value);
     }
-    e.rumble.clear();  // Always clear rumble, since either handling it now or never.
-
-    // Sounds.
-    if (mixer) {
-      for (const auto& entry : e.sounds) {
-        auto& s = sound_map[entry.sound_id];
-        ++s.count;
-        s.volume += entry.volume;
-        s.pan += entry.pan;
-        s.pitch = entry.pitch;
-      }
-      e.sounds.clear();
+  }
+
+  // Rumble.
+  for (const auto& r : output.rumble) {
+    if (!input || !due(r.entry)) {
+      continue;
+    }
+    auto freq_to_u16 = [](float f) {
+      return static_cast<std::uint16_t>(std::clamp(f, 0.f, 1.f) * static_cast<float>(0xffff));
+    };
+    const auto& rumble = r.value;
+    if (rumble.player_id < input->player_count()) {
+      rumble_[rumble.player_id].emplace_back(
+          rumble_t{rumble.time_ticks, freq_to_u16(rumble.lf), freq_to_u16(rumble.hf)});
+      rumbled_[rumble.player_id] = true;
     }
+  }
 
-    if (!e.background && e.particles.empty() && e.sounds.empty() && e.rumble.empty()) {
-      it = output.entries.erase(it);
-    } else {
-      ++it;
+  // Sounds.
+  for (const auto& s : output.sounds) {
+    if (!mixer || !due(s.entry)) {
+      continue;
     }
+    const auto& entry = s.value;
+    auto it = std::find_if(sounds_.begin(), sounds_.end(),
+                           [&](const sound_average& a) { return a.sound_id == entry.sound_id; });
+    auto& a = it == sounds_.end() ? sounds_.emplace_back(sound_average{entry.sound_id}) : *it;
+    ++a.count;
+    a.volume += entry.volume;
+    a.pan += entry.pan;
+    a.pitch = entry.pitch;
+  }
+
+  std::erase_if(output.particles, [&](const auto& p) { return due(p.entry); });
+  // Always clear rumble, since either handling it now or never.
+  std::erase_if(output.rumble, [&](const auto& r) { return due(r.entry); });
+  if (mixer) {
+    std::erase_if(output.sounds, [&](const auto& s) { return due(s.entry); });
+  }
+  keep_entries_.assign(output.entries.size(), false);
+  for (const auto& s : output.sounds) {
+    keep_entries_[s.entry] = true;
+  }
+  output.retain([&](std::uint32_t i) { return !due(i) || keep_entries_[i]; });
+  for (auto& e : output.entries) {
+    e.delay_ticks && --e.delay_ticks;
   }
 
   // Final resolution.
   for (std::uint32_t i = 0; input && i < input->player_count(); ++i) {
-    if (rumbled[i]) {
+    if (rumbled_[i]) {
       // TODO: screen shake?
       auto r = resolve_rumble(i);
       auto ms = static_cast<std::uint32_t>(
@@ -106,12 +109,11 @@ void RenderState::handle_output(ISimState& state,
     }
   }
 
-  for (auto& pair : sound_map) {
-    auto& e = pair.second;
+  for (auto& e : sounds_) {
     e.volume = std::max(0.f, std::min(1.f, e.volume));
-    e.pan = e.pan / static_cast<float>(pair.second.count);
+    e.pan = e.pan / static_cast<float>(e.count);
     e.pitch = std::pow(2.f, e.pitch);
-    mixer->play(static_cast<ii::Mixer::audio_handle_t>(pair.first), e.volume, e.pan, e.pitch);
+    mixer->play(static_cast<ii::Mixer::audio_handle_t>(e.sound_id), e.volume, e.pan, e.pitch);
   }
 }
 
@@ -6,6 +6,7 @@
 #include "game/render/data/background.h"
 #include "game/render/data/fx.h"
 #include "game/render/data/shapes.h"
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -36,6 +37,18 @@ private:
   ivec2 dimensions_{0, 0};
   std::vector<particle> particles_;
 
+  // Scratch space for handle_output(), kept to avoid reallocating every frame.
+  struct sound_average {
+    sound sound_id{0};
+    std::size_t count = 0;
+    float volume = 0.f;
+    float pan = 0.f;
+    float pitch = 0.f;
+  };
+  std::vector<sound_average> sounds_;
+  std::vector<bool> rumbled_;
+  std::vector<bool> keep_entries_;
+
   struct rumble_t {
     std::uint32_t time_ticks = 0;
     std::uint16_t lf = 0;
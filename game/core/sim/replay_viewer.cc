@@ -5,6 +5,7 @@
 #include "game/core/sim/render_state.h"
 #include "game/data/replay.h"
 #include "game/logic/sim/networked_sim_state.h"
+#include "game/logic/sim/replay_playback.h"
 #include "game/logic/sim/sim_state.h"
 #include "game/render/gl_renderer.h"
 #include <algorithm>
@@ -18,6 +19,7 @@ namespace {
 constexpr std::array kSpeedFrames = {1u, 2u, 4u, 8u, 16u, 32u, 64u};
 constexpr std::array kSpeedParticleFrames = {1u, 1u, 1u, 1u, 2u, 4u, 8u};
 constexpr std::array kSpeedPreRenderFrames = {0u, 1u, 3u, 6u, 14u, 30u, 61u};
+constexpr std::uint32_t kSeekSeconds = 10;
 }  // namespace
 
 struct ReplayViewer::impl_t {
@@ -34,7 +36,7 @@ struct ReplayViewer::impl_t {
   transient_render_state transients;
   std::uint32_t speed = 0;
   std::uint32_t audio_tick = 0;
-  std::unique_ptr<SimState> state;
+  std::unique_ptr<ReplayPlayback> playback;
 
   struct replay_network_packet {
     std::uint64_t delivery_tick_count = 0;
@@ -45,7 +47,7 @@ struct ReplayViewer::impl_t {
   std::unique_ptr<NetworkedSimState> network_state;
 
   ISimState& istate() const {
-    return network_state ? static_cast<ISimState&>(*network_state) : *state;
+    return network_state ? static_cast<ISimState&>(*network_state) : playback->state();
   }
 };
 
@@ -57,7 +59,7 @@ ReplayViewer::ReplayViewer(ui::GameStack& stack, data::ReplayReader&& replay)
   auto conditions = impl_->reader.initial_conditions();
   const auto& remote_players = stack.options().replay_remote_players;
   if (remote_players.empty()) {
-    impl_->state = std::make_unique<SimState>(conditions);
+    impl_->playback = std::make_unique<ReplayPlayback>(impl_->reader);
     return;
   }
 
@@ -87,7 +89,8 @@ void ReplayViewer::update_content(const ui::input_frame& input, ui::output_frame
     return;
   }
 
-  if (impl_->istate().game_over()) {
+  // A corrupt replay block ends playback early.
+  if (impl_->istate().game_over() || !impl_->reader.status()) {
     stack().play_sound(sound::kMenuAccept);
     impl_->hud->remove();
     remove();
@@ -96,9 +99,8 @@ void ReplayViewer::update_content(const ui::input_frame& input, ui::output_frame
 
   const auto& remote_players = stack().options().replay_remote_players;
   for (std::uint32_t i = 0; i < kSpeedFrames[impl_->speed]; ++i) {
-    if (impl_->state) {
-      auto input = impl_->reader.next_tick_input_frames();
-      impl_->state->update(input);
+    if (impl_->playback) {
+      impl_->playback->update();
     } else {
       auto frames = impl_->reader.next_tick_input_frames();
       std::vector<input_frame> local_frames;
@@ -152,6 +154,13 @@ void ReplayViewer::update_content(const ui::input_frame& input, ui::output_frame
   if (input.pressed(ui::key::kDown) && impl_->speed) {
     --impl_->speed;
   }
+  if (impl_->playback && (input.pressed(ui::key::kLeft) || input.pressed(ui::key::kRight))) {
+    auto seek_ticks = std::uint64_t{kSeekSeconds} * impl_->playback->state().fps();
+    auto tick = impl_->playback->tick_count();
+    impl_->playback->seek(input.pressed(ui::key::kLeft) ? tick - std::min(tick, seek_ticks)
+                                                        : tick + seek_ticks);
+    impl_->transients = {};
+  }
 
   if (input.pressed(ui::key::kStart) || input.pressed(ui::key::kEscape) ||
       sim_should_pause(stack())) {
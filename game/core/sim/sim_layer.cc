@@ -1,4 +1,5 @@
 #include "game/core/sim/sim_layer.h"
+#include "game/common/job_pool.h"
 #include "game/core/game_options.h"
 #include "game/core/layers/utility.h"
 #include "game/core/sim/hud_layer.h"
@@ -15,8 +16,11 @@
 #include "game/system/system.h"
 #include <algorithm>
 #include <charconv>
+#include <chrono>
 #include <cstdint>
 #include <sstream>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace ii {
@@ -29,6 +33,28 @@ std::uint64_t estimate_tick(std::uint32_t fps, const NetworkedSimState::remote_s
              std::ceil(static_cast<float>(fps) * static_cast<float>(session.ping_ms) / 2000.f));
 };
 
+// Average time per tick spent in each phase of the sim, and the most expensive update functions.
+std::string profiler_debug_text(const SimState::phase_timings& t) {
+  static constexpr std::size_t kMaxUpdateFunctions = 4;
+  auto us = [](std::chrono::nanoseconds d, std::uint64_t n) {
+    return std::to_string(n ? d.count() / static_cast<std::int64_t>(1000 * n) : 0) + "us";
+  };
+  std::string debug;
+  debug += "begin: " + us(t.begin_tick, t.ticks);
+  debug += "\nupdate: " + us(t.update, t.ticks);
+  debug += "\ncollision: " + us(t.collision, t.ticks);
+  debug += "\ndestroy: " + us(t.destroy, t.ticks);
+  debug += "\ncompact: " + us(t.compaction, t.ticks);
+  debug += "\npost: " + us(t.post_update, t.ticks);
+  debug += "\nend: " + us(t.end_tick, t.ticks);
+  debug += "\nrender: " + us(t.render, t.frames);
+  auto functions = t.sorted_update_functions();
+  for (std::size_t i = 0; i < std::min(kMaxUpdateFunctions, functions.size()); ++i) {
+    debug += "\n" + functions[i]->name + ": " + us(functions[i]->time, t.ticks);
+  }
+  return debug;
+}
+
 }  // namespace
 
 // TODO: handle input device issues (not enough, unplugged, etc).
@@ -44,8 +70,23 @@ struct SimLayer::impl_t {
   , network{std::move(network)} {
     if (this->network) {
       networked_state = std::make_unique<NetworkedSimState>(conditions, *this->network, &writer);
+      networked_state->set_job_pool(&job_pool);
+      networked_state->set_speculative_prediction(options.speculative_prediction);
+      if (options.canonical_worker) {
+        networked_state->enable_canonical_worker();
+      }
+      packet_encoder.emplace(
+          static_cast<std::uint32_t>(this->network->local.player_numbers.size()));
+      for (const auto& pair : this->network->remote) {
+        packet_decoders.emplace(pair.first,
+                                static_cast<std::uint32_t>(pair.second.player_numbers.size()));
+      }
     } else {
       state = std::make_unique<SimState>(conditions, &writer, options.ai_players);
+      state->set_job_pool(&job_pool);
+      if (SimState::kProfilerEnabled) {
+        state->set_phase_timings(&profile);
+      }
     }
   }
 
@@ -61,9 +102,15 @@ struct SimLayer::impl_t {
   transient_render_state transients;
   SimInputAdapter input;
   data::ReplayWriter writer;
+  JobPool job_pool{JobPool::default_worker_count()};
+  // Accumulated over a second or so at a time, for the debug HUD.
+  SimState::phase_timings profile;
   std::unique_ptr<SimState> state;
   std::unique_ptr<NetworkedSimState> networked_state;
   std::optional<network_input_mapping> network;
+  // Sim packet input frames are delta-encoded against the previous packet from the same sender.
+  std::optional<data::InputFrameEncoder> packet_encoder;
+  std::unordered_map</* remote ID */ std::string, data::InputFrameDecoder> packet_decoders;
 
   struct network_frame_diff_t {
     bool ahead = false;
@@ -141,8 +188,14 @@ void SimLayer::update_content(const ui::input_frame& ui_input, ui::output_frame&
   } else {
     impl_->state->ai_think(sim_input);
     impl_->state->update(sim_input);
+    if (SimState::kProfilerEnabled && impl_->profile.ticks >= stack().fps()) {
+      impl_->hud->set_debug_text(0, profiler_debug_text(impl_->profile));
+      impl_->profile = {};
+    }
   }
 
+  stack().stream_replay(impl_->writer);
+
   bool handle_audio = !(impl_->audio_tick++ % (stack().fps() >= 60 ? 5 : 4));
   impl_->render_state.set_dimensions(impl_->istate().dimensions());
   std::vector<render::background::update> background_updates;
@@ -213,6 +266,9 @@ std::string SimLayer::network_debug_text(std::uint32_t index) {
     debug += "\nquality: " + std::to_string(session->quality);
     debug += "\nfdiff: " + std::to_string(fdiff);
     debug += "\nfpred: " + std::to_string(stats.latest_tick - stats.canonical_tick);
+    debug += "\nrollback: " + std::to_string(stats.rollback_ticks) + "/" +
+        std::to_string(stats.rollback_depth);
+    debug += "\nhypo: " + std::to_string(stats.hypotheses_adopted);
     return debug;
   }
   return {};
@@ -238,7 +294,11 @@ void SimLayer::networked_update(std::vector<input_frame>&& local_input) {
   std::vector<System::received_message> messages;
   stack().system().receive(data::sim_packet::kChannel, messages);
   for (const auto& m : messages) {
-    auto packet = data::read_sim_packet(m.bytes);
+    auto it = impl_->packet_decoders.find(std::to_string(m.source_user_id));
+    if (it == impl_->packet_decoders.end()) {
+      continue;  // Unknown remote.
+    }
+    auto packet = data::read_sim_packet(m.bytes, &it->second);
     if (!packet) {
       disconnect_with_error(ustring::ascii("Error reading sim packet: " + packet.error()));
       return;
@@ -262,7 +322,7 @@ void SimLayer::networked_update(std::vector<input_frame>&& local_input) {
   for (std::uint32_t i = 0; i < frame_count; ++i) {
     auto packets = impl_->networked_state->update(local_input);
     for (const auto& packet : packets) {
-      auto bytes = data::write_sim_packet(packet);
+      auto bytes = data::write_sim_packet(packet, &*impl_->packet_encoder);
       if (!bytes) {
         disconnect_with_error(ustring::ascii("Error sending sim packet: " + bytes.error()));
         return;
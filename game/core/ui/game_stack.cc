@@ -12,6 +12,8 @@
 namespace ii::ui {
 namespace {
 const char* kSaveName = "space";
+// Replay of the game in progress; renamed once the game ends and the final score is known.
+const char* kStreamingReplayName = "in_progress";
 constexpr std::uint32_t kCursorFrames = 32u;
 
 template <typename It>
@@ -232,7 +234,13 @@ void GameStack::write_savegame() {
   }
 }
 
-void GameStack::write_replay(const data::ReplayWriter& writer, const std::string& name,
+void GameStack::stream_replay(data::ReplayWriter& writer) {
+  if (writer.has_unflushed_blocks()) {
+    (void)writer.flush_replay(fs_, kStreamingReplayName, /* end_block */ false);
+  }
+}
+
+void GameStack::write_replay(data::ReplayWriter& writer, const std::string& name,
                              std::uint64_t score) {
   std::stringstream ss;
   auto mode = writer.initial_conditions().mode;
@@ -244,6 +252,10 @@ void GameStack::write_replay(const data::ReplayWriter& writer, const std::string
                                                : "")
      << name << "_" << score;
 
+  if (writer.flush_replay(fs_, kStreamingReplayName, /* end_block */ true) &&
+      fs_.rename_replay(kStreamingReplayName, ss.str())) {
+    return;
+  }
   auto data = writer.write();
   if (data) {
     (void)fs_.write_replay(ss.str(), *data);
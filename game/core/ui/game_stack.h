@@ -110,7 +110,9 @@ public:
 
   void write_config();
   void write_savegame();
-  void write_replay(const data::ReplayWriter& writer, const std::string& name, std::uint64_t score);
+  // Streams completed replay blocks to disk during the game, so a crash still leaves a replay.
+  void stream_replay(data::ReplayWriter& writer);
+  void write_replay(data::ReplayWriter& writer, const std::string& name, std::uint64_t score);
 
   void set_volume(float volume);
   void play_sound(sound s);
@@ -0,0 +1,192 @@
+#include "game/data/input_codec.h"
+#include <algorithm>
+
+namespace ii::data {
+namespace {
+
+// Each token starts with a varint header. If the low bit is set, the rest is the length of a run of
+// unchanged frames. Otherwise, the rest is a mask of the fields that changed, and the new values
+// follow: deltas (zigzag varints) for velocity and target coordinates, and keys as a plain varint.
+constexpr std::uint64_t kRunBit = 1;
+constexpr std::uint64_t kVelocity = 0b00001;
+constexpr std::uint64_t kTarget = 0b00010;
+constexpr std::uint64_t kTargetAbsolute = 0b00100;
+constexpr std::uint64_t kTargetRelative = 0b01000;
+constexpr std::uint64_t kKeys = 0b10000;
+constexpr std::uint32_t kMaxVarintBytes = 10;
+
+// Matches write_input_frame(): a relative target takes precedence over an absolute one.
+input_frame normalize(const input_frame& frame) {
+  auto result = frame;
+  if (result.target_relative) {
+    result.target_absolute.reset();
+  }
+  return result;
+}
+
+std::uint64_t target_kind(const input_frame& frame) {
+  return frame.target_relative ? kTargetRelative
+      : frame.target_absolute  ? kTargetAbsolute
+                               : 0;
+}
+
+vec2 target_value(const input_frame& frame) {
+  return frame.target_relative ? *frame.target_relative
+      : frame.target_absolute  ? *frame.target_absolute
+                               : vec2{0};
+}
+
+void write_varint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+  while (value >= 0x80) {
+    out.emplace_back(static_cast<std::uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out.emplace_back(static_cast<std::uint8_t>(value));
+}
+
+// Writes the difference between fixed-point values (wrapping on overflow) as a zigzag varint.
+void write_delta(std::vector<std::uint8_t>& out, fixed value, fixed previous) {
+  auto delta = static_cast<std::uint64_t>(value.to_internal()) -
+      static_cast<std::uint64_t>(previous.to_internal());
+  auto sign = static_cast<std::uint64_t>(static_cast<std::int64_t>(delta) >> 63);
+  write_varint(out, (delta << 1) ^ sign);
+}
+
+struct reader {
+  std::span<const std::uint8_t> bytes;
+  std::size_t position = 0;
+  bool error = false;
+
+  std::uint64_t varint() {
+    std::uint64_t value = 0;
+    for (std::uint32_t i = 0; i < kMaxVarintBytes; ++i) {
+      if (position >= bytes.size()) {
+        break;
+      }
+      auto byte = bytes[position++];
+      value |= static_cast<std::uint64_t>(byte & 0x7f) << (7 * i);
+      if (!(byte & 0x80)) {
+        return value;
+      }
+    }
+    error = true;
+    return 0;
+  }
+
+  fixed delta(fixed previous) {
+    auto zigzag = varint();
+    auto delta = (zigzag >> 1) ^ (0 - (zigzag & 1));
+    return fixed::from_internal(
+        static_cast<std::int64_t>(static_cast<std::uint64_t>(previous.to_internal()) + delta));
+  }
+};
+
+}  // namespace
+
+InputFrameEncoder::InputFrameEncoder(std::uint32_t player_count)
+: previous_(std::max(1u, player_count)) {}
+
+void InputFrameEncoder::encode(std::span<const input_frame> frames,
+                               std::vector<std::uint8_t>& out) {
+  std::uint64_t run = 0;
+  for (const auto& f : frames) {
+    auto frame = normalize(f);
+    auto& previous = previous_[next_player_];
+    next_player_ = (next_player_ + 1) % previous_.size();
+    if (frame == previous) {
+      ++run;
+      continue;
+    }
+    if (run) {
+      write_varint(out, run << 1 | kRunBit);
+      run = 0;
+    }
+
+    std::uint64_t mask = 0;
+    if (frame.velocity != previous.velocity) {
+      mask |= kVelocity;
+    }
+    if (frame.target_absolute != previous.target_absolute ||
+        frame.target_relative != previous.target_relative) {
+      mask |= kTarget | target_kind(frame);
+    }
+    if (frame.keys != previous.keys) {
+      mask |= kKeys;
+    }
+    write_varint(out, mask << 1);
+    if (mask & kVelocity) {
+      write_delta(out, frame.velocity.x, previous.velocity.x);
+      write_delta(out, frame.velocity.y, previous.velocity.y);
+    }
+    if (mask & (kTargetAbsolute | kTargetRelative)) {
+      auto target = target_value(frame);
+      auto previous_target = target_value(previous);
+      write_delta(out, target.x, previous_target.x);
+      write_delta(out, target.y, previous_target.y);
+    }
+    if (mask & kKeys) {
+      write_varint(out, frame.keys);
+    }
+    previous = frame;
+  }
+  if (run) {
+    write_varint(out, run << 1 | kRunBit);
+  }
+}
+
+InputFrameDecoder::InputFrameDecoder(std::uint32_t player_count)
+: previous_(std::max(1u, player_count)) {}
+
+result<void> InputFrameDecoder::decode(std::span<const std::uint8_t> bytes,
+                                       std::size_t frame_count, std::vector<input_frame>& out) {
+  reader r{bytes};
+  auto next = [&]() -> input_frame& {
+    auto& previous = previous_[next_player_];
+    next_player_ = (next_player_ + 1) % previous_.size();
+    return previous;
+  };
+
+  std::size_t decoded = 0;
+  while (decoded < frame_count && !r.error && r.position < bytes.size()) {
+    auto header = r.varint();
+    if (header & kRunBit) {
+      auto run = header >> 1;
+      if (!run || run > frame_count - decoded) {
+        return unexpected("invalid input frame data");
+      }
+      for (std::uint64_t i = 0; i < run; ++i) {
+        out.emplace_back(next());
+      }
+      decoded += run;
+      continue;
+    }
+
+    auto mask = header >> 1;
+    auto& frame = next();
+    if (mask & kVelocity) {
+      frame.velocity.x = r.delta(frame.velocity.x);
+      frame.velocity.y = r.delta(frame.velocity.y);
+    }
+    if (mask & kTarget) {
+      auto target = target_value(frame);
+      frame.target_absolute.reset();
+      frame.target_relative.reset();
+      if (mask & (kTargetAbsolute | kTargetRelative)) {
+        target.x = r.delta(target.x);
+        target.y = r.delta(target.y);
+        (mask & kTargetRelative ? frame.target_relative : frame.target_absolute) = target;
+      }
+    }
+    if (mask & kKeys) {
+      frame.keys = static_cast<std::uint32_t>(r.varint());
+    }
+    out.emplace_back(frame);
+    ++decoded;
+  }
+  if (r.error || decoded != frame_count || r.position != bytes.size()) {
+    return unexpected("invalid input frame data");
+  }
+  return {};
+}
+
+}  // namespace ii::data
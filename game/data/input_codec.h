@@ -0,0 +1,48 @@
+#ifndef II_GAME_DATA_INPUT_CODEC_H
+#define II_GAME_DATA_INPUT_CODEC_H
+#include "game/common/result.h"
+#include "game/logic/sim/io/player.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace ii::data {
+
+// Compact input frame encoding shared by replays and sim packets. Frames are interleaved by player:
+// the i-th frame passed in belongs to player (i % player_count), and is delta-encoded against that
+// player's previous frame (initially a default frame). Runs of frames equal to their player's
+// previous frame are run-length encoded.
+//
+// Encoder and decoder state carries over from one call to the next, so a decoder must be given
+// exactly the sequence of encoded chunks produced by the matching encoder, in order.
+class InputFrameEncoder {
+public:
+  explicit InputFrameEncoder(std::uint32_t player_count);
+
+  // Appends an encoding of the frames to the output. Each call is self-contained: runs don't extend
+  // across calls.
+  void encode(std::span<const input_frame> frames, std::vector<std::uint8_t>& out);
+
+private:
+  std::vector<input_frame> previous_;
+  std::size_t next_player_ = 0;
+};
+
+class InputFrameDecoder {
+public:
+  explicit InputFrameDecoder(std::uint32_t player_count);
+
+  // Decodes exactly frame_count frames from a chunk produced by one InputFrameEncoder::encode()
+  // call, appending them to the output.
+  result<void> decode(std::span<const std::uint8_t> bytes, std::size_t frame_count,
+                      std::vector<input_frame>& out);
+
+private:
+  std::vector<input_frame> previous_;
+  std::size_t next_player_ = 0;
+};
+
+}  // namespace ii::data
+
+#endif
@@ -6,10 +6,12 @@
 #include <algorithm>
 #include <array>
 #include <sstream>
+#include <string>
 
 namespace ii::data {
 
-result<sim_packet> read_sim_packet(std::span<const std::uint8_t> bytes) {
+result<sim_packet>
+read_sim_packet(std::span<const std::uint8_t> bytes, InputFrameDecoder* decoder) {
   auto proto = read_proto<proto::SimPacket>(bytes);
   if (!proto) {
     return unexpected(proto.error());
@@ -17,11 +19,27 @@ result<sim_packet> read_sim_packet(std::span<const std::uint8_t> bytes) {
 
   sim_packet data;
   data.tick_count = proto->tick_count();
-  for (const auto& frame : proto->input_frame()) {
-    data.input_frames.emplace_back(read_input_frame(frame));
+  if (proto->input_frame_count()) {
+    if (proto->packed_input_delta() && !decoder) {
+      return unexpected("sim packet requires an input frame decoder");
+    }
+    InputFrameDecoder packet_decoder{proto->input_frame_count()};
+    auto& frame_decoder = proto->packed_input_delta() ? *decoder : packet_decoder;
+    const auto& packed = proto->packed_input_frames();
+    auto result = frame_decoder.decode(
+        {reinterpret_cast<const std::uint8_t*>(packed.data()), packed.size()},
+        proto->input_frame_count(), data.input_frames);
+    if (!result) {
+      return unexpected(result.error());
+    }
+  } else {
+    for (const auto& frame : proto->input_frame()) {
+      data.input_frames.emplace_back(read_input_frame(frame));
+    }
   }
   data.canonical_tick_count = proto->canonical_tick_count();
   data.canonical_checksum = proto->canonical_checksum();
+  data.canonical_checksum_tier = proto->canonical_checksum_tier();
   return {data};
 }
 
@@ -75,14 +93,22 @@ result<lobby_request_packet> read_lobby_request_packet(std::span<const std::uint
   return {std::move(data)};
 }
 
-result<std::vector<std::uint8_t>> write_sim_packet(const sim_packet& data) {
+result<std::vector<std::uint8_t>>
+write_sim_packet(const sim_packet& data, InputFrameEncoder* encoder) {
   proto::SimPacket proto;
   proto.set_tick_count(data.tick_count);
-  for (const auto& frame : data.input_frames) {
-    *proto.add_input_frame() = write_input_frame(frame);
+  if (!data.input_frames.empty()) {
+    auto frame_count = static_cast<std::uint32_t>(data.input_frames.size());
+    InputFrameEncoder packet_encoder{frame_count};
+    std::vector<std::uint8_t> packed;
+    (encoder ? *encoder : packet_encoder).encode(data.input_frames, packed);
+    proto.set_input_frame_count(frame_count);
+    proto.set_packed_input_frames(std::string{packed.begin(), packed.end()});
+    proto.set_packed_input_delta(encoder != nullptr);
   }
   proto.set_canonical_tick_count(data.canonical_tick_count);
   proto.set_canonical_checksum(data.canonical_checksum);
+  proto.set_canonical_checksum_tier(data.canonical_checksum_tier);
   return write_proto(proto);
 }
 
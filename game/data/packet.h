@@ -1,6 +1,7 @@
 #ifndef II_GAME_DATA_PACKET_H
 #define II_GAME_DATA_PACKET_H
 #include "game/common/result.h"
+#include "game/data/input_codec.h"
 #include "game/logic/sim/io/conditions.h"
 #include "game/logic/sim/io/player.h"
 #include <cstdint>
@@ -21,6 +22,7 @@ struct sim_packet {
   // Tick count at which canonical state is known, and optional checksum thereof.
   std::uint64_t canonical_tick_count = 0;
   std::uint32_t canonical_checksum = 0;  // Zero to skip verification.
+  std::uint32_t canonical_checksum_tier = 0;  // SimState::checksum_tier.
 };
 
 // Sent from host to all lobby members on lobby state change.
@@ -68,10 +70,14 @@ struct lobby_request_packet {
   std::vector<slot_info> slots;
 };
 
-result<sim_packet> read_sim_packet(std::span<const std::uint8_t>);
+// Input frames of sim packets are delta-encoded against the previous packet if an encoder is given.
+// Such packets must then be read in order, with a decoder dedicated to the sender.
+result<sim_packet> read_sim_packet(std::span<const std::uint8_t>,
+                                   InputFrameDecoder* decoder = nullptr);
 result<lobby_update_packet> read_lobby_update_packet(std::span<const std::uint8_t>);
 result<lobby_request_packet> read_lobby_request_packet(std::span<const std::uint8_t>);
-result<std::vector<std::uint8_t>> write_sim_packet(const sim_packet&);
+result<std::vector<std::uint8_t>> write_sim_packet(const sim_packet&,
+                                                   InputFrameEncoder* encoder = nullptr);
 result<std::vector<std::uint8_t>> write_lobby_update_packet(const lobby_update_packet&);
 result<std::vector<std::uint8_t>> write_lobby_request_packet(const lobby_request_packet&);
 
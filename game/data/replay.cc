@@ -2,11 +2,15 @@
 #include "game/common/math.h"
 #include "game/data/conditions.h"
 #include "game/data/crypt.h"
+#include "game/data/input_codec.h"
 #include "game/data/input_frame.h"
 #include "game/data/proto/replay.pb.h"
 #include "game/data/proto_tools.h"
+#include "game/io/file/filesystem.h"
+#include <algorithm>
 #include <array>
 #include <sstream>
+#include <string>
 
 namespace ii::data {
 namespace {
@@ -29,6 +33,63 @@ const char* kLegacyReplayEncryptionKey =
     "XZUQ4A$Q5hL|fh.L}xhdJ07VDv2FQ=hi|ng9Ug%7+\"!)";
 const std::array<std::uint8_t, 2> kReplayEncryptionKey = {'<', '>'};
 
+// Chunked replay container layout:
+// - the 8-byte magic kChunkedReplayMagic;
+// - a sequence of chunks, each consisting of:
+//   - payload size (4 bytes, little-endian);
+//   - number of input frames in the chunk (4 bytes, little-endian);
+//   - payload: the serialized proto, compressed and encrypted.
+// The first chunk is a proto::ReplayHeader, and every subsequent chunk is a proto::ReplayBlock. A
+// truncated final chunk is ignored, so a replay that was cut off mid-write can still be read.
+const std::array<std::uint8_t, 8> kChunkedReplayMagic = {'i', 'i', 's', 'p', 'a', 'c', 'e', '2'};
+constexpr std::size_t kChunkHeaderSize = 8;
+constexpr std::size_t kBlockTicks = 1024;
+
+bool is_chunked_replay(std::span<const std::uint8_t> bytes) {
+  return bytes.size() >= kChunkedReplayMagic.size() &&
+      std::equal(kChunkedReplayMagic.begin(), kChunkedReplayMagic.end(), bytes.begin());
+}
+
+void write_u32(std::vector<std::uint8_t>& out, std::uint32_t value) {
+  for (std::uint32_t i = 0; i < 4; ++i) {
+    out.emplace_back(static_cast<std::uint8_t>(value >> (8 * i)));
+  }
+}
+
+std::uint32_t read_u32(std::span<const std::uint8_t> bytes) {
+  std::uint32_t value = 0;
+  for (std::uint32_t i = 0; i < 4; ++i) {
+    value |= static_cast<std::uint32_t>(bytes[i]) << (8 * i);
+  }
+  return value;
+}
+
+template <typename T>
+result<void> write_chunk(std::vector<std::uint8_t>& out, const T& proto, std::uint32_t frames) {
+  auto data = write_proto(proto);
+  if (!data) {
+    return unexpected(data.error());
+  }
+  auto compressed = compress(*data);
+  if (!compressed) {
+    return unexpected("couldn't compress replay: " + compressed.error());
+  }
+  auto payload = crypt(*compressed, kReplayEncryptionKey);
+  write_u32(out, static_cast<std::uint32_t>(payload.size()));
+  write_u32(out, frames);
+  out.insert(out.end(), payload.begin(), payload.end());
+  return {};
+}
+
+template <typename T>
+result<T> read_chunk(std::span<const std::uint8_t> payload) {
+  auto decompressed = decompress(crypt(payload, kReplayEncryptionKey));
+  if (!decompressed) {
+    return unexpected("invalid data");
+  }
+  return read_proto<T>(*decompressed);
+}
+
 result<proto::Replay> read_replay_file(std::span<const std::uint8_t> bytes) {
   auto decompressed = decompress(crypt(bytes, kReplayEncryptionKey));
   if (decompressed) {
@@ -106,35 +167,144 @@ result<proto::Replay> read_replay_file(std::span<const std::uint8_t> bytes) {
 }  // namespace
 
 struct ReplayReader::impl_t {
-  proto::Replay replay;
+  struct block_t {
+    std::size_t first_frame = 0;
+    std::size_t frame_count = 0;
+    std::span<const std::uint8_t> payload;
+  };
+
+  result<void> read(std::span<const std::uint8_t> replay_bytes);
+  result<void> read_chunked(std::span<const std::uint8_t> replay_bytes);
+  result<void> load_block(std::size_t frame);
+
   ii::initial_conditions conditions;
   std::size_t frame_index = 0;
+  std::size_t total_frames = 0;
+  std::vector<std::uint8_t> bytes;
+  std::vector<block_t> blocks;
+  // Decoded frames of the most-recently loaded block.
+  std::optional<std::size_t> loaded_block;
+  std::vector<input_frame> frames;
+  // Set if a block failed to decode; no further frames are read after that.
+  std::optional<std::string> error;
 };
 
+result<void> ReplayReader::impl_t::read(std::span<const std::uint8_t> replay_bytes) {
+  auto replay = read_replay_file(replay_bytes);
+  if (!replay) {
+    return unexpected(replay.error());
+  }
+  if (replay->game_version() != kReplayVersion && replay->game_version() != kLegacyReplayVersion) {
+    return unexpected("unknown replay game version");
+  }
+  auto conditions_result = read_initial_conditions(replay->conditions());
+  if (!conditions_result) {
+    return unexpected(conditions_result.error());
+  }
+  conditions = *conditions_result;
+
+  // Unchunked replays are decoded up front, as a single block.
+  for (const auto& frame : replay->player_frame()) {
+    frames.emplace_back(read_input_frame(frame));
+  }
+  total_frames = frames.size();
+  blocks.emplace_back(block_t{0, total_frames, {}});
+  loaded_block = 0;
+  return {};
+}
+
+result<void> ReplayReader::impl_t::read_chunked(std::span<const std::uint8_t> replay_bytes) {
+  bytes.assign(replay_bytes.begin(), replay_bytes.end());
+  bool header = true;
+  for (auto offset = kChunkedReplayMagic.size(); offset + kChunkHeaderSize <= bytes.size();) {
+    auto chunk = std::span<const std::uint8_t>{bytes}.subspan(offset);
+    auto size = read_u32(chunk);
+    auto frame_count = read_u32(chunk.subspan(4));
+    if (size > chunk.size() - kChunkHeaderSize) {
+      break;
+    }
+    auto payload = chunk.subspan(kChunkHeaderSize, size);
+    offset += kChunkHeaderSize + size;
+    if (!header) {
+      blocks.emplace_back(block_t{total_frames, frame_count, payload});
+      total_frames += frame_count;
+      continue;
+    }
+
+    auto replay_header = read_chunk<proto::ReplayHeader>(payload);
+    if (!replay_header) {
+      return unexpected(replay_header.error());
+    }
+    if (replay_header->game_version() != kReplayVersion) {
+      return unexpected("unknown replay game version");
+    }
+    auto conditions_result = read_initial_conditions(replay_header->conditions());
+    if (!conditions_result) {
+      return unexpected(conditions_result.error());
+    }
+    conditions = *conditions_result;
+    header = false;
+  }
+  if (header) {
+    return unexpected("invalid data");
+  }
+  return {};
+}
+
+result<void> ReplayReader::impl_t::load_block(std::size_t frame) {
+  if (loaded_block && frame >= blocks[*loaded_block].first_frame &&
+      frame < blocks[*loaded_block].first_frame + blocks[*loaded_block].frame_count) {
+    return {};
+  }
+  auto it = std::upper_bound(blocks.begin(), blocks.end(), frame,
+                             [](std::size_t f, const block_t& b) { return f < b.first_frame; });
+  if (it == blocks.begin()) {
+    return unexpected("no replay block for input frame " + std::to_string(frame));
+  }
+  const auto& block = *--it;
+  auto block_index = static_cast<std::size_t>(it - blocks.begin());
+  auto block_error = [&](const std::string& message) {
+    return unexpected("replay block " + std::to_string(block_index) + ": " + message);
+  };
+  auto block_proto = read_chunk<proto::ReplayBlock>(block.payload);
+  if (!block_proto) {
+    return block_error(block_proto.error());
+  }
+  loaded_block.reset();
+  frames.clear();
+  if (const auto& packed = block_proto->packed_frames(); !packed.empty()) {
+    InputFrameDecoder decoder{conditions.player_count};
+    auto result =
+        decoder.decode({reinterpret_cast<const std::uint8_t*>(packed.data()), packed.size()},
+                       block.frame_count, frames);
+    if (!result) {
+      return block_error(result.error());
+    }
+  } else {
+    for (const auto& f : block_proto->player_frame()) {
+      frames.emplace_back(read_input_frame(f));
+    }
+  }
+  if (frames.size() != block.frame_count) {
+    return block_error("expected " + std::to_string(block.frame_count) + " input frames, got " +
+                       std::to_string(frames.size()));
+  }
+  loaded_block = block_index;
+  return {};
+}
+
 ReplayReader::~ReplayReader() = default;
 ReplayReader::ReplayReader(ReplayReader&&) noexcept = default;
 ReplayReader& ReplayReader::operator=(ReplayReader&&) noexcept = default;
 
 result<ReplayReader> ReplayReader::create(std::span<const std::uint8_t> bytes) {
-  auto replay_proto = read_replay_file(bytes);
-  if (!replay_proto) {
-    return unexpected(replay_proto.error());
-  }
   ReplayReader reader;
   reader.impl_ = std::make_unique<impl_t>();
-  reader.impl_->replay = std::move(*replay_proto);
-  if (reader.impl_->replay.game_version() != kReplayVersion &&
-      reader.impl_->replay.game_version() != kLegacyReplayVersion) {
-    return unexpected("unknown replay game version");
+  auto result = is_chunked_replay(bytes) ? reader.impl_->read_chunked(bytes)
+                                         : reader.impl_->read(bytes);
+  if (!result) {
+    return unexpected(result.error());
   }
-
-  auto& conditions = reader.impl_->conditions;
-  auto& replay = reader.impl_->replay;
-  auto conditions_result = read_initial_conditions(replay.conditions());
-  if (!conditions_result) {
-    return unexpected(conditions_result.error());
-  }
-  conditions = *conditions_result;
   return {std::move(reader)};
 }
 
@@ -143,10 +313,15 @@ ii::initial_conditions ReplayReader::initial_conditions() const {
 }
 
 std::optional<input_frame> ReplayReader::next_input_frame() {
-  if (impl_->frame_index >= total_input_frames()) {
+  if (impl_->error || impl_->frame_index >= total_input_frames()) {
     return std::nullopt;
   }
-  return read_input_frame(impl_->replay.player_frame(impl_->frame_index++));
+  if (auto r = impl_->load_block(impl_->frame_index); !r) {
+    impl_->error = r.error();
+    return std::nullopt;
+  }
+  const auto& block = impl_->blocks[*impl_->loaded_block];
+  return impl_->frames[impl_->frame_index++ - block.first_frame];
 }
 
 std::vector<input_frame> ReplayReader::next_tick_input_frames() {
@@ -162,21 +337,79 @@ std::vector<input_frame> ReplayReader::next_tick_input_frames() {
   return frames;
 }
 
+result<void> ReplayReader::status() const {
+  if (impl_->error) {
+    return unexpected(*impl_->error);
+  }
+  return {};
+}
+
 std::size_t ReplayReader::current_input_frame() const {
   return impl_->frame_index;
 }
 
 std::size_t ReplayReader::total_input_frames() const {
-  return impl_->replay.player_frame().size();
+  return impl_->total_frames;
+}
+
+void ReplayReader::seek_input_frame(std::size_t index) {
+  impl_->frame_index = std::min(index, total_input_frames());
 }
 
 ReplayReader::ReplayReader() = default;
 
 struct ReplayWriter::impl_t {
+  result<void> write_block(std::vector<std::uint8_t>& out) const;
+  void end_block();
+  template <typename F>
+  result<void> flush(const F& write);
+
   ii::initial_conditions conditions;
-  proto::Replay replay;
+  // Chunked replay bytes for the header and all completed blocks.
+  std::vector<std::uint8_t> bytes;
+  std::size_t flushed_size = 0;
+  std::size_t frame_count = 0;
+  std::vector<input_frame> block_frames;
+  std::optional<std::string> error;
 };
 
+result<void> ReplayWriter::impl_t::write_block(std::vector<std::uint8_t>& out) const {
+  proto::ReplayBlock block;
+  block.set_tick_index((frame_count - block_frames.size()) /
+                       std::max(1u, conditions.player_count));
+  std::vector<std::uint8_t> packed;
+  InputFrameEncoder{conditions.player_count}.encode(block_frames, packed);
+  block.set_packed_frames(std::string{packed.begin(), packed.end()});
+  return write_chunk(out, block, static_cast<std::uint32_t>(block_frames.size()));
+}
+
+void ReplayWriter::impl_t::end_block() {
+  if (block_frames.empty()) {
+    return;
+  }
+  if (auto r = write_block(bytes); !r && !error) {
+    error = r.error();
+  }
+  block_frames.clear();
+}
+
+template <typename F>
+result<void> ReplayWriter::impl_t::flush(const F& write) {
+  if (error) {
+    return unexpected(*error);
+  }
+  if (flushed_size == bytes.size()) {
+    return {};
+  }
+  auto unflushed = std::span<const std::uint8_t>{bytes}.subspan(flushed_size);
+  auto result = write(unflushed, /* append */ flushed_size != 0);
+  if (!result) {
+    return unexpected(result.error());
+  }
+  flushed_size = bytes.size();
+  return {};
+}
+
 ReplayWriter::~ReplayWriter() = default;
 ReplayWriter::ReplayWriter(ReplayWriter&&) noexcept = default;
 ReplayWriter& ReplayWriter::operator=(ReplayWriter&&) noexcept = default;
@@ -184,24 +417,55 @@ ReplayWriter& ReplayWriter::operator=(ReplayWriter&&) noexcept = default;
 ReplayWriter::ReplayWriter(const ii::initial_conditions& conditions)
 : impl_{std::make_unique<impl_t>()} {
   impl_->conditions = conditions;
-  impl_->replay.set_game_version(kReplayVersion);
-  *impl_->replay.mutable_conditions() = write_initial_conditions(conditions);
+  proto::ReplayHeader header;
+  header.set_game_version(kReplayVersion);
+  *header.mutable_conditions() = write_initial_conditions(conditions);
+  impl_->bytes.assign(kChunkedReplayMagic.begin(), kChunkedReplayMagic.end());
+  if (auto r = write_chunk(impl_->bytes, header, 0); !r) {
+    impl_->error = r.error();
+  }
 }
 
 void ReplayWriter::add_input_frame(const input_frame& frame) {
-  *impl_->replay.add_player_frame() = write_input_frame(frame);
+  impl_->block_frames.emplace_back(frame);
+  ++impl_->frame_count;
+  if (impl_->block_frames.size() >= kBlockTicks * std::max(1u, impl_->conditions.player_count)) {
+    impl_->end_block();
+  }
 }
 
 result<std::vector<std::uint8_t>> ReplayWriter::write() const {
-  auto data = write_proto(impl_->replay);
-  if (!data) {
-    return unexpected(data.error());
+  if (impl_->error) {
+    return unexpected(*impl_->error);
   }
-  auto compressed = compress(*data);
-  if (!compressed) {
-    return unexpected("couldn't compress replay: " + compressed.error());
+  auto bytes = impl_->bytes;
+  if (!impl_->block_frames.empty()) {
+    if (auto r = impl_->write_block(bytes); !r) {
+      return unexpected(r.error());
+    }
+  }
+  return {std::move(bytes)};
+}
+
+result<void> ReplayWriter::flush(io::Filesystem& fs, std::string_view name) {
+  impl_->end_block();
+  return impl_->flush([&](std::span<const std::uint8_t> bytes, bool append) {
+    return append ? fs.append(name, bytes) : fs.write(name, bytes);
+  });
+}
+
+result<void>
+ReplayWriter::flush_replay(io::Filesystem& fs, std::string_view name, bool end_block) {
+  if (end_block) {
+    impl_->end_block();
   }
-  return crypt(*compressed, kReplayEncryptionKey);
+  return impl_->flush([&](std::span<const std::uint8_t> bytes, bool append) {
+    return append ? fs.append_replay(name, bytes) : fs.write_replay(name, bytes);
+  });
+}
+
+bool ReplayWriter::has_unflushed_blocks() const {
+  return impl_->bytes.size() > impl_->flushed_size;
 }
 
 const ii::initial_conditions& ReplayWriter::initial_conditions() const {
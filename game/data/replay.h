@@ -7,9 +7,17 @@
 #include <memory>
 #include <optional>
 #include <span>
+#include <string_view>
+#include <vector>
+
+namespace ii::io {
+class Filesystem;
+}  // namespace ii::io
 
 namespace ii::data {
 
+// Reads replays in any format. Input frames of chunked replays are decoded lazily, one block at a
+// time.
 class ReplayReader {
 public:
   ~ReplayReader();
@@ -18,11 +26,16 @@ public:
 
   static result<ReplayReader> create(std::span<const std::uint8_t> bytes);
   ii::initial_conditions initial_conditions() const;
+  // Returns nullopt at the end of the replay, or if a corrupt block was reached; status() tells
+  // the two apart.
   std::optional<input_frame> next_input_frame();
   std::vector<input_frame> next_tick_input_frames();
+  result<void> status() const;
 
   std::size_t current_input_frame() const;
   std::size_t total_input_frames() const;
+  // Sets the index of the next input frame to be read (clamped to the total).
+  void seek_input_frame(std::size_t index);
 
 private:
   ReplayReader();
@@ -30,6 +43,8 @@ private:
   std::unique_ptr<impl_t> impl_;
 };
 
+// Writes replays in the chunked format. Input frames are compressed a block at a time as they're
+// added.
 class ReplayWriter {
 public:
   ~ReplayWriter();
@@ -38,7 +53,16 @@ public:
 
   ReplayWriter(const ii::initial_conditions& conditions);
   void add_input_frame(const input_frame& frame);
+  // Returns the complete replay so far.
   result<std::vector<std::uint8_t>> write() const;
+  // Ends the current block and writes everything not yet flushed to the named file: the first flush
+  // overwrites the file and later ones append to it, so that the file is always a valid replay.
+  result<void> flush(io::Filesystem& fs, std::string_view name);
+  // As flush(), but writes to the named replay in the replay directory. Unless end_block is set,
+  // only completed blocks are written, so the game can call this as it goes without shortening
+  // blocks.
+  result<void> flush_replay(io::Filesystem& fs, std::string_view name, bool end_block);
+  bool has_unflushed_blocks() const;
   const ii::initial_conditions& initial_conditions() const;
 
 private:
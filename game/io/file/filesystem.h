@@ -15,6 +15,7 @@ public:
 
   virtual result<byte_buffer> read(std::string_view name) const = 0;
   virtual result<void> write(std::string_view name, std::span<const std::uint8_t>) = 0;
+  virtual result<void> append(std::string_view name, std::span<const std::uint8_t>) = 0;
 
   virtual result<byte_buffer> read_asset(std::string_view name) const = 0;
   virtual result<byte_buffer> read_config() const = 0;
@@ -27,6 +28,8 @@ public:
   virtual std::vector<std::string> list_replays() const = 0;
   virtual result<byte_buffer> read_replay(std::string_view name) const = 0;
   virtual result<void> write_replay(std::string_view name, std::span<const std::uint8_t>) = 0;
+  virtual result<void> append_replay(std::string_view name, std::span<const std::uint8_t>) = 0;
+  virtual result<void> rename_replay(std::string_view from, std::string_view to) = 0;
 };
 
 }  // namespace ii::io
@@ -27,8 +27,10 @@ result<std::vector<std::uint8_t>> read(const std::filesystem::path& path) {
   return {std::move(v)};
 }
 
-result<void> write(const std::filesystem::path& path, std::span<const std::uint8_t> bytes) {
-  std::ofstream f{path, std::ios::out | std::ios::binary};
+result<void> write(const std::filesystem::path& path, std::span<const std::uint8_t> bytes,
+                   bool append = false) {
+  auto mode = std::ios::out | std::ios::binary | (append ? std::ios::app : std::ios::trunc);
+  std::ofstream f{path, mode};
   if (!f.is_open()) {
     return unexpected("Couldn't open " + path.string() + " for writing");
   }
@@ -57,6 +59,10 @@ result<void> StdFilesystem::write(std::string_view name, std::span<const std::ui
   return io::write(std::filesystem::path{std::string{name}}, data);
 }
 
+result<void> StdFilesystem::append(std::string_view name, std::span<const std::uint8_t> data) {
+  return io::write(std::filesystem::path{std::string{name}}, data, /* append */ true);
+}
+
 result<Filesystem::byte_buffer> StdFilesystem::read_asset(std::string_view name) const {
   return io::read(std::filesystem::path{asset_dir_} / name);
 }
@@ -109,4 +115,20 @@ StdFilesystem::write_replay(std::string_view name, std::span<const std::uint8_t>
   return io::write(std::filesystem::path{replay_dir_} / (std::string{name} + kReplayExt), data);
 }
 
+result<void>
+StdFilesystem::append_replay(std::string_view name, std::span<const std::uint8_t> data) {
+  return io::write(std::filesystem::path{replay_dir_} / (std::string{name} + kReplayExt), data,
+                   /* append */ true);
+}
+
+result<void> StdFilesystem::rename_replay(std::string_view from, std::string_view to) {
+  std::error_code ec;
+  std::filesystem::rename(std::filesystem::path{replay_dir_} / (std::string{from} + kReplayExt),
+                          std::filesystem::path{replay_dir_} / (std::string{to} + kReplayExt), ec);
+  if (ec) {
+    return unexpected("Couldn't rename replay " + std::string{from} + ": " + ec.message());
+  }
+  return {};
+}
+
 }  // namespace ii::io
@@ -12,6 +12,7 @@ public:
 
   result<byte_buffer> read(std::string_view name) const override;
   result<void> write(std::string_view name, std::span<const std::uint8_t>) override;
+  result<void> append(std::string_view name, std::span<const std::uint8_t>) override;
 
   result<byte_buffer> read_asset(std::string_view name) const override;
   result<byte_buffer> read_config() const override;
@@ -24,6 +25,8 @@ public:
   std::vector<std::string> list_replays() const override;
   result<byte_buffer> read_replay(std::string_view name) const override;
   result<void> write_replay(std::string_view name, std::span<const std::uint8_t>) override;
+  result<void> append_replay(std::string_view name, std::span<const std::uint8_t>) override;
+  result<void> rename_replay(std::string_view from, std::string_view to) override;
 
 private:
   std::string asset_dir_;
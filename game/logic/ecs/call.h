@@ -32,14 +32,26 @@ template <typename T>
 struct retain_parameter
 : std::bool_constant<!is_component_parameter<T> && !is_handle_parameter<T>> {};
 
-template <typename Arg, typename H>
-constexpr bool can_synthesize_call_parameter(H&& handle) {
-  if constexpr (is_handle_parameter<Arg> ||
-                (is_component_parameter<Arg> && is_pointer_component_parameter<Arg>)) {
-    return true;
-  } else if (is_component_parameter<Arg>) {
-    return handle.template has<std::remove_cvref_t<Arg>>();
-  }
+// Components that must exist to synthesize all of the parameters.
+template <typename... Args>
+inline constexpr component_signature required_components = [] {
+  component_signature s;
+  (
+      [&] {
+        if constexpr (is_component_parameter<Args> && !is_pointer_component_parameter<Args>) {
+          s.set(id<std::remove_cvref_t<Args>>());
+        }
+      }(),
+      ...);
+  return s;
+}();
+
+// Const component parameters are obtained through a const handle, so that they aren't marked as
+// modified.
+template <typename Arg, bool Const>
+constexpr handle_base<Const || is_const_component_parameter<Arg>>
+component_parameter_handle(handle_base<Const> handle) {
+  return handle;
 }
 
 template <typename Arg, typename H>
@@ -47,10 +59,11 @@ constexpr decltype(auto) synthesize_call_parameter(H&& handle) {
   if constexpr (is_handle_parameter<Arg>) {
     return handle;
   } else if constexpr (is_component_parameter<Arg> && is_pointer_component_parameter<Arg>) {
-    return handle.template get<std::remove_cvref_t<std::remove_pointer_t<Arg>>>();
+    return component_parameter_handle<Arg>(handle)
+        .template get<std::remove_cvref_t<std::remove_pointer_t<Arg>>>();
   } else if (is_component_parameter<Arg>) {
     assert(handle.template has<std::remove_cvref_t<Arg>>());
-    return *handle.template get<std::remove_cvref_t<Arg>>();
+    return *component_parameter_handle<Arg>(handle).template get<std::remove_cvref_t<Arg>>();
   }
 }
 
@@ -61,7 +74,7 @@ template <bool Check, sfn::function auto F, typename H, typename... ForwardedArg
 struct call_f<Check, F, H, sfn::list<ForwardedArgs...>, sfn::list<SynthesizedArgs...>> {
   inline static constexpr auto f(H h, ForwardedArgs... args) {
     if constexpr (Check) {
-      if (!(can_synthesize_call_parameter<SynthesizedArgs>(h) && ...)) {
+      if (!h.has_all(required_components<SynthesizedArgs...>)) {
         return;
       }
     }
@@ -91,22 +104,37 @@ struct signature_impl<T, R (T::*)(Args...) const> : std::type_identity<R(Args...
 template <bool Check, bool Const, typename... SynthesizedArgs, typename F, typename... Args>
 auto dispatch_invoke(sfn::list<SynthesizedArgs...>, handle_base<Const> h, F&& f, Args&&... args) {
   if constexpr (Check) {
-    if (!(can_synthesize_call_parameter<SynthesizedArgs>(h) && ...)) {
+    if (!h.has_all(required_components<SynthesizedArgs...>)) {
       return;
     }
   }
   return std::invoke(f, synthesize_call_parameter<SynthesizedArgs>(h)..., args...);
 }
 
-template <bool Check, bool Const, typename F, typename... Args>
-auto dispatch_impl(handle_base<Const> h, F&& f, Args&&... args) {
+template <typename F>
+struct dispatch_parameters {
   using f_type = std::remove_cvref_t<F>;
   using m_type = typename signature_impl<f_type, decltype(&f_type::operator())>::type;
   using parameters = sfn::parameter_types_of<m_type>;
-  using synthesized_parameters =
-      sfn::sublist<parameters, 0, sfn::find_if<parameters, retain_parameter>>;
-  return dispatch_invoke<Check, Const>(synthesized_parameters{}, h, std::forward<F>(f),
-                                       std::forward<Args>(args)...);
+  using type = sfn::sublist<parameters, 0, sfn::find_if<parameters, retain_parameter>>;
+};
+
+template <typename>
+struct list_required_components;
+template <typename... Args>
+struct list_required_components<sfn::list<Args...>> {
+  static constexpr component_signature value = required_components<Args...>;
+};
+
+template <typename F>
+constexpr component_signature dispatch_required_components() {
+  return list_required_components<typename dispatch_parameters<F>::type>::value;
+}
+
+template <bool Check, bool Const, typename F, typename... Args>
+auto dispatch_impl(handle_base<Const> h, F&& f, Args&&... args) {
+  return dispatch_invoke<Check, Const>(typename dispatch_parameters<F>::type{}, h,
+                                       std::forward<F>(f), std::forward<Args>(args)...);
 }
 
 }  // namespace detail
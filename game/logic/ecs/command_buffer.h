@@ -0,0 +1,92 @@
+#ifndef II_GAME_LOGIC_ECS_COMMAND_BUFFER_H
+#define II_GAME_LOGIC_ECS_COMMAND_BUFFER_H
+#include "game/logic/ecs/index.h"
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ii::ecs {
+
+// Records structural changes to an index (creating and destroying entities, adding and removing
+// components) so that they can be made later, at a point where nothing is iterating over it.
+// Commands are applied in the order they were recorded. Commands targeting an entity that no longer
+// exists by the time they're applied are ignored.
+class CommandBuffer {
+public:
+  bool empty() const { return commands_.empty(); }
+  std::size_t size() const { return commands_.size(); }
+
+  // Create an entity and add each component provided.
+  template <Component... CArgs>
+  void create(CArgs&&... cargs) {
+    create([... cargs = std::forward<CArgs>(cargs)](handle h) mutable {
+      (h.emplace<std::remove_cvref_t<CArgs>>(std::move(cargs)), ...);
+    });
+  }
+  // Create an entity and call f with its handle.
+  void create(std::function<void(handle)> f) {
+    commands_.push_back({command_type::kCreate, entity_id{0}, std::move(f)});
+  }
+  // Remove an entity along with all associated components.
+  void destroy(entity_id id) { commands_.push_back({command_type::kDestroy, id, {}}); }
+  // Add (or replace) a component.
+  template <typename C>
+  void add(entity_id id, C&& data) requires Component<std::remove_cvref_t<C>>
+  {
+    update(id, [data = std::forward<C>(data)](handle h) mutable {
+      h.emplace<std::remove_cvref_t<C>>(std::move(data));
+    });
+  }
+  // Remove a component.
+  template <Component C>
+  void remove(entity_id id) {
+    update(id, [](handle h) { h.remove<C>(); });
+  }
+  // Call f with the entity's handle.
+  void update(entity_id id, std::function<void(handle)> f) {
+    commands_.push_back({command_type::kUpdate, id, std::move(f)});
+  }
+
+  // Apply and clear all commands, including any recorded while applying them.
+  void apply(EntityIndex& index) {
+    for (std::size_t i = 0; i < commands_.size(); ++i) {
+      auto c = std::move(commands_[i]);
+      switch (c.type) {
+      case command_type::kCreate:
+        c.f(index.create());
+        break;
+      case command_type::kDestroy:
+        index.destroy(c.id);
+        break;
+      case command_type::kUpdate:
+        if (auto h = index.get(c.id); h) {
+          c.f(*h);
+        }
+        break;
+      }
+    }
+    commands_.clear();
+  }
+
+  void clear() { commands_.clear(); }
+
+private:
+  enum class command_type {
+    kCreate,
+    kDestroy,
+    kUpdate,
+  };
+
+  struct command {
+    command_type type = command_type::kUpdate;
+    entity_id id{0};
+    std::function<void(handle)> f;
+  };
+  std::vector<command> commands_;
+};
+
+}  // namespace ii::ecs
+
+#endif
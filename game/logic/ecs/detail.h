@@ -1,6 +1,11 @@
 #ifndef II_GAME_LOGIC_ECS_DETAIL_H
 #define II_GAME_LOGIC_ECS_DETAIL_H
 #include "game/logic/ecs/id.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <vector>
 
@@ -11,36 +16,196 @@ template <Component>
 struct component_storage_get;
 struct component_storage_base;
 
-struct component_table {
-  std::optional<index_type>& operator[](component_id index) {
-    return v[static_cast<std::size_t>(index)];
-  }
-  const std::optional<index_type>& operator[](component_id index) const {
-    return v[static_cast<std::size_t>(index)];
-  }
+// Epochs at which a source and target index were last synced, for delta copies, and the current
+// target epoch with which to stamp anything rewritten.
+struct sync_epochs {
+  std::uint64_t source = 0;
+  std::uint64_t target = 0;
+  std::uint64_t stamp = 0;
+};
+
+// Unique identifier for the current layout of an index. Changes whenever the layout is rewritten
+// wholesale (by being the target of a full copy).
+inline std::uint64_t next_sync_id() {
+  static std::atomic<std::uint64_t> next_id{1};
+  return next_id++;
+}
+
+// Progress of incremental compaction through the entity tables or a component's storage. Everything
+// from the write position up to (but excluding) the read position is empty. Once a component's
+// storage is compacted, it may be reordered: source[k] is the current position of the entry headed
+// for position k, and destination is the inverse; positions before read are already in place.
+struct compaction_cursor {
+  std::size_t write = 0;
+  std::size_t read = 0;
+  bool reorder = false;
+  std::vector<index_type> source;
+  std::vector<index_type> destination;
+};
+
+// Marks an empty entry in the entity slot map.
+inline constexpr index_type kNoIndex = ~index_type{0};
 
+// The set of components an entity has, and the index of its entry in each component's storage.
+// Entries of v are meaningful only for component IDs in the signature.
+struct component_table {
   template <Component C>
   void set(index_type index) {
-    auto c_index = static_cast<std::size_t>(ecs::id<C>());
-    if (c_index >= v.size()) {
-      v.resize(c_index + 1);
-    }
-    v[c_index] = index;
+    set(ecs::id<C>(), index);
+  }
+  void set(component_id cid, index_type index) {
+    signature.set(cid);
+    v[static_cast<std::size_t>(cid)] = index;
   }
   template <Component C>
   void reset() {
-    (*this)[ecs::id<C>()].reset();
+    signature.reset(ecs::id<C>());
   }
   template <Component C>
   std::optional<index_type> get() const {
     return get(ecs::id<C>());
   }
   std::optional<index_type> get(component_id cid) const {
-    auto c_index = static_cast<std::size_t>(cid);
-    return c_index < v.size() ? v[c_index] : std::optional<index_type>{};
+    return signature.test(cid) ? v[static_cast<std::size_t>(cid)] : std::optional<index_type>{};
+  }
+  void clear() { signature = {}; }
+  void copy_components(const component_table& source) {
+    signature = source.signature;
+    signature.for_each([&](component_id cid) {
+      v[static_cast<std::size_t>(cid)] = source.v[static_cast<std::size_t>(cid)];
+    });
   }
+
   std::optional<entity_id> id;
-  std::vector<std::optional<index_type>> v;
+  index_type slot = 0;
+  std::uint64_t epoch = 0;
+  component_signature signature;
+  std::array<index_type, kMaxComponents> v;
+};
+
+// Cached result of a filtered iteration: the sorted storage indexes of the entries of a primary
+// component whose entity has every component in the signature (which includes the primary). Kept up
+// to date as components are added and removed, except that compaction marks it dirty, and it must
+// then be rebuilt before use. The version changes whenever entries are inserted or erased.
+struct query_view {
+  component_id primary{0};
+  component_signature signature;
+  bool dirty = true;
+  std::uint64_t version = 0;
+  std::vector<index_type> entries;
+
+  void insert(index_type index) {
+    entries.insert(std::upper_bound(entries.begin(), entries.end(), index), index);
+    ++version;
+  }
+  void erase(index_type index) {
+    if (auto it = std::lower_bound(entries.begin(), entries.end(), index);
+        it != entries.end() && *it == index) {
+      entries.erase(it);
+      ++version;
+    }
+  }
+};
+
+// Maps live entity IDs to entity table slots. IDs are allocated sequentially and keep their
+// creation order (collision results are sorted by ID, for instance), so they can't encode a slot
+// themselves. Instead, the low bits of the ID index an open-addressed array whose entries store
+// the full ID, which distinguishes it from older or newer IDs sharing the same bits. Live IDs are
+// mostly recent and consecutive, so a lookup is usually a single array access.
+class entity_slot_map {
+public:
+  std::size_t size() const { return size_; }
+  std::size_t bytes() const { return entries_.capacity() * sizeof(entry); }
+  bool contains(entity_id id) const { return find(id) != kNoIndex; }
+
+  // Returns the slot for the ID, or kNoIndex if it isn't present.
+  index_type find(entity_id id) const {
+    if (entries_.empty()) {
+      return kNoIndex;
+    }
+    for (auto i = bucket(id);; i = next(i)) {
+      const auto& e = entries_[i];
+      if (e.slot == kNoIndex || e.id == id) {
+        return e.slot;
+      }
+    }
+  }
+
+  // The ID must not already be present.
+  void insert(entity_id id, index_type slot) {
+    if (2 * (size_ + 1) > entries_.size()) {
+      grow();
+    }
+    auto i = bucket(id);
+    while (entries_[i].slot != kNoIndex) {
+      i = next(i);
+    }
+    entries_[i] = {id, slot};
+    ++size_;
+  }
+
+  // The ID must already be present.
+  void assign(entity_id id, index_type slot) {
+    auto i = bucket(id);
+    while (entries_[i].id != id || entries_[i].slot == kNoIndex) {
+      i = next(i);
+    }
+    entries_[i].slot = slot;
+  }
+
+  void erase(entity_id id) {
+    if (entries_.empty()) {
+      return;
+    }
+    auto i = bucket(id);
+    for (; entries_[i].id != id || entries_[i].slot == kNoIndex; i = next(i)) {
+      if (entries_[i].slot == kNoIndex) {
+        return;
+      }
+    }
+    // Shift back any later entries in the same probe sequence that would otherwise become
+    // unreachable, so that no tombstones are needed.
+    for (auto j = next(i); entries_[j].slot != kNoIndex; j = next(j)) {
+      auto k = bucket(entries_[j].id);
+      if (i <= j ? (k <= i || k > j) : (k <= i && k > j)) {
+        entries_[i] = entries_[j];
+        i = j;
+      }
+    }
+    entries_[i].slot = kNoIndex;
+    --size_;
+  }
+
+  void clear() {
+    for (auto& e : entries_) {
+      e.slot = kNoIndex;
+    }
+    size_ = 0;
+  }
+
+private:
+  struct entry {
+    entity_id id{0};
+    index_type slot = kNoIndex;
+  };
+
+  std::size_t bucket(entity_id id) const { return +id & (entries_.size() - 1); }
+  std::size_t next(std::size_t i) const { return (i + 1) & (entries_.size() - 1); }
+
+  void grow() {
+    auto entries = std::move(entries_);
+    entries_.clear();
+    entries_.resize(std::max<std::size_t>(64, 2 * entries.size()));
+    size_ = 0;
+    for (const auto& e : entries) {
+      if (e.slot != kNoIndex) {
+        insert(e.id, e.slot);
+      }
+    }
+  }
+
+  std::vector<entry> entries_;
+  std::size_t size_ = 0;
 };
 
 }  // namespace ii::ecs::detail
@@ -1,34 +1,97 @@
 #ifndef II_GAME_LOGIC_ECS_ID_H
 #define II_GAME_LOGIC_ECS_ID_H
 #include "game/common/enum.h"
+#include <array>
+#include <bit>
 #include <concepts>
+#include <cstddef>
 #include <cstdint>
 #include <type_traits>
 
 namespace ii::ecs {
-template <typename Id, typename Tag = Id>
-class sequential_id {
-private:
-  inline static Id identifier_{0};
-
-public:
-  template <typename...>
-  inline static const Id value = identifier_++;
-};
-
 using index_type = std::uint32_t;
 enum class entity_id : index_type {};
 enum class component_id : index_type {};
 
+// Maximum number of distinct component IDs.
+inline constexpr std::size_t kMaxComponents = 128;
+
+// Components declare their ID as a static kComponentId member (an integer or enum value), which
+// must be below kMaxComponents and unique among the components used in an index. IDs are fixed at
+// compile time, so they're the same in every build. Components must be default-constructible so
+// that they can be restored from serialised data.
 struct component {};
 template <typename T>
-concept Component = std::is_base_of_v<component, T> && std::copy_constructible<T> &&
-    std::copyable<T> && std::move_constructible<T> && std::movable<T>;
+concept Component = std::is_base_of_v<component, T> && std::default_initializable<T> &&
+    std::copy_constructible<T> && std::copyable<T> && std::move_constructible<T> &&
+    std::movable<T> &&
+    requires { static_cast<index_type>(T::kComponentId); };
 
 template <Component C>
-component_id id() {
-  return sequential_id<component_id>::value<C>;
+constexpr component_id id() {
+  static_assert(static_cast<std::size_t>(C::kComponentId) < kMaxComponents);
+  return component_id{static_cast<index_type>(C::kComponentId)};
 }
+
+// Fixed-size set of component IDs.
+class component_signature {
+public:
+  template <Component... C>
+  static constexpr component_signature of() {
+    component_signature s;
+    (s.set(id<C>()), ...);
+    return s;
+  }
+
+  constexpr bool operator==(const component_signature&) const = default;
+  constexpr component_signature& operator|=(const component_signature& s) {
+    for (std::size_t i = 0; i < words_.size(); ++i) {
+      words_[i] |= s.words_[i];
+    }
+    return *this;
+  }
+
+  constexpr bool empty() const {
+    for (auto w : words_) {
+      if (w) {
+        return false;
+      }
+    }
+    return true;
+  }
+  constexpr bool test(component_id cid) const {
+    auto i = static_cast<std::size_t>(cid);
+    return (words_[i / 64] >> (i % 64)) & 1u;
+  }
+  // Check whether every ID in the other set is also in this one.
+  constexpr bool contains(const component_signature& s) const {
+    for (std::size_t i = 0; i < words_.size(); ++i) {
+      if (s.words_[i] & ~words_[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+  constexpr void set(component_id cid) {
+    auto i = static_cast<std::size_t>(cid);
+    words_[i / 64] |= std::uint64_t{1} << (i % 64);
+  }
+  constexpr void reset(component_id cid) {
+    auto i = static_cast<std::size_t>(cid);
+    words_[i / 64] &= ~(std::uint64_t{1} << (i % 64));
+  }
+  // Calls f with each ID in the set, in increasing order.
+  constexpr void for_each(auto&& f) const {
+    for (std::size_t i = 0; i < words_.size(); ++i) {
+      for (auto w = words_[i]; w; w &= w - 1) {
+        f(component_id{static_cast<index_type>(64 * i + std::countr_zero(w))});
+      }
+    }
+  }
+
+private:
+  std::array<std::uint64_t, (kMaxComponents + 63) / 64> words_{};
+};
 }  // namespace ii::ecs
 
 namespace ii {
@@ -1,23 +1,32 @@
 #ifndef II_GAME_LOGIC_ECS_INDEX_H
 #define II_GAME_LOGIC_ECS_INDEX_H
+#include "game/common/binary.h"
+#include "game/common/job_pool.h"
 #include "game/common/printer.h"
 #include "game/logic/ecs/detail.h"
 #include "game/logic/ecs/id.h"
+#include "game/logic/ecs/stats.h"
+#include "game/logic/ecs/storage.h"
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <type_traits>
-#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 namespace ii::ecs {
 class EntityIndex;
+namespace detail {
+// Components that must exist for dispatch_if to call a function of type F (see call.h).
+template <typename F>
+constexpr component_signature dispatch_required_components();
+}  // namespace detail
 
 template <bool Const>
 class handle_base {
@@ -30,6 +39,9 @@ public:
   : handle_base{h.id_, h.index_, h.table_} {}
 
   entity_id id() const { return id_; }
+  // Slot of the entity's table. Slots are dense and reused, and change only when the index is
+  // compacted.
+  index_type slot() const { return table_->slot; }
 
   // Add a component via in-place construction.
   template <Component C, typename... Args>
@@ -48,6 +60,8 @@ public:
   template <Component C>
   bool has() const;
   bool has(component_id) const;
+  // Check existence of every component in the set.
+  bool has_all(const component_signature&) const;
   // Obtain pointer to component data, if it exists.
   template <Component C>
   C* get() const requires(!Const);
@@ -88,10 +102,47 @@ public:
 
   // Dump state.
   void dump(Printer&, bool portable, const query& q = {}) const;
-  // Replicate all data to target index. Doesn't copy component add/remove callbacks.
-  void copy_to(EntityIndex& target) const;
+  // Memory usage, fragmentation and compaction history.
+  index_stats stats() const;
+  // Debug name of the given component type, or empty if it hasn't been used with this index.
+  std::string debug_name(component_id) const;
+  // Replicate all data to target index, preserving internal layout. Doesn't copy component
+  // add/remove callbacks. If delta is set and the indexes were last synced with each other (by a
+  // copy in either direction, with neither fully overwritten since), only rewrites entities and
+  // components modified on either side since. Otherwise, everything is copied.
+  void copy_to(EntityIndex& target, bool delta = false) const;
+  // Serialise all data, preserving internal layout as copy_to() does. Components are serialised by
+  // their DEBUG_STRUCT_TUPLE. As with copies, callbacks aren't included, but the compaction order
+  // of each component storage and the progress of any incremental compaction are. Compaction keys
+  // are written as function addresses, so data can only be read by the same build.
+  void write(BinaryWriter&) const;
+  // Replace all data with that serialised by write(). Storage for each component is created as
+  // necessary (its add/remove callbacks aren't invoked). If the data is invalid, returns false and
+  // leaves the index empty.
+  bool read(BinaryReader&);
+  // Hash of all entities and component data (via DEBUG_STRUCT_TUPLE). Hashes of blocks of component
+  // entries are cached, and only those modified since the previous call are recomputed, so it's
+  // cheap to call every tick. Relies on the same modification tracking as delta copies. Updating
+  // the cache advances the modification epoch, so this isn't safe to call concurrently with other
+  // use.
+  std::size_t checksum() const;
   // Rearrange and compact internals. Invalidates all handles and component references.
   void compact();
+  // Incremental compact(): examines at most max_entries entity tables and component entries,
+  // continuing from where the previous call left off, and returns true once a full pass over the
+  // index has completed. Order of iteration is preserved, except as set by set_compaction_order().
+  // The IDs of entities whose table or component entries were moved are appended to moved; only
+  // their handles and component references are invalidated.
+  bool compact_step(std::size_t max_entries, std::vector<entity_id>& moved);
+  bool is_compacting() const { return compaction_phase_.has_value(); }
+  // Key function ordering a component's storage, given an entity having the component.
+  using compaction_key_t = std::uint64_t (*)(const_handle);
+  // Once compacted, reorder storage of C so that its entries (and so iteration) are sorted by key,
+  // with ties kept in their existing order. Keys are computed once per compaction pass. Null (the
+  // default) keeps entries in order of insertion. The policy is replicated by copies, and by
+  // write() and read() for storage that exists at the time.
+  template <Component C>
+  void set_compaction_order(compaction_key_t key);
   // Create a new element and return handle.
   handle create();
   // Create a new element and add each component provided.
@@ -147,6 +198,16 @@ public:
   void iterate_dispatch_if(auto&& f, bool include_new = true);
   template <Component C>
   void iterate_dispatch_if(auto&& f, bool include_new = true) const;
+  // Read-only iterate_dispatch that splits the entries of C into chunks of consecutive entries (of
+  // at least min_chunk_size, where possible) and runs them as parallel jobs on the pool, or on the
+  // calling thread if it's null. Each call of f is passed its chunk's element of outputs as an
+  // extra argument. Outputs is resized to the number of chunks (reusing existing elements as-is)
+  // and is in iteration order, so merging the elements in order gives the same result as a serial
+  // pass.
+  // Other const operations may be used from f, but nothing may modify the index during the call.
+  template <Component C, typename T>
+  void iterate_dispatch_parallel(JobPool* pool, std::vector<T>& outputs, auto&& f,
+                                 std::size_t min_chunk_size = 1) const;
 
 private:
   template <bool>
@@ -154,6 +215,10 @@ private:
   template <Component>
   friend struct detail::component_storage;
 
+  template <Component C>
+  handle entry_handle(const detail::component_storage_get<C>& c, std::size_t i);
+  template <Component C>
+  const_handle entry_handle(const detail::component_storage_get<C>& c, std::size_t i) const;
   template <Component C>
   detail::component_storage<C>& storage();
   template <Component C>
@@ -162,12 +227,52 @@ private:
   detail::component_storage_get<C>* storage_get();
   template <Component C>
   const detail::component_storage_get<C>* storage_get() const;
+  // Returns the (up-to-date) view of entries of C whose entities have every component in the
+  // signature, creating it if necessary.
+  template <Component C>
+  detail::query_view& view(const component_signature& signature) const;
+  // Calls f with each storage index in the view, in order, tolerating modification of the view by
+  // f. Stops at the given end index.
+  void iterate_view(detail::query_view& view, std::size_t end, auto&& f) const;
+  // Keep views up to date when the given component is added to or removed from an entity, or when
+  // all of its components are removed. Must be called while the entity has the component(s).
+  void views_add(const detail::component_table& table, component_id cid) const;
+  void views_remove(const detail::component_table& table, component_id cid) const;
+  void views_clear(const detail::component_table& table) const;
+  // Keep views up to date when an entry of the given component is moved by compaction.
+  void views_move(component_id primary, std::size_t from, std::size_t to) const;
+
+  struct sync_point {
+    std::uint64_t id = 0;
+    std::uint64_t epoch = 0;
+  };
 
   entity_id next_id_{0};
   std::size_t next_entity_table_index_ = 0;
+  // Entity tables and component storage are stamped with the current epoch when modified. The epoch
+  // advances whenever the index takes part in a copy.
+  std::uint64_t sync_id_ = detail::next_sync_id();
+  mutable std::uint64_t epoch_ = 1;
+  mutable sync_point synced_source_;
+  mutable sync_point synced_self_;
+  // Epoch of the previous checksum(), unless everything has been rewritten since.
+  mutable std::optional<std::uint64_t> checksum_epoch_;
+  mutable BinaryWriter checksum_scratch_;
   std::deque<detail::component_table> entity_tables_;
-  std::unordered_map<entity_id, detail::component_table*> entities_;
+  detail::entity_slot_map entities_;
   std::vector<std::unique_ptr<detail::component_storage_base>> components_;
+  // Incremental compaction compacts the entity tables (in phase 0), then the storage of each
+  // component in turn (component i in phase i + 1).
+  std::optional<std::size_t> compaction_phase_;
+  detail::compaction_cursor compaction_cursor_;
+  std::uint64_t compaction_passes_ = 0;
+  std::uint64_t compaction_moves_ = 0;
+  // Views are created on demand by filtered iteration (even of a const index), and replicated by
+  // copies. Viewed is the union of all their signatures. Creating and rebuilding views is guarded
+  // by the mutex, so that const iteration is safe from multiple threads.
+  mutable std::deque<detail::query_view> views_;
+  mutable component_signature viewed_;
+  std::unique_ptr<std::mutex> views_mutex_ = std::make_unique<std::mutex>();
 };
 
 }  // namespace ii::ecs
@@ -3,7 +3,7 @@
 #include "game/logic/ecs/call.h"
 #include "game/logic/ecs/index.h"
 #include <algorithm>
-#include <deque>
+#include <limits>
 #include <map>
 #include <typeinfo>
 #include <utility>
@@ -11,78 +11,185 @@
 namespace ii::ecs::detail {
 struct component_storage_base {
   virtual ~component_storage_base() = default;
-  virtual void compact(EntityIndex& index) = 0;
-  virtual void remove_index(handle h, std::size_t index) = 0;
+  // Returns true if the storage has been fully compacted (and reordered).
+  virtual bool compact_step(EntityIndex& index, compaction_cursor& cursor, std::size_t& budget,
+                            std::vector<entity_id>& moved) = 0;
+  virtual void set_slot(std::size_t index, index_type slot, std::uint64_t epoch) = 0;
+  virtual void remove_index(handle h, std::size_t index, std::uint64_t epoch) = 0;
+  virtual void clear() = 0;
   virtual void copy_clear() = 0;
-  virtual void
-  copy_to(EntityIndex& index, std::unique_ptr<component_storage_base>& target) const = 0;
+  virtual void copy_to(EntityIndex& index, std::unique_ptr<component_storage_base>& target,
+                       const std::optional<sync_epochs>& delta) const = 0;
   virtual void dump(std::size_t index, bool portable, Printer& printer) const = 0;
+  virtual void write(BinaryWriter& writer) const = 0;
+  // Checks that each entry is consistent with the (already-read) entity tables, which reference
+  // the given number of live entries.
+  virtual void read(EntityIndex& index, std::size_t live, BinaryReader& reader) = 0;
+  // Hash of all entries (zero if there are none). Blocks not marked after the given epoch are
+  // assumed unchanged since the previous call, and their cached hashes reused.
+  virtual std::size_t checksum(std::optional<std::uint64_t> since, BinaryWriter& scratch) const = 0;
   virtual std::string debug_name() const = 0;
+  virtual component_stats stats() const = 0;
 };
 
 template <Component C>
 struct component_storage_get : component_storage_base {
-  struct entry {
-    entity_id id;
-    std::optional<C> data;
-  };
   index_type size = 0;
-  std::deque<entry> entries;
+  storage_type<C> entries;
 };
 
 template <Component C>
 struct component_storage : component_storage_get<C> {
   using base = component_storage_get<C>;
-  using entry = typename base::entry;
   std::vector<EntityIndex::component_add_callback<C>> add_callbacks;
   std::vector<EntityIndex::component_remove_callback<C>> remove_callbacks;
 
-  void compact(EntityIndex& index) override {
-    auto has_value = [](const entry& e) { return e.data.has_value(); };
-    auto it = std::find_if_not(base::entries.begin(), base::entries.end(), has_value);
-    if (it == base::entries.end()) {
-      return;
+  EntityIndex::compaction_key_t compaction_key = nullptr;
+
+  struct block_hash {
+    std::uint64_t hash = 0;
+    std::size_t count = 0;
+  };
+  mutable std::vector<block_hash> block_hashes;
+
+  bool compact_step(EntityIndex& index, compaction_cursor& cursor, std::size_t& budget,
+                    std::vector<entity_id>& moved) override {
+    auto& entries = base::entries;
+    if (!cursor.reorder) {
+      for (; budget && cursor.read < entries.size(); --budget, ++cursor.read) {
+        if (!entries.data(cursor.read)) {
+          continue;
+        }
+        if (cursor.read != cursor.write) {
+          entries.move(cursor.read, cursor.write);
+          entries.mark(cursor.read, index.epoch_);
+          update_moved(index, cursor.write, moved);
+          index.views_move(ecs::id<C>(), cursor.read, cursor.write);
+        }
+        ++cursor.write;
+      }
+      if (cursor.read < entries.size()) {
+        return false;
+      }
+      entries.truncate(cursor.write);
+      if (!compaction_key || !entries.size()) {
+        return true;
+      }
+      begin_reorder(index, cursor);
     }
-    auto pivot = std::stable_partition(it, base::entries.end(), has_value);
-    for (index_type c_index = std::distance(base::entries.begin(), it); it != pivot; ++it) {
-      (*index.entities_.find(it->id)->second)[ecs::id<C>()] = c_index++;
+
+    // Moves the entry headed for each position into place in turn, swapping whatever was there to
+    // where the moved entry came from. Entries may have been removed since the order was decided,
+    // but new entries are only ever added past the end of it. Views are rebuilt when next used,
+    // rather than kept sorted through the swaps.
+    bool swapped = false;
+    for (; budget && cursor.read < cursor.source.size(); --budget, ++cursor.read) {
+      auto k = cursor.read;
+      auto j = static_cast<std::size_t>(cursor.source[k]);
+      if (j == k) {
+        continue;
+      }
+      entries.swap(k, j);
+      swapped = true;
+      auto d = cursor.destination[k];
+      cursor.source[d] = static_cast<index_type>(j);
+      cursor.destination[j] = d;
+      if (entries.data(k)) {
+        update_moved(index, k, moved);
+      } else {
+        entries.mark(k, index.epoch_);
+      }
+      if (entries.data(j)) {
+        update_moved(index, j, moved);
+      } else {
+        entries.mark(j, index.epoch_);
+      }
+    }
+    if (swapped) {
+      for (auto& v : index.views_) {
+        if (v.primary == ecs::id<C>()) {
+          v.dirty = true;
+        }
+      }
     }
-    base::entries.erase(pivot, base::entries.end());
+    return cursor.read == cursor.source.size();
+  }
+
+  // Sorts the entries by key, breaking ties by current position, and records the resulting
+  // permutation in the cursor. Keys are all computed at once, but entries are moved incrementally.
+  // Entries removed since they were compacted are sorted to the end.
+  void begin_reorder(EntityIndex& index, compaction_cursor& cursor) {
+    auto& entries = base::entries;
+    std::vector<std::pair<std::uint64_t, index_type>> keys;
+    keys.reserve(entries.size());
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+      keys.emplace_back(entries.data(i) ? compaction_key(index.entry_handle(*this, i))
+                                        : std::numeric_limits<std::uint64_t>::max(),
+                        static_cast<index_type>(i));
+    }
+    std::sort(keys.begin(), keys.end());
+    cursor.reorder = true;
+    cursor.read = 0;
+    cursor.source.resize(keys.size());
+    cursor.destination.resize(keys.size());
+    for (std::size_t k = 0; k < keys.size(); ++k) {
+      cursor.source[k] = keys[k].second;
+      cursor.destination[keys[k].second] = static_cast<index_type>(k);
+    }
+  }
+
+  // Updates the entity table for an entry that has been moved to the given position.
+  void update_moved(EntityIndex& index, std::size_t i, std::vector<entity_id>& moved) {
+    auto& entries = base::entries;
+    entries.mark(i, index.epoch_);
+    auto& table = index.entity_tables_[entries.slot(i)];
+    table.template set<C>(static_cast<index_type>(i));
+    table.epoch = index.epoch_;
+    moved.emplace_back(entries.id(i));
+  }
+
+  void set_slot(std::size_t index, index_type slot, std::uint64_t epoch) override {
+    base::entries.set_slot(index, slot);
+    base::entries.mark(index, epoch);
   }
 
-  void remove_index(handle h, std::size_t index) override {
+  void remove_index(handle h, std::size_t index, std::uint64_t epoch) override {
     for (auto& f : remove_callbacks) {
-      f(h, *base::entries[index].data);
+      f(h, *base::entries.data(index));
     }
-    base::entries[index].data.reset();
+    base::entries.data(index).reset();
+    base::entries.mark(index, epoch);
     --base::size;
   }
 
-  void copy_clear() override {
+  void clear() override {
     base::size = 0;
     base::entries.clear();
   }
 
-  void
-  copy_to(EntityIndex& index, std::unique_ptr<component_storage_base>& target_ptr) const override {
+  void copy_clear() override {
+    clear();
+    compaction_key = nullptr;
+  }
+
+  void copy_to(EntityIndex&, std::unique_ptr<component_storage_base>& target_ptr,
+               const std::optional<sync_epochs>& delta) const override {
+    bool full = !delta || !target_ptr;
     if (!target_ptr) {
       target_ptr = std::make_unique<component_storage>();
     }
     auto& target = static_cast<component_storage&>(*target_ptr);
     target.size = base::size;
-    target.entries.resize(base::size);
-    for (index_type i = 0; const auto& e : base::entries) {
-      if (e.data) {
-        auto& e_copy = target.entries[i];
-        e_copy.id = e.id;
-        e_copy.data = *e.data;
-        (*index.entities_[e.id])[ecs::id<C>()] = i++;
-      }
+    target.compaction_key = compaction_key;
+    if (full) {
+      base::entries.copy_to(target.entries);
+    } else {
+      base::entries.copy_modified_to(target.entries, *delta);
     }
   }
 
   void dump(std::size_t index, bool portable, Printer& printer) const override {
-    const auto& data = *base::entries[index].data;
+    const auto& data = *base::entries.data(index);
     printer.begin().put('[');
     if (!portable) {
       printer.put(+ecs::id<C>()).put(" / ");
@@ -104,6 +211,67 @@ struct component_storage : component_storage_get<C> {
     }
   }
 
+  // Every entry is written, including empty ones, so that the layout is reproduced exactly.
+  void write(BinaryWriter& writer) const override {
+    static_assert(DebugStructTuple<C>, "components must declare DEBUG_STRUCT_TUPLE to be written");
+    const auto& entries = base::entries;
+    writer.put(compaction_key).put_size(entries.size());
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+      writer.put(entries.id(i)).put(entries.slot(i)).put(entries.data(i));
+    }
+  }
+
+  void read(EntityIndex& index, std::size_t live, BinaryReader& reader) override {
+    auto& entries = base::entries;
+    clear();
+    std::size_t size = 0;
+    reader.get(compaction_key).get_size(size);
+    for (std::size_t i = 0; i < size && reader.ok(); ++i) {
+      entity_id id{0};
+      index_type slot = 0;
+      reader.get(id).get(slot);
+      auto& data = entries.emplace_back(id, slot);
+      entries.mark(i, index.epoch_);
+      reader.get(data);
+      if (!data) {
+        continue;
+      }
+      ++base::size;
+      if (slot >= index.next_entity_table_index_ || index.entity_tables_[slot].id != id ||
+          index.entity_tables_[slot].template get<C>() != i) {
+        reader.fail();
+      }
+    }
+    if (base::size != live) {
+      reader.fail();
+    }
+  }
+
+  std::size_t checksum(std::optional<std::uint64_t> since, BinaryWriter& scratch) const override {
+    static constexpr auto kBlockSize = storage_type<C>::kBlockSize;
+    const auto& entries = base::entries;
+    block_hashes.resize((entries.size() + kBlockSize - 1) / kBlockSize);
+    if (block_hashes.empty()) {
+      return 0;
+    }
+    std::size_t result = +ecs::id<C>();
+    for (std::size_t b = 0; b < block_hashes.size(); ++b) {
+      auto begin = b * kBlockSize;
+      auto count = std::min(kBlockSize, entries.size() - begin);
+      auto& cache = block_hashes[b];
+      // Truncation shrinks the last block without marking it.
+      if (!since || cache.count != count || entries.block_epoch(b) > *since) {
+        scratch.clear();
+        for (std::size_t i = begin; i < begin + count; ++i) {
+          scratch.put(entries.id(i)).put(entries.slot(i)).put(entries.data(i));
+        }
+        cache = {hash_bytes(scratch.bytes()), count};
+      }
+      hash_combine(result, static_cast<std::size_t>(cache.hash));
+    }
+    return result;
+  }
+
   std::string debug_name() const override {
     C* p = nullptr;
     if constexpr (requires { to_debug_name(p); }) {
@@ -112,20 +280,48 @@ struct component_storage : component_storage_get<C> {
       return {};
     }
   }
+
+  component_stats stats() const override {
+    component_stats s;
+    s.id = +ecs::id<C>();
+    s.name = debug_name();
+    s.live = base::size;
+    s.tombstones = base::entries.size() - base::size;
+    s.capacity = base::entries.capacity();
+    s.bytes = base::entries.bytes();
+    return s;
+  }
 };
 
+// Creates empty storage for a component given only its ID, when reading serialised data. Each
+// component registers its factory at startup if its storage is used anywhere in the program.
+using storage_factory = std::unique_ptr<component_storage_base> (*)();
+inline std::array<storage_factory, kMaxComponents>& storage_factories() {
+  static std::array<storage_factory, kMaxComponents> factories{};
+  return factories;
+}
+
+template <Component C>
+inline const bool storage_factory_registered =
+    (storage_factories()[static_cast<std::size_t>(ecs::id<C>())] =
+         []() -> std::unique_ptr<component_storage_base> {
+       return std::make_unique<component_storage<C>>();
+     },
+     true);
+
+// Calls f with the index of each non-empty entry.
 template <typename T>
 void iterate(T& storage, bool include_new, auto&& f) {
   if (include_new) {
     for (std::size_t i = 0; i < storage.entries.size(); ++i) {
-      if (storage.entries[i].data) {
-        f(storage.entries[i]);
+      if (storage.entries.data(i)) {
+        f(i);
       }
     }
   } else {
     for (std::size_t i = 0, end = storage.entries.size(); i < end; ++i) {
-      if (storage.entries[i].data) {
-        f(storage.entries[i]);
+      if (storage.entries.data(i)) {
+        f(i);
       }
     }
   }
@@ -151,12 +347,10 @@ inline void EntityIndex::dump(Printer& printer, bool portable, const query& q) c
     }
     bool matches_components = q.components.empty();
     if (!matches_components) {
-      for (std::size_t i = 0; i < e.v.size(); ++i) {
-        if (e.v[i] && q.components.contains(components_[i]->debug_name())) {
-          matches_components = true;
-          break;
-        }
-      }
+      e.signature.for_each([&](component_id cid) {
+        matches_components = matches_components ||
+            q.components.contains(components_[static_cast<std::size_t>(cid)]->debug_name());
+      });
     }
     if (!matches_components) {
       continue;
@@ -166,72 +360,348 @@ inline void EntityIndex::dump(Printer& printer, bool portable, const query& q) c
       for (const auto& pair : sorted_components) {
         auto i = pair.second.first;
         const auto* c = pair.second.second;
-        if (i < e.v.size() && e.v[i] &&
+        if (e.signature.test(component_id{static_cast<index_type>(i)}) &&
             (q.components.empty() || q.components.contains(c->debug_name()))) {
-          c->dump(*e.v[i], portable, printer);
+          c->dump(e.v[i], portable, printer);
         }
       }
     } else {
-      for (std::size_t i = 0; i < e.v.size(); ++i) {
-        if (e.v[i] &&
-            (q.components.empty() || q.components.contains(components_[i]->debug_name()))) {
-          components_[i]->dump(*e.v[i], portable, printer);
+      e.signature.for_each([&](component_id cid) {
+        auto i = static_cast<std::size_t>(cid);
+        if (q.components.empty() || q.components.contains(components_[i]->debug_name())) {
+          components_[i]->dump(e.v[i], portable, printer);
         }
-      }
+      });
     }
     printer.undent();
     printer.end();
   }
 }
 
-inline void EntityIndex::copy_to(EntityIndex& target) const {
+inline void EntityIndex::copy_to(EntityIndex& target, bool delta) const {
+  // The last sync between the two indexes may have been in either direction.
+  std::optional<detail::sync_epochs> epochs;
+  bool reverse = false;
+  if (delta && target.synced_source_.id == sync_id_ &&
+      target.synced_self_.id == target.sync_id_) {
+    epochs = {target.synced_source_.epoch, target.synced_self_.epoch, target.epoch_};
+  } else if (delta && synced_source_.id == target.sync_id_ && synced_self_.id == sync_id_) {
+    epochs = {synced_self_.epoch, synced_source_.epoch, target.epoch_};
+    reverse = true;
+  }
+  auto modified = [&](std::size_t i) {
+    return !epochs || i >= next_entity_table_index_ || i >= target.next_entity_table_index_ ||
+        entity_tables_[i].epoch > epochs->source || target.entity_tables_[i].epoch > epochs->target;
+  };
+
+  // Entity tables are replicated to the same slots, so the slot map can be copied as-is.
   target.next_id_ = next_id_;
-  target.entities_.clear();
-  auto size = entities_.size();
-  if (target.entity_tables_.size() < size) {
-    target.entity_tables_.resize(size);
+  target.entities_ = entities_;
+  if (target.entity_tables_.size() < next_entity_table_index_) {
+    target.entity_tables_.resize(next_entity_table_index_);
   }
-  for (std::size_t i = 0; const auto& table : entity_tables_) {
-    if (table.id) {
-      auto& table_copy = target.entity_tables_[i++];
-      table_copy.id = *table.id;
-      table_copy.v.clear();
-      table_copy.v.resize(table.v.size());
-      target.entities_.emplace(*table.id, &table_copy);
+  for (std::size_t i = 0; i < next_entity_table_index_; ++i) {
+    if (!modified(i)) {
+      continue;
     }
+    const auto& table = entity_tables_[i];
+    auto& table_copy = target.entity_tables_[i];
+    table_copy.id = table.id;
+    table_copy.slot = table.slot;
+    table_copy.epoch = target.epoch_;
+    table_copy.copy_components(table);
   }
-  for (std::size_t i = size; i < target.next_entity_table_index_; ++i) {
+  for (std::size_t i = next_entity_table_index_; i < target.next_entity_table_index_; ++i) {
     target.entity_tables_[i].id.reset();
-    target.entity_tables_[i].v.clear();
+    target.entity_tables_[i].epoch = target.epoch_;
+    target.entity_tables_[i].clear();
   }
-  target.next_entity_table_index_ = size;
+  target.next_entity_table_index_ = next_entity_table_index_;
   target.components_.resize(components_.size());
   for (std::size_t i = 0; i < components_.size(); ++i) {
     if (components_[i]) {
-      components_[i]->copy_to(target, target.components_[i]);
+      components_[i]->copy_to(target, target.components_[i], epochs);
     } else if (target.components_[i]) {
       target.components_[i]->copy_clear();
     }
   }
+
+  target.views_ = views_;
+  target.viewed_ = viewed_;
+  target.compaction_phase_ = compaction_phase_;
+  target.compaction_cursor_ = compaction_cursor_;
+  target.compaction_passes_ = compaction_passes_;
+  target.compaction_moves_ = compaction_moves_;
+
+  if (!epochs) {
+    target.sync_id_ = detail::next_sync_id();
+    target.checksum_epoch_.reset();
+  }
+  if (reverse) {
+    synced_source_ = {target.sync_id_, target.epoch_++};
+    synced_self_ = {sync_id_, epoch_++};
+  } else {
+    target.synced_source_ = {sync_id_, epoch_++};
+    target.synced_self_ = {target.sync_id_, target.epoch_++};
+  }
 }
 
-inline void EntityIndex::compact() {
-  auto has_value = [](const detail::component_table& table) { return table.id.has_value(); };
-  auto end = entity_tables_.begin() + static_cast<std::ptrdiff_t>(next_entity_table_index_);
-  auto it = std::find_if_not(entity_tables_.begin(), end, has_value);
-  if (it == end) {
-    return;
+inline std::size_t EntityIndex::checksum() const {
+  std::size_t result = static_cast<std::size_t>(+next_id_);
+  for (const auto& c : components_) {
+    // Empty storages are skipped, since whether they exist at all depends on history.
+    if (auto h = c ? c->checksum(checksum_epoch_, checksum_scratch_) : 0; h) {
+      hash_combine(result, h);
+    }
   }
-  auto pivot = std::stable_partition(it, end, has_value);
-  for (; it != pivot; ++it) {
-    entities_[*it->id] = &*it;
+  checksum_epoch_ = epoch_++;
+  return result;
+}
+
+inline void EntityIndex::write(BinaryWriter& writer) const {
+  writer.put(next_id_).put_size(next_entity_table_index_);
+  for (std::size_t i = 0; i < next_entity_table_index_; ++i) {
+    const auto& table = entity_tables_[i];
+    std::size_t count = 0;
+    table.signature.for_each([&](component_id) { ++count; });
+    writer.put(table.id).put_size(count);
+    table.signature.for_each([&](component_id cid) {
+      writer.put(cid).put(table.v[static_cast<std::size_t>(cid)]);
+    });
   }
-  next_entity_table_index_ = static_cast<std::size_t>(std::distance(entity_tables_.begin(), pivot));
+
+  std::size_t count = 0;
+  for (const auto& c : components_) {
+    count += c ? 1 : 0;
+  }
+  writer.put_size(count);
+  for (std::size_t i = 0; i < components_.size(); ++i) {
+    if (components_[i]) {
+      components_[i]->write(writer.put(static_cast<index_type>(i)));
+    }
+  }
+
+  const auto& cursor = compaction_cursor_;
+  writer.put(compaction_phase_.has_value())
+      .put(static_cast<std::uint64_t>(compaction_phase_.value_or(0)))
+      .put(static_cast<std::uint64_t>(cursor.write))
+      .put(static_cast<std::uint64_t>(cursor.read))
+      .put(cursor.reorder)
+      .put(cursor.source)
+      .put(cursor.destination)
+      .put(compaction_passes_)
+      .put(compaction_moves_);
+}
+
+inline bool EntityIndex::read(BinaryReader& reader) {
+  // Everything is rewritten, as for the target of a full copy.
+  sync_id_ = detail::next_sync_id();
+  synced_source_ = {};
+  synced_self_ = {};
+  checksum_epoch_.reset();
+  ++epoch_;
+  auto clear_tables = [&](std::size_t end) {
+    for (std::size_t i = 0; i < end; ++i) {
+      entity_tables_[i].id.reset();
+      entity_tables_[i].epoch = epoch_;
+      entity_tables_[i].clear();
+    }
+  };
+  clear_tables(next_entity_table_index_);
+  entities_.clear();
+
+  std::size_t table_count = 0;
+  reader.get(next_id_).get_size(table_count);
+  if (entity_tables_.size() < table_count) {
+    entity_tables_.resize(table_count);
+  }
+  next_entity_table_index_ = table_count;
+  std::array<std::size_t, kMaxComponents> live{};
+  for (std::size_t i = 0; i < table_count && reader.ok(); ++i) {
+    auto& table = entity_tables_[i];
+    std::size_t count = 0;
+    reader.get(table.id).get_size(count);
+    table.slot = static_cast<index_type>(i);
+    for (std::size_t j = 0; j < count && reader.ok(); ++j) {
+      component_id cid{0};
+      index_type index = 0;
+      reader.get(cid).get(index);
+      if (static_cast<std::size_t>(cid) >= kMaxComponents) {
+        reader.fail();
+        break;
+      }
+      table.set(cid, index);
+      ++live[static_cast<std::size_t>(cid)];
+    }
+    if (table.id && entities_.contains(*table.id)) {
+      reader.fail();
+    } else if (table.id) {
+      entities_.insert(*table.id, table.slot);
+    }
+  }
+
+  // Storage of components not present in the data is cleared.
+  std::size_t next = 0;
+  auto clear_components = [&](std::size_t end) {
+    for (; next < end; ++next) {
+      if (live[next]) {
+        reader.fail();
+      } else if (next < components_.size() && components_[next]) {
+        components_[next]->clear();
+      }
+    }
+  };
+  std::size_t count = 0;
+  reader.get_size(count);
+  for (std::size_t j = 0; j < count && reader.ok(); ++j) {
+    index_type i = 0;
+    reader.get(i);
+    auto factory = i < kMaxComponents ? detail::storage_factories()[i] : nullptr;
+    if (i < next || !factory) {
+      reader.fail();
+      break;
+    }
+    clear_components(i);
+    if (i >= components_.size()) {
+      components_.resize(1 + i);
+    }
+    if (!components_[i]) {
+      components_[i] = factory();
+    }
+    components_[i]->read(*this, live[i], reader);
+    next = 1 + i;
+  }
+  clear_components(kMaxComponents);
+
+  bool has_phase = false;
+  std::uint64_t phase = 0;
+  std::uint64_t write = 0;
+  std::uint64_t read = 0;
+  auto& cursor = compaction_cursor_;
+  reader.get(has_phase)
+      .get(phase)
+      .get(write)
+      .get(read)
+      .get(cursor.reorder)
+      .get(cursor.source)
+      .get(cursor.destination)
+      .get(compaction_passes_)
+      .get(compaction_moves_);
+  compaction_phase_ = has_phase ? std::optional<std::size_t>{phase} : std::nullopt;
+  cursor.write = write;
+  cursor.read = read;
+  if (phase > components_.size() || write > read ||
+      cursor.source.size() != cursor.destination.size()) {
+    reader.fail();
+  }
+
+  for (auto& v : views_) {
+    v.dirty = true;
+  }
+  if (!reader.ok()) {
+    clear_tables(std::min(table_count, entity_tables_.size()));
+    entities_.clear();
+    next_entity_table_index_ = 0;
+    for (auto& c : components_) {
+      if (c) {
+        c->clear();
+      }
+    }
+    compaction_phase_.reset();
+    cursor = {};
+  }
+  return reader.ok();
+}
+
+inline std::string EntityIndex::debug_name(component_id cid) const {
+  auto i = static_cast<std::size_t>(cid);
+  return i < components_.size() && components_[i] ? components_[i]->debug_name() : std::string{};
+}
+
+inline index_stats EntityIndex::stats() const {
+  index_stats s;
+  s.entities = entities_.size();
+  s.entity_tables = next_entity_table_index_;
+  s.entity_table_capacity = entity_tables_.size();
+  s.index_bytes = entity_tables_.size() * sizeof(detail::component_table) + entities_.bytes();
+  for (const auto& v : views_) {
+    s.index_bytes += sizeof(v) + v.entries.capacity() * sizeof(index_type);
+  }
+  s.compaction_passes = compaction_passes_;
+  s.compaction_moves = compaction_moves_;
   for (const auto& c : components_) {
     if (c) {
-      c->compact(*this);
+      s.components.emplace_back(c->stats());
     }
   }
+  return s;
+}
+
+inline void EntityIndex::compact() {
+  compaction_phase_.reset();
+  std::vector<entity_id> moved;
+  compact_step(std::numeric_limits<std::size_t>::max(), moved);
+}
+
+template <Component C>
+void EntityIndex::set_compaction_order(compaction_key_t key) {
+  storage<C>().compaction_key = key;
+}
+
+inline bool EntityIndex::compact_step(std::size_t max_entries, std::vector<entity_id>& moved) {
+  auto& cursor = compaction_cursor_;
+  if (!compaction_phase_) {
+    compaction_phase_ = 0;
+    cursor = {};
+  }
+  auto budget = max_entries;
+  auto moved_size = moved.size();
+  if (!*compaction_phase_) {
+    for (; budget && cursor.read < next_entity_table_index_; --budget, ++cursor.read) {
+      auto& table = entity_tables_[cursor.read];
+      if (!table.id) {
+        continue;
+      }
+      if (cursor.read != cursor.write) {
+        auto slot = static_cast<index_type>(cursor.write);
+        auto& target = entity_tables_[slot];
+        target.id = table.id;
+        target.slot = slot;
+        target.epoch = epoch_;
+        target.copy_components(table);
+        table.id.reset();
+        table.epoch = epoch_;
+        table.clear();
+        entities_.assign(*target.id, slot);
+        target.signature.for_each([&](component_id cid) {
+          components_[static_cast<std::size_t>(cid)]->set_slot(
+              target.v[static_cast<std::size_t>(cid)], slot, epoch_);
+        });
+        moved.emplace_back(*target.id);
+      }
+      ++cursor.write;
+    }
+    if (cursor.read < next_entity_table_index_) {
+      compaction_moves_ += moved.size() - moved_size;
+      return false;
+    }
+    next_entity_table_index_ = cursor.write;
+    compaction_phase_ = 1;
+    cursor = {};
+  }
+  while (*compaction_phase_ <= components_.size()) {
+    if (auto& c = components_[*compaction_phase_ - 1];
+        c && !c->compact_step(*this, cursor, budget, moved)) {
+      compaction_moves_ += moved.size() - moved_size;
+      return false;
+    }
+    ++*compaction_phase_;
+    cursor = {};
+  }
+  compaction_moves_ += moved.size() - moved_size;
+  compaction_phase_.reset();
+  ++compaction_passes_;
+  return true;
 }
 
 inline auto EntityIndex::create() -> handle {
@@ -246,7 +716,9 @@ inline auto EntityIndex::create() -> handle {
     table = &entity_tables_.emplace_back();
   }
   table->id = id;
-  entities_.emplace(id, table);
+  table->slot = static_cast<index_type>(next_entity_table_index_);
+  table->epoch = epoch_;
+  entities_.insert(id, table->slot);
   ++next_entity_table_index_;
   return {id, this, table};
 }
@@ -259,26 +731,27 @@ auto EntityIndex::create(CArgs&&... cargs) -> handle {
 }
 
 inline void EntityIndex::destroy(entity_id id) {
-  auto it = entities_.find(id);
-  if (it != entities_.end()) {
-    handle{id, this, it->second}.clear();
-    it->second->id.reset();
-    entities_.erase(it);
+  if (auto slot = entities_.find(id); slot != detail::kNoIndex) {
+    auto& table = entity_tables_[slot];
+    handle{id, this, &table}.clear();
+    table.id.reset();
+    table.epoch = epoch_;
+    entities_.erase(id);
   }
 }
 
 inline auto EntityIndex::get(entity_id id) -> std::optional<handle> {
   std::optional<handle> r;
-  if (auto it = entities_.find(id); it != entities_.end()) {
-    r = {id, this, it->second};
+  if (auto slot = entities_.find(id); slot != detail::kNoIndex) {
+    r = {id, this, &entity_tables_[slot]};
   }
   return r;
 }
 
 inline auto EntityIndex::get(entity_id id) const -> std::optional<const_handle> {
   std::optional<const_handle> r;
-  if (auto it = entities_.find(id); it != entities_.end()) {
-    r = {id, this, it->second};
+  if (auto slot = entities_.find(id); slot != detail::kNoIndex) {
+    r = {id, this, &entity_tables_[slot]};
   }
   return r;
 }
@@ -327,45 +800,202 @@ void EntityIndex::on_component_remove(const component_remove_callback<C>& f) {
 template <Component C>
 void EntityIndex::iterate(std::invocable<C&> auto&& f, bool include_new) {
   if (auto* c = storage_get<C>()) {
-    detail::iterate(*c, include_new, [&](auto& e) { f(*e.data); });
+    detail::iterate(*c, include_new, [&](std::size_t i) {
+      c->entries.mark(i, epoch_);
+      f(*c->entries.data(i));
+    });
   }
 }
 
 template <Component C>
 void EntityIndex::iterate(std::invocable<const C&> auto&& f, bool include_new) const {
   if (auto* c = storage_get<C>(); c) {
-    detail::iterate(*c, include_new, [&](const auto& e) { f(*e.data); });
+    detail::iterate(*c, include_new, [&](std::size_t i) { f(*c->entries.data(i)); });
   }
 }
 
 template <Component C>
 void EntityIndex::iterate_dispatch(auto&& f, bool include_new) {
   if (auto* c = storage_get<C>(); c) {
-    detail::iterate(*c, include_new, [&](auto& e) { dispatch(*get(e.id), f); });
+    detail::iterate(*c, include_new, [&](std::size_t i) { dispatch(entry_handle(*c, i), f); });
   }
 }
 
 template <Component C>
 void EntityIndex::iterate_dispatch(auto&& f, bool include_new) const {
   if (auto* c = storage_get<C>(); c) {
-    detail::iterate(*c, include_new, [&](const auto& e) { dispatch(*get(e.id), f); });
+    detail::iterate(*c, include_new, [&](std::size_t i) { dispatch(entry_handle(*c, i), f); });
   }
 }
 
+// If f requires components other than C, iterates the view of entries that have them all, rather
+// than checking every entry of C.
 template <Component C>
 void EntityIndex::iterate_dispatch_if(auto&& f, bool include_new) {
+  constexpr auto required = detail::dispatch_required_components<decltype(f)>();
   if (auto* c = storage_get<C>(); c) {
-    detail::iterate(*c, include_new, [&](auto& e) { dispatch_if(*get(e.id), f); });
+    if constexpr (component_signature::of<C>().contains(required)) {
+      detail::iterate(*c, include_new, [&](std::size_t i) { dispatch(entry_handle(*c, i), f); });
+    } else {
+      auto signature = component_signature::of<C>();
+      signature |= required;
+      auto end = include_new ? std::numeric_limits<std::size_t>::max() : c->entries.size();
+      iterate_view(view<C>(signature), end,
+                   [&](std::size_t i) { dispatch(entry_handle(*c, i), f); });
+    }
   }
 }
 
 template <Component C>
 void EntityIndex::iterate_dispatch_if(auto&& f, bool include_new) const {
+  constexpr auto required = detail::dispatch_required_components<decltype(f)>();
   if (auto* c = storage_get<C>(); c) {
-    detail::iterate(*c, include_new, [&](const auto& e) { dispatch_if(*get(e.id), f); });
+    if constexpr (component_signature::of<C>().contains(required)) {
+      detail::iterate(*c, include_new, [&](std::size_t i) { dispatch(entry_handle(*c, i), f); });
+    } else {
+      auto signature = component_signature::of<C>();
+      signature |= required;
+      auto end = include_new ? std::numeric_limits<std::size_t>::max() : c->entries.size();
+      iterate_view(view<C>(signature), end,
+                   [&](std::size_t i) { dispatch(entry_handle(*c, i), f); });
+    }
+  }
+}
+
+template <Component C, typename T>
+void EntityIndex::iterate_dispatch_parallel(JobPool* pool, std::vector<T>& outputs, auto&& f,
+                                            std::size_t min_chunk_size) const {
+  // Up to this many chunks are made per thread, so that uneven chunks balance out.
+  static constexpr std::size_t kChunksPerThread = 4;
+  const auto* c = storage_get<C>();
+  auto size = c ? c->entries.size() : 0;
+  std::size_t chunks = 0;
+  if (size) {
+    auto max_chunks = pool ? pool->concurrency() * kChunksPerThread : 1;
+    chunks = std::clamp<std::size_t>(size / std::max<std::size_t>(min_chunk_size, 1), 1,
+                                     max_chunks);
+  }
+  outputs.resize(chunks);
+  auto run_chunk = [&](std::size_t k) {
+    for (auto i = size * k / chunks, end = size * (k + 1) / chunks; i < end; ++i) {
+      if (c->entries.data(i)) {
+        dispatch(entry_handle(*c, i), f, outputs[k]);
+      }
+    }
+  };
+  if (pool) {
+    pool->parallel_for(chunks, run_chunk);
+  } else if (chunks) {
+    run_chunk(0);
+  }
+}
+
+template <Component C>
+detail::query_view& EntityIndex::view(const component_signature& signature) const {
+  std::lock_guard lock{*views_mutex_};
+  detail::query_view* v = nullptr;
+  for (auto& view : views_) {
+    if (view.primary == ecs::id<C>() && view.signature == signature) {
+      v = &view;
+      break;
+    }
+  }
+  if (!v) {
+    v = &views_.emplace_back();
+    v->primary = ecs::id<C>();
+    v->signature = signature;
+    viewed_ |= signature;
+  }
+  if (v->dirty) {
+    v->entries.clear();
+    if (const auto* c = storage_get<C>(); c) {
+      detail::iterate(*c, /* include_new */ true, [&](std::size_t i) {
+        if (entity_tables_[c->entries.slot(i)].signature.contains(signature)) {
+          v->entries.emplace_back(static_cast<index_type>(i));
+        }
+      });
+    }
+    v->dirty = false;
+    ++v->version;
+  }
+  return *v;
+}
+
+inline void EntityIndex::iterate_view(detail::query_view& view, std::size_t end, auto&& f) const {
+  std::size_t position = 0;
+  std::size_t next_index = 0;
+  for (auto version = view.version;; ++position) {
+    if (view.version != version) {
+      version = view.version;
+      position = static_cast<std::size_t>(
+          std::lower_bound(view.entries.begin(), view.entries.end(), next_index) -
+          view.entries.begin());
+    }
+    if (position >= view.entries.size() || view.entries[position] >= end) {
+      break;
+    }
+    next_index = view.entries[position] + 1;
+    f(static_cast<std::size_t>(view.entries[position]));
+  }
+}
+
+inline void
+EntityIndex::views_add(const detail::component_table& table, component_id cid) const {
+  if (!viewed_.test(cid)) {
+    return;
+  }
+  for (auto& v : views_) {
+    if (!v.dirty && v.signature.test(cid) && table.signature.contains(v.signature)) {
+      v.insert(table.v[static_cast<std::size_t>(v.primary)]);
+    }
+  }
+}
+
+inline void
+EntityIndex::views_remove(const detail::component_table& table, component_id cid) const {
+  if (!viewed_.test(cid)) {
+    return;
+  }
+  for (auto& v : views_) {
+    if (!v.dirty && v.signature.test(cid) && table.signature.contains(v.signature)) {
+      v.erase(table.v[static_cast<std::size_t>(v.primary)]);
+    }
+  }
+}
+
+inline void EntityIndex::views_move(component_id primary, std::size_t from, std::size_t to) const {
+  // Compaction only moves entries back over empty ones, so the view stays sorted.
+  for (auto& v : views_) {
+    if (v.dirty || v.primary != primary) {
+      continue;
+    }
+    if (auto it = std::lower_bound(v.entries.begin(), v.entries.end(), from);
+        it != v.entries.end() && *it == from) {
+      *it = static_cast<index_type>(to);
+      ++v.version;
+    }
+  }
+}
+
+inline void EntityIndex::views_clear(const detail::component_table& table) const {
+  for (auto& v : views_) {
+    if (!v.dirty && table.signature.contains(v.signature)) {
+      v.erase(table.v[static_cast<std::size_t>(v.primary)]);
+    }
   }
 }
 
+template <Component C>
+auto EntityIndex::entry_handle(const detail::component_storage_get<C>& c, std::size_t i) -> handle {
+  return {c.entries.id(i), this, &entity_tables_[c.entries.slot(i)]};
+}
+
+template <Component C>
+auto EntityIndex::entry_handle(const detail::component_storage_get<C>& c, std::size_t i) const
+    -> const_handle {
+  return {c.entries.id(i), this, &entity_tables_[c.entries.slot(i)]};
+}
+
 template <Component C>
 auto EntityIndex::storage() -> detail::component_storage<C>& {
   auto c_id = static_cast<std::size_t>(ecs::id<C>());
@@ -375,6 +1005,7 @@ auto EntityIndex::storage() -> detail::component_storage<C>& {
   if (!components_[c_id]) {
     components_[c_id] = std::make_unique<detail::component_storage<C>>();
   }
+  (void)detail::storage_factory_registered<C>;
   return static_cast<detail::component_storage<C>&>(*components_[c_id]);
 }
 
@@ -410,20 +1041,23 @@ C& handle_base<Const>::emplace(Args&&... args) const
   auto& storage = index_->template storage<C>();
   auto index = table_->template get<C>();
   if (index) {
-    auto& e = storage.entries[*index];
-    e.data.emplace(std::forward<Args>(args)...);
-    return *e.data;
+    auto& data = storage.entries.data(*index);
+    storage.entries.mark(*index, index_->epoch_);
+    data.emplace(std::forward<Args>(args)...);
+    return *data;
   }
   ++storage.size;
   index = static_cast<index_type>(storage.entries.size());
-  auto& e = storage.entries.emplace_back();
-  e.id = id();
-  e.data.emplace(std::forward<Args>(args)...);
+  auto& data = storage.entries.emplace_back(id(), table_->slot);
+  storage.entries.mark(*index, index_->epoch_);
+  data.emplace(std::forward<Args>(args)...);
   table_->template set<C>(*index);
+  table_->epoch = index_->epoch_;
+  index_->views_add(*table_, ecs::id<C>());
   for (const auto& f : storage.add_callbacks) {
-    f(*this, *e.data);
+    f(*this, *data);
   }
-  return *e.data;
+  return *data;
 }
 
 template <bool Const>
@@ -439,11 +1073,14 @@ void handle_base<Const>::remove() const requires(!Const)
 {
   if (auto index = table_->template get<C>(); index) {
     auto& c = index_->template storage<C>();
-    for (const auto& f : c.remove_callbacks()) {
-      f(*this, *c.entries[*index].data);
+    for (const auto& f : c.remove_callbacks) {
+      f(*this, *c.entries.data(*index));
     }
+    index_->views_remove(*table_, ecs::id<C>());
     table_->template reset<C>();
-    c.entries[*index].data.reset();
+    table_->epoch = index_->epoch_;
+    c.entries.data(*index).reset();
+    c.entries.mark(*index, index_->epoch_);
     --c.size;
   }
 }
@@ -451,23 +1088,29 @@ void handle_base<Const>::remove() const requires(!Const)
 template <bool Const>
 void handle_base<Const>::clear() const requires(!Const)
 {
-  for (std::size_t i = 0; i < table_->v.size(); ++i) {
-    if (table_->v[i]) {
-      index_->components_[i]->remove_index(*this, *table_->v[i]);
-    }
-  }
-  table_->v.clear();
+  table_->signature.for_each([&](component_id cid) {
+    auto i = static_cast<std::size_t>(cid);
+    index_->components_[i]->remove_index(*this, table_->v[i], index_->epoch_);
+  });
+  index_->views_clear(*table_);
+  table_->clear();
+  table_->epoch = index_->epoch_;
 }
 
 template <bool Const>
 template <Component C>
 bool handle_base<Const>::has() const {
-  return table_->template get<C>().has_value();
+  return table_->signature.test(ecs::id<C>());
 }
 
 template <bool Const>
 bool handle_base<Const>::has(component_id cid) const {
-  return table_->get(cid).has_value();
+  return table_->signature.test(cid);
+}
+
+template <bool Const>
+bool handle_base<Const>::has_all(const component_signature& s) const {
+  return table_->signature.contains(s);
 }
 
 template <bool Const>
@@ -475,7 +1118,9 @@ template <Component C>
 C* handle_base<Const>::get() const requires(!Const)
 {
   if (auto index = table_->template get<C>(); index) {
-    return &*index_->template storage_get<C>()->entries[*index].data;
+    auto& entries = index_->template storage_get<C>()->entries;
+    entries.mark(*index, index_->epoch_);
+    return &*entries.data(*index);
   }
   return nullptr;
 }
@@ -485,7 +1130,7 @@ template <Component C>
 const C* handle_base<Const>::get() const requires Const
 {
   if (auto index = table_->template get<C>(); index) {
-    return &*index_->template storage_get<C>()->entries[*index].data;
+    return &*index_->template storage_get<C>()->entries.data(*index);
   }
   return nullptr;
 }
@@ -0,0 +1,47 @@
+#ifndef II_GAME_LOGIC_ECS_STATS_H
+#define II_GAME_LOGIC_ECS_STATS_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ii::ecs {
+
+// Occupancy of one component's storage. Tombstones are entries left empty by removed components,
+// which take up space until compaction reclaims them. Bytes counts the storage itself, but not
+// any memory owned by the component data (e.g. vector contents).
+struct component_stats {
+  std::uint32_t id = 0;
+  std::string name;
+  std::size_t live = 0;
+  std::size_t tombstones = 0;
+  std::size_t capacity = 0;
+  std::size_t bytes = 0;
+};
+
+// Memory and occupancy of an EntityIndex, as returned by EntityIndex::stats().
+struct index_stats {
+  std::size_t entities = 0;
+  // Entity table slots in use (including empty slots not yet compacted away), and allocated.
+  std::size_t entity_tables = 0;
+  std::size_t entity_table_capacity = 0;
+  // Entity tables, the entity ID map and query views.
+  std::size_t index_bytes = 0;
+  // Completed compaction passes, and entity table and component entry moves made by compaction.
+  std::uint64_t compaction_passes = 0;
+  std::uint64_t compaction_moves = 0;
+  // One entry for each component that has ever been added, in order of component ID.
+  std::vector<component_stats> components;
+
+  std::size_t total_bytes() const {
+    auto total = index_bytes;
+    for (const auto& c : components) {
+      total += c.bytes;
+    }
+    return total;
+  }
+};
+
+}  // namespace ii::ecs
+
+#endif
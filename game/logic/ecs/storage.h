@@ -0,0 +1,235 @@
+#ifndef II_GAME_LOGIC_ECS_STORAGE_H
+#define II_GAME_LOGIC_ECS_STORAGE_H
+#include "game/logic/ecs/detail.h"
+#include "game/logic/ecs/id.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ii::ecs::detail {
+
+// Component entry storage backends. Both backends share the same interface; entries are addressed
+// by index, and each records the owning entity ID and entity table slot alongside the (optional)
+// component data. Removed components leave an empty entry until the storage is compacted.
+//
+// Addresses of component data must remain stable as the storage grows, since components are
+// routinely added while iterating.
+//
+// Modifications are stamped with the owning index's epoch via mark(), so that copy_modified_to()
+// can skip entries that haven't changed on either side since the two storages were last synced.
+// Entries it does rewrite are stamped in the target, so that they appear modified to anything else
+// synced with the target. Stamps are tracked per block of kBlockSize entries, and can be queried
+// with block_epoch().
+
+// Structure-of-arrays storage in fixed-size pages. Iteration walks contiguous arrays, and copies
+// are bulk copies of each page (memcpy for trivially-copyable components).
+template <Component C>
+class paged_storage {
+public:
+  static constexpr std::size_t kPageSize = 256;
+  static constexpr std::size_t kBlockSize = kPageSize;
+
+  paged_storage() = default;
+  paged_storage(paged_storage&&) noexcept = default;
+  paged_storage(const paged_storage&) = delete;
+  paged_storage& operator=(paged_storage&&) noexcept = default;
+  paged_storage& operator=(const paged_storage&) = delete;
+
+  std::size_t size() const { return size_; }
+  std::size_t capacity() const { return pages_.size() * kPageSize; }
+  std::size_t bytes() const {
+    return pages_.size() * sizeof(page_t) + pages_.capacity() * sizeof(pages_.front());
+  }
+
+  entity_id id(std::size_t i) const { return page(i).ids[i % kPageSize]; }
+  index_type slot(std::size_t i) const { return page(i).slots[i % kPageSize]; }
+  void set_slot(std::size_t i, index_type slot) { page(i).slots[i % kPageSize] = slot; }
+  std::optional<C>& data(std::size_t i) { return page(i).data[i % kPageSize]; }
+  const std::optional<C>& data(std::size_t i) const { return page(i).data[i % kPageSize]; }
+
+  std::optional<C>& emplace_back(entity_id id, index_type slot) {
+    if (size_ == capacity()) {
+      pages_.emplace_back(std::make_unique<page_t>());
+    }
+    auto i = size_++;
+    auto& p = page(i);
+    p.ids[i % kPageSize] = id;
+    p.slots[i % kPageSize] = slot;
+    return p.data[i % kPageSize];
+  }
+
+  void move(std::size_t from, std::size_t to) {
+    auto& f = page(from);
+    auto& t = page(to);
+    t.ids[to % kPageSize] = f.ids[from % kPageSize];
+    t.slots[to % kPageSize] = f.slots[from % kPageSize];
+    t.data[to % kPageSize] = std::move(f.data[from % kPageSize]);
+    f.data[from % kPageSize].reset();
+  }
+
+  void swap(std::size_t i, std::size_t j) {
+    auto& a = page(i);
+    auto& b = page(j);
+    std::swap(a.ids[i % kPageSize], b.ids[j % kPageSize]);
+    std::swap(a.slots[i % kPageSize], b.slots[j % kPageSize]);
+    std::swap(a.data[i % kPageSize], b.data[j % kPageSize]);
+  }
+
+  void truncate(std::size_t size) {
+    for (std::size_t i = size; i < size_; ++i) {
+      data(i).reset();
+    }
+    size_ = std::min(size, size_);
+  }
+
+  void clear() { truncate(0); }
+  void mark(std::size_t i, std::uint64_t epoch) { page(i).epoch = epoch; }
+  std::uint64_t block_epoch(std::size_t block) const { return pages_[block]->epoch; }
+
+  // Replicates all entries (including empty ones) to the target, preserving indexes.
+  void copy_to(paged_storage& target) const {
+    copy_pages_to(target, [](std::size_t, const page_t&, page_t&) { return true; });
+  }
+
+  // As copy_to(), but only replicates pages marked after the given epochs in this storage or the
+  // target (or that extend past the end of the target). Valid only if the storages were identical
+  // at those epochs.
+  void copy_modified_to(paged_storage& target, const sync_epochs& epochs) const {
+    auto target_size = target.size_;
+    copy_pages_to(target, [&](std::size_t i, const page_t& source_page, page_t& target_page) {
+      if ((i + 1) * kPageSize > target_size || source_page.epoch > epochs.source ||
+          target_page.epoch > epochs.target) {
+        target_page.epoch = epochs.stamp;
+        return true;
+      }
+      return false;
+    });
+  }
+
+private:
+  struct page_t {
+    std::array<entity_id, kPageSize> ids;
+    std::array<index_type, kPageSize> slots;
+    std::array<std::optional<C>, kPageSize> data;
+    std::uint64_t epoch = 0;
+  };
+
+  void copy_pages_to(paged_storage& target, auto&& copy_page) const {
+    target.truncate(size_);
+    while (target.capacity() < size_) {
+      target.pages_.emplace_back(std::make_unique<page_t>());
+    }
+    for (std::size_t i = 0; i * kPageSize < size_; ++i) {
+      const auto& source_page = *pages_[i];
+      auto& target_page = *target.pages_[i];
+      if (!copy_page(i, source_page, target_page)) {
+        continue;
+      }
+      auto n = std::min(kPageSize, size_ - i * kPageSize);
+      std::memcpy(target_page.ids.data(), source_page.ids.data(), n * sizeof(entity_id));
+      std::memcpy(target_page.slots.data(), source_page.slots.data(), n * sizeof(index_type));
+      if constexpr (std::is_trivially_copyable_v<std::optional<C>>) {
+        std::memcpy(target_page.data.data(), source_page.data.data(), n * sizeof(std::optional<C>));
+      } else {
+        std::copy_n(source_page.data.begin(), n, target_page.data.begin());
+      }
+    }
+    target.size_ = size_;
+  }
+
+  page_t& page(std::size_t i) { return *pages_[i / kPageSize]; }
+  const page_t& page(std::size_t i) const { return *pages_[i / kPageSize]; }
+
+  std::vector<std::unique_ptr<page_t>> pages_;
+  std::size_t size_ = 0;
+};
+
+// Array-of-structures storage backed by a deque.
+template <Component C>
+class deque_storage {
+public:
+  static constexpr std::size_t kBlockSize = 256;
+
+  deque_storage() = default;
+  deque_storage(deque_storage&&) noexcept = default;
+  deque_storage(const deque_storage&) = delete;
+  deque_storage& operator=(deque_storage&&) noexcept = default;
+  deque_storage& operator=(const deque_storage&) = delete;
+
+  std::size_t size() const { return entries_.size(); }
+  std::size_t capacity() const { return entries_.size(); }
+  // Ignores the deque's own block overhead.
+  std::size_t bytes() const { return entries_.size() * sizeof(entry); }
+
+  entity_id id(std::size_t i) const { return entries_[i].id; }
+  index_type slot(std::size_t i) const { return entries_[i].slot; }
+  void set_slot(std::size_t i, index_type slot) { entries_[i].slot = slot; }
+  std::optional<C>& data(std::size_t i) { return entries_[i].data; }
+  const std::optional<C>& data(std::size_t i) const { return entries_[i].data; }
+
+  std::optional<C>& emplace_back(entity_id id, index_type slot) {
+    auto& e = entries_.emplace_back();
+    e.id = id;
+    e.slot = slot;
+    return e.data;
+  }
+
+  void move(std::size_t from, std::size_t to) {
+    entries_[to].id = entries_[from].id;
+    entries_[to].slot = entries_[from].slot;
+    entries_[to].data = std::move(entries_[from].data);
+    entries_[from].data.reset();
+  }
+
+  void swap(std::size_t i, std::size_t j) { std::swap(entries_[i], entries_[j]); }
+
+  void truncate(std::size_t size) {
+    if (size < entries_.size()) {
+      entries_.erase(entries_.begin() + static_cast<std::ptrdiff_t>(size), entries_.end());
+    }
+  }
+
+  void clear() { entries_.clear(); }
+  void mark(std::size_t, std::uint64_t) {}
+  // Modifications aren't tracked, so every block always appears modified.
+  std::uint64_t block_epoch(std::size_t) const { return std::numeric_limits<std::uint64_t>::max(); }
+
+  void copy_to(deque_storage& target) const {
+    target.entries_.resize(entries_.size());
+    std::copy(entries_.begin(), entries_.end(), target.entries_.begin());
+  }
+
+  // Modifications aren't tracked, so this always replicates everything.
+  void copy_modified_to(deque_storage& target, const sync_epochs&) const {
+    copy_to(target);
+  }
+
+private:
+  struct entry {
+    entity_id id{0};
+    index_type slot = 0;
+    std::optional<C> data;
+  };
+  std::deque<entry> entries_;
+};
+
+#ifdef II_ECS_DEQUE_STORAGE
+template <Component C>
+using storage_type = deque_storage<C>;
+#else
+template <Component C>
+using storage_type = paged_storage<C>;
+#endif
+
+}  // namespace ii::ecs::detail
+
+#endif
@@ -9,11 +9,12 @@ namespace {
 using namespace geom;
 
 struct ChaserBossSharedState : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyChaserBossSharedState;
   bool has_counted = false;
   std::uint32_t count = 0;
   std::uint32_t cycle = 0;
 };
-DEBUG_STRUCT_TUPLE(ChaserBossSharedState, count, cycle);
+DEBUG_STRUCT_TUPLE(ChaserBossSharedState, has_counted, count, cycle);
 
 struct split_lookup_entry {
   fixed hp_reduce_power = 0;
@@ -56,6 +57,7 @@ constexpr std::array<std::uint32_t, 128> kPow1_15Lookup = {
     44455628, 51123971};
 
 struct ChaserBoss : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyChaserBoss;
   static constexpr std::uint32_t kBaseHp = 60;
   static constexpr std::uint32_t kMaxSplit = 7;
   static constexpr std::uint32_t kTimer = 60;
@@ -93,6 +95,7 @@ struct ChaserBoss : ecs::component {
     }
   }
 
+  ChaserBoss() = default;
   ChaserBoss(SimInterface& sim, std::uint32_t cycle, std::uint32_t split, std::uint32_t time,
              std::uint32_t stagger)
   : on_screen{split != 0}, timer{time}, cycle{cycle}, split{split}, stagger{stagger} {
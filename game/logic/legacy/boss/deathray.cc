@@ -13,6 +13,7 @@ constexpr cvec4 c3 = colour::hue(0.f, .6f, 0.f);
 using namespace geom;
 
 struct DeathRay : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyDeathRay;
   static constexpr float kZIndex = 0.f;
   static constexpr sound kDestroySound = sound::kEnemyDestroy;
   static constexpr rumble_type kDestroyRumble = rumble_type::kNone;
@@ -48,6 +49,7 @@ void spawn_death_ray(SimInterface& sim, const vec2& position) {
 }
 
 struct DeathArm : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyDeathArm;
   static constexpr float kZIndex = 4.f;
   static constexpr sound kDestroySound = sound::kPlayerDestroy;
   static constexpr rumble_type kDestroyRumble = rumble_type::kLarge;
@@ -77,6 +79,7 @@ struct DeathArm : ecs::component {
             start > 0 ? shape_flag::kVulnerable : shape_flag::kDangerous | shape_flag::kVulnerable);
   }
 
+  DeathArm() = default;
   DeathArm(ecs::entity_id death_boss, bool is_top)
   : death_boss{death_boss}, is_top{is_top}, timer{is_top ? 2 * kTimer / 3 : 0} {}
   ecs::entity_id death_boss{0};
@@ -161,6 +164,7 @@ ecs::handle spawn_death_arm(SimInterface& sim, ecs::handle boss, bool is_top, st
 }
 
 struct DeathRayBoss : public ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyDeathRayBoss;
   static constexpr std::uint32_t kBaseHp = 600;
   static constexpr std::uint32_t kArmHp = 100;
   static constexpr std::uint32_t kRayTimer = 100;
@@ -393,7 +397,7 @@ struct DeathRayBoss : public ecs::component {
   std::uint32_t get_damage(std::uint32_t damage) const { return arms.empty() ? damage : 0u; }
 };
 DEBUG_STRUCT_TUPLE(DeathRayBoss, arms, timer, laser, dir, pos, arm_timer, shot_timer,
-                   ray_attack_timer, ray_src1, ray_src2, ray_dest);
+                   ray_attack_timer, ray_src1, ray_src2, ray_dest, shot_queue);
 
 void DeathArm::on_destroy(ecs::const_handle h, SimInterface& sim, EmitHandle& e) const {
   auto& r = resolve_entity_shape<default_shape_definition<DeathArm>>(h, sim);
@@ -14,6 +14,7 @@ constexpr cvec4 c2 = colour::hue360(270, .2f);
 using namespace geom;
 
 struct GhostWall : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyGhostWall;
   static constexpr sound kDestroySound = sound::kEnemyDestroy;
   static constexpr rumble_type kDestroyRumble = rumble_type::kNone;
   static constexpr fixed kSpeed = 3 + 1_fx / 2;
@@ -53,6 +54,7 @@ struct GhostWall : ecs::component {
     parameters.add(key{'v'}, transform.centre).add(key{'V'}, vertical).add(key{'G'}, gap_swap);
   }
 
+  GhostWall() = default;
   GhostWall(const vec2& dir, bool vertical, bool gap_swap)
   : dir{dir}, vertical{vertical}, gap_swap{gap_swap} {}
   vec2 dir{0};
@@ -97,6 +99,7 @@ void spawn_ghost_wall_horizontal(SimInterface& sim, bool swap, bool swap_gap) {
 }
 
 struct GhostMine : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyGhostMine;
   static constexpr sound kDestroySound = sound::kEnemyDestroy;
   static constexpr rumble_type kDestroyRumble = rumble_type::kNone;
   static constexpr float kZIndex = 0.f;
@@ -118,6 +121,7 @@ struct GhostMine : ecs::component {
         .add(key{'C'}, !timer);
   }
 
+  GhostMine() = default;
   GhostMine(ecs::entity_id ghost_boss) : ghost_boss{ghost_boss} {}
   std::uint32_t timer = 80;
   ecs::entity_id ghost_boss{0};
@@ -152,6 +156,7 @@ void spawn_ghost_mine(SimInterface& sim, const vec2& position, ecs::const_handle
 }
 
 struct GhostBoss : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyGhostBoss;
   static constexpr std::uint32_t kBaseHp = 700;
   static constexpr std::uint32_t kTimer = 250;
   static constexpr std::uint32_t kAttackTime = 100;
@@ -472,9 +477,8 @@ struct GhostBoss : ecs::component {
                            .flags = shape_flag::kDangerous | shape_flag::kEnemyInteraction});
   }
 
-  geom::hit_result check_collision(ecs::const_handle h, const Transform& transform,
-                                   const geom::check_t& check, const SimInterface& sim) const {
-    geom::hit_result result;
+  void check_collision(ecs::const_handle h, const Transform& transform, const geom::check_t& check,
+                       const SimInterface& sim, geom::hit_result& result) const {
     auto c = check;
     c.legacy_algorithm = sim.is_legacy();
 
@@ -498,7 +502,6 @@ struct GhostBoss : ecs::component {
         }
       }
     }
-    return result;
   }
 
   void render_override(ecs::const_handle h, const Health& health,
@@ -515,9 +518,11 @@ struct GhostBoss : ecs::component {
                                                                       -16.f, colour_override);
   }
 };
-DEBUG_STRUCT_TUPLE(GhostBoss, visible, shot_type, rdir, danger_enable, vtime, timer, attack,
-                   attack_time, start_time, danger_circle, danger_offset1, danger_offset2,
-                   danger_offset3, danger_offset4);
+DEBUG_STRUCT_TUPLE(GhostBoss, visible, shot_type, rdir, danger_enable, is_legacy, vtime, timer,
+                   attack, attack_time, start_time, danger_circle, danger_offset1, danger_offset2,
+                   danger_offset3, danger_offset4, outer_dangerous, inner_ring_rotation,
+                   outer_ball_rotation, outer_rotation, box_attack_shape_enabled,
+                   collision_enabled);
 
 }  // namespace
 
@@ -10,6 +10,7 @@ namespace {
 using namespace geom;
 
 struct ShieldBombBoss : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyShieldBombBoss;
   static constexpr std::uint32_t kBaseHp = 320;
   static constexpr std::uint32_t kTimer = 100;
   static constexpr std::uint32_t kUnshieldTime = 300;
@@ -9,6 +9,7 @@ namespace {
 using namespace geom;
 
 struct BigSquareBoss : public ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyBigSquareBoss;
   static constexpr std::uint32_t kBaseHp = 400;
   static constexpr std::uint32_t kTimer = 100;
   static constexpr std::uint32_t kSTimer = 80;
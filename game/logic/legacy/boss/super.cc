@@ -11,6 +11,7 @@ namespace {
 using namespace geom;
 
 struct SuperBossArc : public ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacySuperBossArc;
   static constexpr std::uint32_t kBaseHp = 75;
   static constexpr float kZIndex = -4.f;
   static constexpr auto kFlags = shape_flag::kDangerous | shape_flag::kVulnerable |
@@ -42,6 +43,7 @@ struct SuperBossArc : public ecs::component {
 
   static constexpr fixed bounding_width(bool is_legacy) { return is_legacy ? 640 : 130; }
 
+  SuperBossArc() = default;
   SuperBossArc(ecs::entity_id boss, std::uint32_t i, std::uint32_t timer)
   : boss{boss}, i{i}, timer{timer} {}
   ecs::entity_id boss{0};
@@ -79,7 +81,7 @@ struct SuperBossArc : public ecs::component {
     e.play_random(sound::kExplosion, v);
   }
 };
-DEBUG_STRUCT_TUPLE(SuperBossArc, boss, i, timer, s_timer);
+DEBUG_STRUCT_TUPLE(SuperBossArc, boss, i, timer, s_timer, colours);
 
 ecs::handle spawn_super_boss_arc(SimInterface& sim, const vec2& position, std::uint32_t cycle,
                                  std::uint32_t i, ecs::handle boss, std::uint32_t timer = 0) {
@@ -109,6 +111,7 @@ ecs::handle spawn_super_boss_arc(SimInterface& sim, const vec2& position, std::u
 }
 
 struct SuperBoss : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacySuperBoss;
   enum class state { kArrive, kIdle, kAttack };
   static constexpr std::uint32_t kBaseHp = 520;
   static constexpr float kZIndex = -4.f;
@@ -138,6 +141,7 @@ struct SuperBoss : ecs::component {
 
   static constexpr fixed bounding_width(bool is_legacy) { return is_legacy ? 640 : 50; }
 
+  SuperBoss() = default;
   SuperBoss(std::uint32_t cycle) : cycle{cycle} {}
   state state = state::kArrive;
   std::uint32_t cycle = 0;
@@ -297,7 +301,7 @@ struct SuperBoss : ecs::component {
     }
   }
 };
-DEBUG_STRUCT_TUPLE(SuperBoss, state, cycle, ctimer, timer, snakes, arcs);
+DEBUG_STRUCT_TUPLE(SuperBoss, state, cycle, ctimer, timer, snakes, arcs, colours);
 
 }  // namespace
 
@@ -9,6 +9,7 @@ namespace {
 using namespace geom;
 
 struct TractorBoss : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyTractorBoss;
   static constexpr std::uint32_t kBaseHp = 900;
   static constexpr std::uint32_t kTimer = 100;
   static constexpr fixed kSpeed = 2;
@@ -82,6 +83,7 @@ struct TractorBoss : ecs::component {
 
   static constexpr fixed bounding_width(bool is_legacy) { return is_legacy ? 640 : 140; }
 
+  TractorBoss() = default;
   TractorBoss(SimInterface& sim) : shoot_type{sim.random_bool()} {}
   bool will_attack = false;
   bool stopped = false;
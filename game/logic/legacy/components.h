@@ -8,6 +8,7 @@
 namespace ii::legacy {
 
 struct PlayerScore : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyPlayerScore;
   std::uint64_t score = 0;
   std::uint32_t multiplier = 1;
   std::uint32_t multiplier_count = 0;
@@ -16,6 +17,7 @@ struct PlayerScore : ecs::component {
 DEBUG_STRUCT_TUPLE(PlayerScore, score, multiplier, multiplier_count);
 
 struct GlobalData : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyGlobalData;
   static constexpr std::uint32_t kBombDamage = 50;
   static constexpr std::uint32_t kStartingLives = 2;
   static constexpr std::uint32_t kBossModeLives = 1;
@@ -36,7 +38,9 @@ struct GlobalData : ecs::component {
   void pre_update(SimInterface&);                // Runs before any other entity updates.
   void post_update(ecs::handle, SimInterface&);  // Runs after any other entity updates.
 };
-DEBUG_STRUCT_TUPLE(GlobalData, lives, non_wall_enemy_count, overmind_wave_timer, player_kill_queue);
+DEBUG_STRUCT_TUPLE(GlobalData::fireworks_entry, time, position, colour);
+DEBUG_STRUCT_TUPLE(GlobalData, lives, non_wall_enemy_count, overmind_wave_timer, player_kill_queue,
+                   fireworks, extra_enemy_warnings);
 
 }  // namespace ii::legacy
 
@@ -7,6 +7,7 @@ namespace {
 using namespace geom;
 
 struct FollowHub : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyFollowHub;
   static constexpr float kZIndex = 0.f;
   static constexpr sound kDestroySound = sound::kPlayerDestroy;
   static constexpr rumble_type kDestroyRumble = rumble_type::kLarge;
@@ -43,6 +44,7 @@ struct FollowHub : ecs::component {
         .add(key{'p'}, power_b);
   }
 
+  FollowHub() = default;
   FollowHub(bool power_a, bool power_b) : power_a{power_a}, power_b{power_b} {}
   std::uint32_t timer = 0;
   vec2 dir{0};
@@ -92,6 +94,7 @@ struct FollowHub : ecs::component {
 DEBUG_STRUCT_TUPLE(FollowHub, timer, dir, count, power_a, power_b);
 
 struct Shielder : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyShielder;
   static constexpr float kZIndex = 0.f;
   static constexpr sound kDestroySound = sound::kPlayerDestroy;
   static constexpr rumble_type kDestroyRumble = rumble_type::kLarge;
@@ -132,6 +135,7 @@ struct Shielder : ecs::component {
         .add(key{'c'}, power ? c1 : c0);
   }
 
+  Shielder() = default;
   Shielder(bool power) : power{power} {}
   vec2 dir{0, 1};
   std::uint32_t timer = 0;
@@ -185,6 +189,7 @@ struct Shielder : ecs::component {
 DEBUG_STRUCT_TUPLE(Shielder, dir, timer, is_rotating, anti, power);
 
 struct Tractor : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyTractor;
   static constexpr float kZIndex = 0.f;
   static constexpr sound kDestroySound = sound::kPlayerDestroy;
   static constexpr rumble_type kDestroyRumble = rumble_type::kLarge;
@@ -228,6 +233,7 @@ struct Tractor : ecs::component {
   bool spinning = false;
   fixed spoke_r = 0;
 
+  Tractor() = default;
   Tractor(bool power) : power{power} {}
 
   void update(Transform& transform, SimInterface& sim) {
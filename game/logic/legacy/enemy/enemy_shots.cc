@@ -7,6 +7,7 @@ namespace {
 using namespace geom;
 
 struct BossShot : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyBossShot;
   static constexpr float kZIndex = 16.f;
   static constexpr sound kDestroySound = sound::kEnemyDestroy;
   static constexpr rumble_type kDestroyRumble = rumble_type::kNone;
@@ -28,6 +29,7 @@ struct BossShot : ecs::component {
         .add(key{'c'}, colour);
   }
 
+  BossShot() = default;
   BossShot(const vec2& velocity, const cvec4& colour, fixed rotate_speed)
   : velocity{velocity}, colour{colour}, rotate_speed{rotate_speed} {}
   std::uint32_t timer = 0;
@@ -56,7 +58,7 @@ struct BossShot : ecs::component {
     }
   }
 };
-DEBUG_STRUCT_TUPLE(BossShot, timer, velocity, rotate_speed);
+DEBUG_STRUCT_TUPLE(BossShot, timer, velocity, colour, rotate_speed);
 }  // namespace
 
 void spawn_boss_shot(SimInterface& sim, const vec2& position, const vec2& velocity,
@@ -7,6 +7,7 @@ namespace {
 using namespace geom;
 
 struct Bounce : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyBounce;
   static constexpr float kZIndex = 8.f;
   static constexpr sound kDestroySound = sound::kEnemyShatter;
   static constexpr rumble_type kDestroyRumble = rumble_type::kSmall;
@@ -23,6 +24,7 @@ struct Bounce : ecs::component {
     parameters.add(key{'v'}, transform.centre).add(key{'r'}, transform.rotation);
   }
 
+  Bounce() = default;
   Bounce(fixed angle) : dir{from_polar_legacy(angle, 3_fx)} {}
   vec2 dir{0};
 
@@ -40,6 +42,7 @@ struct Bounce : ecs::component {
 DEBUG_STRUCT_TUPLE(Bounce, dir);
 
 struct Follow : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyFollow;
   static constexpr float kZIndex = 8.f;
   static constexpr sound kDestroySound = sound::kEnemyShatter;
   static constexpr rumble_type kDestroyRumble = rumble_type::kSmall;
@@ -65,6 +68,7 @@ struct Follow : ecs::component {
         .add(key{'b'}, is_big_follow);
   }
 
+  Follow() = default;
   Follow(bool is_big_follow) : is_big_follow{is_big_follow} {}
   std::uint32_t timer = 0;
   std::optional<ecs::entity_id> target;
@@ -100,6 +104,7 @@ struct Follow : ecs::component {
 DEBUG_STRUCT_TUPLE(Follow, timer, target, is_big_follow);
 
 struct Chaser : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyChaser;
   static constexpr float kZIndex = 8.f;
   static constexpr sound kDestroySound = sound::kEnemyShatter;
   static constexpr rumble_type kDestroyRumble = rumble_type::kSmall;
@@ -8,6 +8,7 @@ using namespace geom;
 ecs::handle spawn_snake_tail(SimInterface& sim, const vec2& position, const cvec4& colour);
 
 struct SnakeTail : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacySnakeTail;
   static constexpr float kZIndex = 11.f;
   static constexpr sound kDestroySound = sound::kPlayerDestroy;
   static constexpr rumble_type kDestroyRumble = rumble_type::kNone;
@@ -26,6 +27,7 @@ struct SnakeTail : ecs::component {
         .add(key{'c'}, colour);
   }
 
+  SnakeTail() = default;
   SnakeTail(const cvec4& colour) : colour{colour} {}
   std::optional<ecs::entity_id> tail;
   std::optional<ecs::entity_id> head;
@@ -66,9 +68,10 @@ struct SnakeTail : ecs::component {
     }
   }
 };
-DEBUG_STRUCT_TUPLE(SnakeTail, tail, head, timer, d_timer);
+DEBUG_STRUCT_TUPLE(SnakeTail, tail, head, timer, d_timer, colour);
 
 struct Snake : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacySnake;
   static constexpr float kZIndex = 12.f;
   static constexpr sound kDestroySound = sound::kPlayerDestroy;
   static constexpr rumble_type kDestroyRumble = rumble_type::kMedium;
@@ -98,6 +101,7 @@ struct Snake : ecs::component {
   cvec4 colour{0.f};
   fixed projectile_rotation = 0;
 
+  Snake() = default;
   Snake(SimInterface& sim, const cvec4& colour, const vec2& direction, fixed rotation)
   : start_colour{colour}, colour{colour}, projectile_rotation{rotation} {
     if (direction == vec2{0}) {
@@ -149,7 +153,8 @@ struct Snake : ecs::component {
     }
   }
 };
-DEBUG_STRUCT_TUPLE(Snake, tail, timer, dir, count, is_projectile, projectile_rotation);
+DEBUG_STRUCT_TUPLE(Snake, tail, timer, dir, count, is_projectile, start_colour, colour,
+                   projectile_rotation);
 
 ecs::handle spawn_snake_tail(SimInterface& sim, const vec2& position, const cvec4& colour) {
   auto h = create_ship<SnakeTail>(sim, position);
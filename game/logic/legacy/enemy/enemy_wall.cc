@@ -9,6 +9,7 @@ namespace {
 using namespace geom;
 
 struct Square : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacySquare;
   static constexpr float kZIndex = -8.f;
   static constexpr sound kDestroySound = sound::kEnemyDestroy;
   static constexpr rumble_type kDestroyRumble = rumble_type::kLow;
@@ -34,6 +35,7 @@ struct Square : ecs::component {
   std::uint32_t timer = 0;
   bool invisible_flash = false;
 
+  Square() = default;
   Square(SimInterface& sim, fixed dir_angle)
   : dir{from_polar_legacy(dir_angle, 1_fx)}, timer{sim.random(80) + 40} {}
 
@@ -86,6 +88,7 @@ struct Square : ecs::component {
 DEBUG_STRUCT_TUPLE(Square, dir, timer, invisible_flash);
 
 struct Wall : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyWall;
   static constexpr float kZIndex = -8.f;
   static constexpr sound kDestroySound = sound::kEnemyDestroy;
   static constexpr rumble_type kDestroyRumble = rumble_type::kLow;
@@ -105,6 +108,7 @@ struct Wall : ecs::component {
     parameters.add(key{'v'}, transform.centre).add(key{'r'}, transform.rotation);
   }
 
+  Wall() = default;
   Wall(bool rdir) : rdir{rdir} {}
   vec2 dir{0, 1};
   std::uint32_t timer = 0;
@@ -17,6 +17,7 @@ namespace ii::legacy {
 namespace {
 
 struct Overmind : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyOvermind;
   static constexpr std::uint32_t kTimer = 2800;
   static constexpr std::uint32_t kPowerupTime = 1200;
   static constexpr std::uint32_t kBossRestTime = 240;
@@ -54,6 +55,7 @@ struct Overmind : ecs::component {
   std::uint32_t bosses_to_go = 0;
   std::vector<entry> formations;
 
+  Overmind() = default;
   Overmind(SimInterface& sim) {
     add_formations();
 
@@ -453,9 +455,11 @@ struct Overmind : ecs::component {
                      [](const entry& a, const entry& b) { return a.cost < b.cost; });
   }
 };
+DEBUG_STRUCT_TUPLE(Overmind::entry, id, cost, min_resource, function);
 DEBUG_STRUCT_TUPLE(Overmind, power, timer, levels_mod, groups_mod, boss_mod_bosses, boss_mod_fights,
                    boss_mod_secret, powerup_mod, lives_spawned, lives_target, boss_rest_timer,
-                   waves_total, is_boss_next, is_boss_level);
+                   waves_total, stars_compatibility, is_boss_next, is_boss_level, boss1_queue,
+                   boss2_queue, bosses_to_go, formations);
 
 }  // namespace
 
@@ -13,6 +13,7 @@ using namespace geom;
 constexpr std::uint32_t kMagicShotCount = 120;
 
 struct Shot : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyShot;
   static constexpr fixed kSpeed = 10;
   static constexpr float kZIndex = 64.f;
   static constexpr fixed kBoundingWidth = 0;
@@ -32,6 +33,7 @@ struct Shot : ecs::component {
         .add(key{'d'}, colour::alpha(colour, .2f));
   }
 
+  Shot() = default;
   Shot(ecs::entity_id player, std::uint32_t player_number, bool is_predicted, const vec2& direction,
        bool magic)
   : player{player}
@@ -114,7 +116,7 @@ struct Shot : ecs::component {
     }
   }
 };
-DEBUG_STRUCT_TUPLE(Shot, player, player_number, velocity, magic);
+DEBUG_STRUCT_TUPLE(Shot, player, player_number, is_predicted, velocity, magic, colour);
 
 void spawn_shot(SimInterface& sim, const vec2& position, ecs::handle player, const vec2& direction,
                 bool magic) {
@@ -124,6 +126,7 @@ void spawn_shot(SimInterface& sim, const vec2& position, ecs::handle player, con
 }
 
 struct PlayerLogic : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyPlayerLogic;
   static constexpr std::uint32_t kReviveTime = 100;
   static constexpr std::uint32_t kShieldTime = 50;
   static constexpr std::uint32_t kShotTimer = 4;
@@ -172,6 +175,7 @@ struct PlayerLogic : ecs::component {
         .add(key{'b'}, static_cast<bool>(pc.bomb_count));
   }
 
+  PlayerLogic() = default;
   PlayerLogic(const SimInterface& sim, const vec2& target)
   : is_what_mode{sim.conditions().mode == game_mode::kLegacy_What}, fire_target{target} {}
   bool is_what_mode = false;
@@ -228,7 +232,7 @@ struct PlayerLogic : ecs::component {
     }
 
     // Bombs.
-    if (!pc.is_predicted && pc.bomb_count && input.keys & input_frame::kBomb) {
+    if (pc.bomb_count && input.keys & input_frame::kBomb && !sim.suppress_predicted(pc)) {
       auto c = legacy_player_colour(pc.player_number);
       pc.bomb_count = 0;
 
@@ -277,8 +281,8 @@ struct PlayerLogic : ecs::component {
     }
 
     // Damage.
-    if (!pc.is_predicted &&
-        sim.collide_any(check_point(shape_flag::kDangerous, transform.centre))) {
+    if (sim.collide_any(check_point(shape_flag::kDangerous, transform.centre)) &&
+        !sim.suppress_predicted(pc)) {
       damage(h, pc, score, transform, sim);
     }
   }
@@ -364,7 +368,8 @@ struct PlayerLogic : ecs::component {
 
   bool should_render() const { return !kill_timer && (!is_what_mode || invulnerability_timer); }
 };
-DEBUG_STRUCT_TUPLE(PlayerLogic, is_what_mode, invulnerability_timer, fire_timer, fire_target);
+DEBUG_STRUCT_TUPLE(PlayerLogic, is_what_mode, invulnerability_timer, fire_timer, kill_timer,
+                   fire_target);
 
 }  // namespace
 
@@ -12,6 +12,7 @@ using namespace geom;
 constexpr std::uint32_t kMagicShotCount = 120;
 
 struct Powerup : ecs::component {
+  static constexpr auto kComponentId = sim_component::kLegacyPowerup;
   static constexpr float kZIndex = -2.f;
   static constexpr std::uint32_t kRotateTime = 100;
   static constexpr fixed kSpeed = 1;
@@ -43,6 +44,7 @@ struct Powerup : ecs::component {
         .add(key{'t'}, type);
   }
 
+  Powerup() = default;
   Powerup(powerup_type type) : type{type} {}
   powerup_type type = powerup_type::kExtraLife;
   std::uint32_t frame = 0;
@@ -74,7 +76,7 @@ struct Powerup : ecs::component {
     dir = normalise(dir);
 
     transform.move(dir * kSpeed * ((length(pv) <= 40) ? 3 : 1));
-    if (length(pv) <= 10 && !p.is_predicted && !p.is_killed) {
+    if (length(pv) <= 10 && !p.is_killed && !sim.suppress_predicted(p)) {
       collect(h, transform, sim, ph);
     }
   }
@@ -79,25 +79,21 @@ void destruct_entity_default(ecs::const_handle h, SimInterface& sim, EmitHandle&
 // Collision.
 //////////////////////////////////////////////////////////////////////////////////
 template <typename ShapeDefinition>
-geom::hit_result
-ship_check_collision(ecs::const_handle h, const geom::check_t& check, const SimInterface& sim) {
-  geom::hit_result result;
+void ship_check_collision(ecs::const_handle h, const geom::check_t& check,
+                          const SimInterface& sim, geom::hit_result& result) {
   geom::check_collision(
       result, check, sim.shape_bank(), ShapeDefinition::construct_shape,
       [&h](geom::parameter_set& parameters) { ShapeDefinition::set_parameters(h, parameters); });
-  return result;
 }
 
 template <typename ShapeDefinition>
-geom::hit_result ship_check_collision_legacy(ecs::const_handle h, const geom::check_t& check,
-                                             const SimInterface& sim) {
-  geom::hit_result result;
+void ship_check_collision_legacy(ecs::const_handle h, const geom::check_t& check,
+                                 const SimInterface& sim, geom::hit_result& result) {
   auto legacy_check = check;
   legacy_check.legacy_algorithm = true;
   geom::check_collision(
       result, legacy_check, sim.shape_bank(), ShapeDefinition::construct_shape,
       [&h](geom::parameter_set& parameters) { ShapeDefinition::set_parameters(h, parameters); });
-  return result;
 }
 
 //////////////////////////////////////////////////////////////////////////////////
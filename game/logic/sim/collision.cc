@@ -3,19 +3,136 @@
 #include "game/common/variant_switch.h"
 #include "game/geometry/types.h"
 #include <algorithm>
+#include <array>
 #include <bit>
 #include <cmath>
+#include <optional>
 #include <unordered_set>
 
 namespace ii {
 
+void CollisionIndex::collide_batch(std::span<const geom::check_t> checks,
+                                   SimInterface::collision_arena& arena) const {
+  auto& centres = arena.buffer().shape_centres;
+  for (const auto& check : checks) {
+    arena.begin_check();
+    for (const auto& c : collide(check)) {
+      auto begin = centres.size();
+      centres.insert(centres.end(), c.shape_centres.begin(), c.shape_centres.end());
+      arena.add(c.h, c.hit_mask, begin);
+    }
+    arena.end_check(/* sort_by_id */ false);
+  }
+}
+
+namespace {
+// Looks up an entity read from serialised data, which must have the components its entry refers to.
+std::optional<ecs::handle>
+read_handle(BinaryReader& reader, ecs::EntityIndex& index, ecs::entity_id id) {
+  auto h = index.get(id);
+  if (!h || !h->has<Transform>() || !h->has<Collision>()) {
+    reader.fail();
+    return std::nullopt;
+  }
+  return h;
+}
+}  // namespace
+
+namespace detail {
+
+collision_grid::collision_grid(const uvec2& cell_dimensions, const ivec2& min_point,
+                               const ivec2& max_point)
+: cell_power{std::bit_width(std::bit_ceil(cell_dimensions.x)),
+             std::bit_width(std::bit_ceil(cell_dimensions.y))}
+, cell_offset{cell_coords(min_point)}
+, cell_count{ivec2{1, 1} + cell_coords(max_point) - cell_offset} {}
+
+ivec2 collision_grid::cell_position(const ivec2& c) const {
+  return {c.x << cell_power.x, c.y << cell_power.y};
+}
+
+ivec2 collision_grid::cell_coords(const ivec2& v) const {
+  return {v.x >> cell_power.x, v.y >> cell_power.y};
+}
+
+ivec2 collision_grid::cell_coords(const vec2& v) const {
+  return cell_coords(ivec2{v.x.to_int(), v.y.to_int()});
+}
+
+ivec2 collision_grid::min_coords(const vec2& v) const {
+  return glm::max(cell_coords(v), cell_offset);
+}
+
+ivec2 collision_grid::max_coords(const vec2& v) const {
+  return glm::min(cell_coords(v), cell_offset + cell_count - ivec2{1, 1});
+}
+
+bool collision_grid::is_cell_valid(const ivec2& cell_coords) const {
+  auto c = cell_coords - cell_offset;
+  return glm::all(glm::greaterThanEqual(c, ivec2{0, 0})) && glm::all(glm::lessThan(c, cell_count));
+}
+
+std::size_t collision_grid::cell_index(const ivec2& cell_coords) const {
+  auto c = cell_coords - cell_offset;
+  auto i = static_cast<std::size_t>(c.y * cell_count.x + c.x);
+  assert(i < cell_total());
+  return i;
+}
+
+std::size_t collision_grid::cell_total() const {
+  return static_cast<std::size_t>(cell_count.x) * cell_count.y;
+}
+
+}  // namespace detail
+
 GridCollisionIndex::GridCollisionIndex(const uvec2& cell_dimensions, const ivec2& min_point,
                                        const ivec2& max_point)
-: cell_power_{std::bit_width(std::bit_ceil(cell_dimensions.x)),
-              std::bit_width(std::bit_ceil(cell_dimensions.y))}
-, cell_offset_{cell_coords(min_point)}
-, cell_count_{ivec2{1, 1} + cell_coords(max_point) - cell_offset_} {
-  cells_.resize(static_cast<std::size_t>(cell_count_.x) * cell_count_.y);
+: grid_{cell_dimensions, min_point, max_point} {
+  cells_.resize(grid_.cell_total());
+}
+
+void GridCollisionIndex::write(BinaryWriter& writer) const {
+  writer.put_size(cells_.size());
+  for (const auto& c : cells_) {
+    writer.put(c.entries).put(c.centres);
+  }
+  // Written in ID order, so that the same state always serialises identically.
+  std::vector<ecs::entity_id> ids;
+  ids.reserve(entities_.size());
+  for (const auto& pair : entities_) {
+    ids.emplace_back(pair.first);
+  }
+  std::sort(ids.begin(), ids.end());
+  writer.put_size(ids.size());
+  for (auto id : ids) {
+    const auto& e = entities_.find(id)->second;
+    writer.put(id).put(e.min).put(e.max).put(e.centre);
+  }
+}
+
+bool GridCollisionIndex::read(BinaryReader& reader, ecs::EntityIndex& index) {
+  std::size_t size = 0;
+  if (reader.get_size(size); size != cells_.size()) {
+    reader.fail();
+  }
+  for (auto& c : cells_) {
+    reader.get(c.entries).get(c.centres);
+  }
+  entities_.clear();
+  reader.get_size(size);
+  for (std::size_t i = 0; i < size && reader.ok(); ++i) {
+    ecs::entity_id id{0};
+    ivec2 min{0};
+    ivec2 max{0};
+    ivec2 centre{0};
+    reader.get(id).get(min).get(max).get(centre);
+    if (auto h = read_handle(reader, index, id); h) {
+      ecs::const_handle ch{*h};
+      entities_.emplace(
+          id, entry_t{id, *h, ch.get<Transform>(), ch.get<Collision>(), min, max, centre});
+    }
+  }
+  return reader.ok();
 }
 
 void GridCollisionIndex::refresh_handles(const SimInterface& interface, ecs::EntityIndex& index) {
@@ -23,8 +140,20 @@ void GridCollisionIndex::refresh_handles(const SimInterface& interface, ecs::Ent
   for (auto& pair : entities_) {
     auto& e = pair.second;
     e.handle = *index.get(e.id);
-    e.collision = e.handle.get<Collision>();
-    e.transform = e.handle.get<Transform>();
+    e.collision = ecs::const_handle{e.handle}.get<Collision>();
+    e.transform = ecs::const_handle{e.handle}.get<Transform>();
+  }
+}
+
+void GridCollisionIndex::refresh_handles(ecs::EntityIndex& index,
+                                         std::span<const ecs::entity_id> ids) {
+  for (auto id : ids) {
+    if (auto it = entities_.find(id); it != entities_.end()) {
+      auto& e = it->second;
+      e.handle = *index.get(e.id);
+      e.collision = ecs::const_handle{e.handle}.get<Collision>();
+      e.transform = ecs::const_handle{e.handle}.get<Transform>();
+    }
   }
 }
 
@@ -41,8 +170,8 @@ void GridCollisionIndex::update(ecs::handle& h) {
     return;
   }
   auto& e = it->second;
-  auto min = min_coords(e.transform->centre - e.collision->bounding_width);
-  auto max = max_coords(e.transform->centre + e.collision->bounding_width);
+  auto min = grid_.min_coords(e.transform->centre - e.collision->bounding_width);
+  auto max = grid_.max_coords(e.transform->centre + e.collision->bounding_width);
   if (min != e.min || max != e.max) {
     clear_cells(it->first, e);
     insert_cells(it->first, e);
@@ -61,7 +190,8 @@ void GridCollisionIndex::remove(ecs::handle& h) {
 void GridCollisionIndex::begin_tick() {}
 
 template <typename F>
-void GridCollisionIndex::iterate_collision_cells(const geom::check_t& check, const F& f) const {
+void GridCollisionIndex::iterate_collision_cells(const geom::check_t& check, geom::hit_result& hit,
+                                                 const F& f) const {
   static thread_local std::unordered_set<ecs::entity_id> checked;
   checked.clear();
 
@@ -76,16 +206,20 @@ void GridCollisionIndex::iterate_collision_cells(const geom::check_t& check, con
     if (!check_bounds(min, max)) {
       return false;
     }
-    if (auto hit = c.check_collision(e.handle, check, *interface_); +hit.mask) {
-      return f(e.handle, hit);
+    auto begin = hit.shape_centres.size();
+    hit.mask = shape_flag::kNone;
+    c.check_collision(e.handle, check, *interface_, hit);
+    if (+hit.mask) {
+      return f(e.handle, hit, begin);
     }
+    hit.shape_centres.resize(begin);
     return false;
   };
 
   switch (check.extent.index()) {
     VARIANT_CASE_GET(geom::check_point_t, check.extent, ic) {
-      auto coords = cell_coords(ic.v);
-      if (!is_cell_valid(coords)) {
+      auto coords = grid_.cell_coords(ic.v);
+      if (!grid_.is_cell_valid(coords)) {
         return;
       }
       for (auto id : cell(coords).entries) {
@@ -99,12 +233,12 @@ void GridCollisionIndex::iterate_collision_cells(const geom::check_t& check, con
     }
 
     VARIANT_CASE_GET(geom::check_line_t, check.extent, ic) {
-      auto c = cell_coords(ic.a);
-      auto end = cell_coords(ic.b);
+      auto c = grid_.cell_coords(ic.a);
+      auto end = grid_.cell_coords(ic.b);
       ivec2 cv{end.x > c.x ? 1 : end.x == c.x ? 0 : -1, end.y > c.y ? 1 : end.y == c.y ? 0 : -1};
       bool done = false;
       while (!done) {
-        if (is_cell_valid(c)) {
+        if (grid_.is_cell_valid(c)) {
           for (auto id : cell(c).entries) {
             if (checked.contains(id)) {
               continue;
@@ -125,8 +259,9 @@ void GridCollisionIndex::iterate_collision_cells(const geom::check_t& check, con
           c.y += cv.y;
         } else if (c.y == end.y) {
           c.x += cv.x;
-        } else if (intersect_aabb_line(cell_position({c.x, c.y + cv.y}),
-                                       cell_position({c.x + 1, c.y + cv.y + 1}), ic.a, ic.b)) {
+        } else if (intersect_aabb_line(grid_.cell_position({c.x, c.y + cv.y}),
+                                       grid_.cell_position({c.x + 1, c.y + cv.y + 1}), ic.a,
+                                       ic.b)) {
           c.y += cv.y;
         } else {
           c.x += cv.x;
@@ -136,8 +271,8 @@ void GridCollisionIndex::iterate_collision_cells(const geom::check_t& check, con
     }
 
     VARIANT_CASE_GET(geom::check_ball_t, check.extent, ic) {
-      auto min = min_coords(ic.c - ic.r);
-      auto max = max_coords(ic.c + ic.r);
+      auto min = grid_.min_coords(ic.c - ic.r);
+      auto max = grid_.max_coords(ic.c + ic.r);
       bool done = false;
       for (std::int32_t y = min.y; !done && y <= max.y; ++y) {
         for (std::int32_t x = min.x; !done && x <= max.x; ++x) {
@@ -165,8 +300,8 @@ void GridCollisionIndex::iterate_collision_cells(const geom::check_t& check, con
       std::optional<ivec2> min;
       std::optional<ivec2> max;
       for (const auto& v : ic.vs) {
-        min = min ? glm::min(*min, min_coords(v)) : min_coords(v);
-        max = max ? glm::max(*max, max_coords(v)) : max_coords(v);
+        min = min ? glm::min(*min, grid_.min_coords(v)) : grid_.min_coords(v);
+        max = max ? glm::max(*max, grid_.max_coords(v)) : grid_.max_coords(v);
       }
       bool done = false;
       for (std::int32_t y = min->y; !done && y <= max->y; ++y) {
@@ -192,17 +327,21 @@ void GridCollisionIndex::iterate_collision_cells(const geom::check_t& check, con
 
 bool GridCollisionIndex::collide_any(const geom::check_t& check) const {
   bool result = false;
-  iterate_collision_cells(check,
-                          [&](ecs::handle, const geom::hit_result&) { return result = true; });
+  geom::hit_result hit;
+  iterate_collision_cells(check, hit, [&](ecs::handle, const geom::hit_result&, std::size_t) {
+    return result = true;
+  });
   return result;
 }
 
 std::vector<SimInterface::collision_info>
 GridCollisionIndex::collide(const geom::check_t& check) const {
   std::vector<SimInterface::collision_info> r;
-  iterate_collision_cells(check, [&](ecs::handle h, geom::hit_result& hit) {
+  geom::hit_result hit;
+  iterate_collision_cells(check, hit, [&](ecs::handle h, const geom::hit_result&, std::size_t) {
     r.emplace_back(SimInterface::collision_info{
         .h = h, .hit_mask = hit.mask, .shape_centres = std::move(hit.shape_centres)});
+    hit.shape_centres.clear();
     return false;
   });
   if (!std::holds_alternative<geom::check_point_t>(check.extent)) {
@@ -211,11 +350,24 @@ GridCollisionIndex::collide(const geom::check_t& check) const {
   return r;
 }
 
+void GridCollisionIndex::collide_batch(std::span<const geom::check_t> checks,
+                                       SimInterface::collision_arena& arena) const {
+  for (const auto& check : checks) {
+    arena.begin_check();
+    iterate_collision_cells(check, arena.buffer(),
+                            [&](ecs::handle h, const geom::hit_result& hit, std::size_t begin) {
+                              arena.add(h, hit.mask, begin);
+                              return false;
+                            });
+    arena.end_check(/* sort_by_id */ !std::holds_alternative<geom::check_point_t>(check.extent));
+  }
+}
+
 void GridCollisionIndex::in_range(const vec2& point, fixed distance, ecs::component_id cid,
                                   std::size_t max_n,
                                   std::vector<SimInterface::range_info>& output) const {
-  auto min = min_coords(point - distance);
-  auto max = max_coords(point + distance);
+  auto min = grid_.min_coords(point - distance);
+  auto max = grid_.max_coords(point + distance);
   auto output_begin = output.size();
   fixed max_distance = 0;
   std::size_t max_index = 0;
@@ -257,41 +409,12 @@ void GridCollisionIndex::in_range(const vec2& point, fixed distance, ecs::compon
             [](const auto& a, const auto& b) { return a.h.id() < b.h.id(); });
 }
 
-ivec2 GridCollisionIndex::cell_position(const ivec2& c) const {
-  return {c.x << cell_power_.x, c.y << cell_power_.y};
-}
-
-ivec2 GridCollisionIndex::cell_coords(const ivec2& v) const {
-  return {v.x >> cell_power_.x, v.y >> cell_power_.y};
-}
-
-ivec2 GridCollisionIndex::cell_coords(const vec2& v) const {
-  return cell_coords(ivec2{v.x.to_int(), v.y.to_int()});
-}
-
-ivec2 GridCollisionIndex::min_coords(const vec2& v) const {
-  return glm::max(cell_coords(v), cell_offset_);
-}
-
-ivec2 GridCollisionIndex::max_coords(const vec2& v) const {
-  return glm::min(cell_coords(v), cell_offset_ + cell_count_ - ivec2{1, 1});
-}
-
-bool GridCollisionIndex::is_cell_valid(const ivec2& cell_coords) const {
-  auto c = cell_coords - cell_offset_;
-  return glm::all(glm::greaterThanEqual(c, ivec2{0, 0})) && glm::all(glm::lessThan(c, cell_count_));
-}
-
 auto GridCollisionIndex::cell(const ivec2& cell_coords) const -> const cell_t& {
-  auto c = cell_coords - cell_offset_;
-  assert(c.y * cell_count_.x + c.x < cells_.size());
-  return cells_[c.y * cell_count_.x + c.x];
+  return cells_[grid_.cell_index(cell_coords)];
 }
 
 auto GridCollisionIndex::cell(const ivec2& cell_coords) -> cell_t& {
-  auto c = cell_coords - cell_offset_;
-  assert(c.y * cell_count_.x + c.x < cells_.size());
-  return cells_[c.y * cell_count_.x + c.x];
+  return cells_[grid_.cell_index(cell_coords)];
 }
 
 void GridCollisionIndex::clear_cells(ecs::entity_id id, entry_t& e) {
@@ -300,21 +423,21 @@ void GridCollisionIndex::clear_cells(ecs::entity_id id, entry_t& e) {
       cell(ivec2{x, y}).clear(id);
     }
   }
-  if (is_cell_valid(e.centre)) {
+  if (grid_.is_cell_valid(e.centre)) {
     cell(e.centre).clear_centre(id);
   }
 }
 
 void GridCollisionIndex::insert_cells(ecs::entity_id id, entry_t& e) {
-  e.min = min_coords(e.transform->centre - e.collision->bounding_width);
-  e.max = max_coords(e.transform->centre + e.collision->bounding_width);
-  e.centre = cell_coords(e.transform->centre);
+  e.min = grid_.min_coords(e.transform->centre - e.collision->bounding_width);
+  e.max = grid_.max_coords(e.transform->centre + e.collision->bounding_width);
+  e.centre = grid_.cell_coords(e.transform->centre);
   for (std::int32_t y = e.min.y; y <= e.max.y; ++y) {
     for (std::int32_t x = e.min.x; x <= e.max.x; ++x) {
       cell(ivec2{x, y}).insert(id);
     }
   }
-  if (is_cell_valid(e.centre)) {
+  if (grid_.is_cell_valid(e.centre)) {
     cell(e.centre).insert_centre(id);
   }
 }
@@ -343,12 +466,623 @@ void GridCollisionIndex::cell_t::clear_centre(ecs::entity_id id) {
   centres.erase(std::find(centres.begin(), centres.end(), id));
 }
 
+namespace {
+// Cached bounds only reject candidates that lie within this range, where the exact tests can't
+// overflow, and that are separated from the query by more than kBoundsMargin, so that fixed-point
+// rounding in the exact tests can't make them succeed regardless. Entries too small or large to be
+// cached safely get bounds covering the whole range, and are never rejected by the cache.
+constexpr std::int64_t kBoundsLimit = std::int64_t{1} << 45;
+constexpr std::int64_t kBoundsMargin = std::int64_t{1} << 32;
+constexpr fixed kMinCachedBoundingWidth = 1_fx / 2;
+constexpr std::size_t kRejectBatchSize = 64;
+
+bool in_bounds_limit(const vec2& v) {
+  return v.x.to_internal() > -kBoundsLimit && v.x.to_internal() < kBoundsLimit &&
+      v.y.to_internal() > -kBoundsLimit && v.y.to_internal() < kBoundsLimit;
+}
+}  // namespace
+
+PackedGridCollisionIndex::PackedGridCollisionIndex(const uvec2& cell_dimensions,
+                                                   const ivec2& min_point, const ivec2& max_point)
+: grid_{cell_dimensions, min_point, max_point} {
+  cells_.resize(grid_.cell_total());
+}
+
+void PackedGridCollisionIndex::write(BinaryWriter& writer) const {
+  writer.put_size(cells_.size());
+  for (const auto& c : cells_) {
+    writer.put(c.ids)
+        .put(c.slots)
+        .put(c.x_min)
+        .put(c.y_min)
+        .put(c.x_max)
+        .put(c.y_max)
+        .put(c.centre_ids)
+        .put(c.centre_slots);
+  }
+  writer.put_size(entries_.size());
+  for (const auto& e : entries_) {
+    writer.put(e.id)
+        .put(e.min)
+        .put(e.max)
+        .put(e.centre)
+        .put(e.cached_centre)
+        .put(e.cached_bounding_width);
+  }
+}
+
+bool PackedGridCollisionIndex::read(BinaryReader& reader, ecs::EntityIndex& index) {
+  std::size_t size = 0;
+  if (reader.get_size(size); size != cells_.size()) {
+    reader.fail();
+  }
+  for (auto& c : cells_) {
+    reader.get(c.ids)
+        .get(c.slots)
+        .get(c.x_min)
+        .get(c.y_min)
+        .get(c.x_max)
+        .get(c.y_max)
+        .get(c.centre_ids)
+        .get(c.centre_slots);
+  }
+  entries_.clear();
+  entity_slot_entries_.clear();
+  reader.get_size(size);
+  for (std::size_t i = 0; i < size && reader.ok(); ++i) {
+    ecs::entity_id id{0};
+    reader.get(id);
+    if (auto h = read_handle(reader, index, id); h) {
+      ecs::const_handle ch{*h};
+      auto& e = entries_.emplace_back(
+          entry_t{id, *h, ch.get<Transform>(), ch.get<Collision>(), h->slot()});
+      reader.get(e.min).get(e.max).get(e.centre).get(e.cached_centre).get(e.cached_bounding_width);
+      map_entity_slot(static_cast<std::uint32_t>(entries_.size() - 1));
+    }
+  }
+  for (const auto& c : cells_) {
+    auto n = c.ids.size();
+    bool valid = c.slots.size() == n && c.x_min.size() == n && c.y_min.size() == n &&
+        c.x_max.size() == n && c.y_max.size() == n && c.centre_slots.size() == c.centre_ids.size();
+    for (auto slot : c.slots) {
+      valid = valid && slot < entries_.size();
+    }
+    for (auto slot : c.centre_slots) {
+      valid = valid && slot < entries_.size();
+    }
+    if (!valid) {
+      reader.fail();
+    }
+  }
+  return reader.ok();
+}
+
+void PackedGridCollisionIndex::refresh_handles(const SimInterface& interface,
+                                               ecs::EntityIndex& index) {
+  interface_ = &interface;
+  entity_slot_entries_.clear();
+  for (std::uint32_t slot = 0; slot < entries_.size(); ++slot) {
+    auto& e = entries_[slot];
+    e.handle = *index.get(e.id);
+    e.collision = ecs::const_handle{e.handle}.get<Collision>();
+    e.transform = ecs::const_handle{e.handle}.get<Transform>();
+    e.entity_slot = e.handle.slot();
+    map_entity_slot(slot);
+  }
+}
+
+void PackedGridCollisionIndex::refresh_handles(ecs::EntityIndex& index,
+                                               std::span<const ecs::entity_id> ids) {
+  // Moved entities may have new entity table slots, so they can't be looked up by slot. Check each
+  // entry against the (sorted) IDs instead, unmapping all old slots before mapping any new ones.
+  std::vector<ecs::entity_id> sorted(ids.begin(), ids.end());
+  std::sort(sorted.begin(), sorted.end());
+  auto moved = [&](const entry_t& e) {
+    return std::binary_search(sorted.begin(), sorted.end(), e.id);
+  };
+  for (std::uint32_t slot = 0; slot < entries_.size(); ++slot) {
+    if (const auto& e = entries_[slot];
+        moved(e) && entity_slot_entries_[e.entity_slot] == slot) {
+      entity_slot_entries_[e.entity_slot] = kNoEntry;
+    }
+  }
+  for (std::uint32_t slot = 0; slot < entries_.size(); ++slot) {
+    if (auto& e = entries_[slot]; moved(e)) {
+      e.handle = *index.get(e.id);
+      e.collision = ecs::const_handle{e.handle}.get<Collision>();
+      e.transform = ecs::const_handle{e.handle}.get<Transform>();
+      e.entity_slot = e.handle.slot();
+      map_entity_slot(slot);
+    }
+  }
+}
+
+void PackedGridCollisionIndex::add(ecs::handle& h, const Collision& c) {
+  if (c.check_collision) {
+    auto slot = static_cast<std::uint32_t>(entries_.size());
+    entries_.emplace_back(entry_t{h.id(), h, h.get<Transform>(), &c, h.slot()});
+    map_entity_slot(slot);
+    insert_cells(slot);
+  }
+}
+
+void PackedGridCollisionIndex::update(ecs::handle& h) {
+  auto slot = find_slot(h);
+  if (!slot) {
+    return;
+  }
+  auto& e = entries_[*slot];
+  auto min = grid_.min_coords(e.transform->centre - e.collision->bounding_width);
+  auto max = grid_.max_coords(e.transform->centre + e.collision->bounding_width);
+  if (min != e.min || max != e.max) {
+    clear_cells(e);
+    insert_cells(*slot);
+  } else if (e.transform->centre != e.cached_centre ||
+             e.collision->bounding_width != e.cached_bounding_width) {
+    // As in GridCollisionIndex, the centre cell is left alone unless the covered cells change.
+    refresh_bounds(e);
+  }
+}
+
+void PackedGridCollisionIndex::remove(ecs::handle& h) {
+  auto found = find_slot(h);
+  if (!found) {
+    return;
+  }
+  auto slot = *found;
+  clear_cells(entries_[slot]);
+  entity_slot_entries_[entries_[slot].entity_slot] = kNoEntry;
+  if (slot + 1 != entries_.size()) {
+    entries_[slot] = std::move(entries_.back());
+    set_slot(slot);
+  }
+  entries_.pop_back();
+}
+
+void PackedGridCollisionIndex::begin_tick() {}
+
+template <typename F>
+void PackedGridCollisionIndex::iterate_collision_cells(const geom::check_t& check,
+                                                       geom::hit_result& hit, const F& f) const {
+  // Per-slot stamps of the query that last checked each entry, to skip entries in multiple cells.
+  static thread_local std::vector<std::uint32_t> checked;
+  static thread_local std::uint32_t checked_stamp = 0;
+  if (!++checked_stamp) {
+    std::fill(checked.begin(), checked.end(), 0);
+    checked_stamp = 1;
+  }
+  if (checked.size() < entries_.size()) {
+    checked.resize(entries_.size());
+  }
+
+  auto query_bounds = [](const vec2& min, const vec2& max) -> std::optional<bounds_t> {
+    if (!in_bounds_limit(min) || !in_bounds_limit(max)) {
+      return std::nullopt;
+    }
+    return bounds_t{min.x.to_internal(), min.y.to_internal(), max.x.to_internal(),
+                    max.y.to_internal()};
+  };
+
+  auto handle_entry = [&](const entry_t& e, auto&& check_bounds) {
+    const auto& c = *e.collision;
+    if (!(c.flags & check.mask)) {
+      return false;
+    }
+    auto min = e.transform->centre - e.collision->bounding_width;
+    auto max = e.transform->centre + e.collision->bounding_width;
+    if (!check_bounds(min, max)) {
+      return false;
+    }
+    auto begin = hit.shape_centres.size();
+    hit.mask = shape_flag::kNone;
+    c.check_collision(e.handle, check, *interface_, hit);
+    if (+hit.mask) {
+      return f(e.handle, hit, begin);
+    }
+    hit.shape_centres.resize(begin);
+    return false;
+  };
+
+  // Visits a cell's entries in entity ID order, returning true if iteration should stop. A cached
+  // rejection is only trusted if the entry hasn't moved since the cache was refreshed (e.g. moved
+  // by another entity).
+  auto handle_cell = [&](const cell_t& cell, const std::optional<bounds_t>& bounds, bool dedupe,
+                         auto&& check_bounds) {
+    std::array<std::uint8_t, kRejectBatchSize> rejected{};
+    for (std::size_t begin = 0; begin < cell.ids.size(); begin += rejected.size()) {
+      auto n = std::min(rejected.size(), cell.ids.size() - begin);
+      if (bounds) {
+        // Non-zero if separated on any axis. Summing rather than short-circuiting keeps the loop
+        // branch-free, so that it vectorises.
+        auto q = *bounds;
+        for (std::size_t i = 0; i < n; ++i) {
+          auto j = begin + i;
+          rejected[i] = static_cast<std::uint8_t>((cell.x_max[j] + kBoundsMargin < q.x_min) +
+                                                  (cell.x_min[j] > q.x_max + kBoundsMargin) +
+                                                  (cell.y_max[j] + kBoundsMargin < q.y_min) +
+                                                  (cell.y_min[j] > q.y_max + kBoundsMargin));
+        }
+      }
+      for (std::size_t i = 0; i < n; ++i) {
+        auto slot = cell.slots[begin + i];
+        if (dedupe) {
+          if (checked[slot] == checked_stamp) {
+            continue;
+          }
+          checked[slot] = checked_stamp;
+        }
+        const auto& e = entries_[slot];
+        if (rejected[i] && e.transform->centre == e.cached_centre &&
+            e.collision->bounding_width == e.cached_bounding_width) {
+          continue;
+        }
+        if (handle_entry(e, check_bounds)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  };
+
+  switch (check.extent.index()) {
+    VARIANT_CASE_GET(geom::check_point_t, check.extent, ic) {
+      auto coords = grid_.cell_coords(ic.v);
+      if (!grid_.is_cell_valid(coords)) {
+        return;
+      }
+      handle_cell(cell(coords), query_bounds(ic.v, ic.v), /* dedupe */ false,
+                  [&](const vec2& min, const vec2& max) {
+                    return intersect_aabb_point(min, max, ic.v);
+                  });
+      break;
+    }
+
+    VARIANT_CASE_GET(geom::check_line_t, check.extent, ic) {
+      auto bounds = query_bounds({std::min(ic.a.x, ic.b.x), std::min(ic.a.y, ic.b.y)},
+                                 {std::max(ic.a.x, ic.b.x), std::max(ic.a.y, ic.b.y)});
+      auto c = grid_.cell_coords(ic.a);
+      auto end = grid_.cell_coords(ic.b);
+      ivec2 cv{end.x > c.x ? 1 : end.x == c.x ? 0 : -1, end.y > c.y ? 1 : end.y == c.y ? 0 : -1};
+      bool done = false;
+      while (!done) {
+        if (grid_.is_cell_valid(c)) {
+          done = handle_cell(cell(c), bounds, /* dedupe */ true,
+                             [&](const vec2& min, const vec2& max) {
+                               return intersect_aabb_line(min, max, ic.a, ic.b);
+                             });
+        }
+        if (done || c == end) {
+          break;
+        }
+        if (c.x == end.x) {
+          c.y += cv.y;
+        } else if (c.y == end.y) {
+          c.x += cv.x;
+        } else if (intersect_aabb_line(grid_.cell_position({c.x, c.y + cv.y}),
+                                       grid_.cell_position({c.x + 1, c.y + cv.y + 1}), ic.a,
+                                       ic.b)) {
+          c.y += cv.y;
+        } else {
+          c.x += cv.x;
+        }
+      }
+      break;
+    }
+
+    VARIANT_CASE_GET(geom::check_ball_t, check.extent, ic) {
+      auto r = abs(ic.r);
+      auto bounds = query_bounds(ic.c - r, ic.c + r);
+      auto min = grid_.min_coords(ic.c - ic.r);
+      auto max = grid_.max_coords(ic.c + ic.r);
+      bool done = false;
+      for (std::int32_t y = min.y; !done && y <= max.y; ++y) {
+        for (std::int32_t x = min.x; !done && x <= max.x; ++x) {
+          done = handle_cell(cell({x, y}), bounds, /* dedupe */ true,
+                             [&](const vec2& b_min, const vec2& b_max) {
+                               return intersect_aabb_ball(b_min, b_max, ic.c, ic.r);
+                             });
+        }
+      }
+      break;
+    }
+
+    VARIANT_CASE_GET(geom::check_convex_t, check.extent, ic) {
+      if (ic.vs.empty()) {
+        return;
+      }
+      std::optional<ivec2> min;
+      std::optional<ivec2> max;
+      vec2 v_min = ic.vs.front();
+      vec2 v_max = ic.vs.front();
+      for (const auto& v : ic.vs) {
+        min = min ? glm::min(*min, grid_.min_coords(v)) : grid_.min_coords(v);
+        max = max ? glm::max(*max, grid_.max_coords(v)) : grid_.max_coords(v);
+        v_min = {std::min(v_min.x, v.x), std::min(v_min.y, v.y)};
+        v_max = {std::max(v_max.x, v.x), std::max(v_max.y, v.y)};
+      }
+      auto bounds = query_bounds(v_min, v_max);
+      bool done = false;
+      for (std::int32_t y = min->y; !done && y <= max->y; ++y) {
+        for (std::int32_t x = min->x; !done && x <= max->x; ++x) {
+          done = handle_cell(cell({x, y}), bounds, /* dedupe */ true,
+                             [&](const vec2& b_min, const vec2& b_max) {
+                               return intersect_aabb_convex(b_min, b_max, ic.vs);
+                             });
+        }
+      }
+      break;
+    }
+  }
+}
+
+bool PackedGridCollisionIndex::collide_any(const geom::check_t& check) const {
+  bool result = false;
+  geom::hit_result hit;
+  iterate_collision_cells(check, hit, [&](ecs::handle, const geom::hit_result&, std::size_t) {
+    return result = true;
+  });
+  return result;
+}
+
+std::vector<SimInterface::collision_info>
+PackedGridCollisionIndex::collide(const geom::check_t& check) const {
+  std::vector<SimInterface::collision_info> r;
+  geom::hit_result hit;
+  iterate_collision_cells(check, hit, [&](ecs::handle h, const geom::hit_result&, std::size_t) {
+    r.emplace_back(SimInterface::collision_info{
+        .h = h, .hit_mask = hit.mask, .shape_centres = std::move(hit.shape_centres)});
+    hit.shape_centres.clear();
+    return false;
+  });
+  if (!std::holds_alternative<geom::check_point_t>(check.extent)) {
+    std::sort(r.begin(), r.end(), [](const auto& a, const auto& b) { return a.h.id() < b.h.id(); });
+  }
+  return r;
+}
+
+void PackedGridCollisionIndex::collide_batch(std::span<const geom::check_t> checks,
+                                             SimInterface::collision_arena& arena) const {
+  for (const auto& check : checks) {
+    arena.begin_check();
+    iterate_collision_cells(check, arena.buffer(),
+                            [&](ecs::handle h, const geom::hit_result& hit, std::size_t begin) {
+                              arena.add(h, hit.mask, begin);
+                              return false;
+                            });
+    arena.end_check(/* sort_by_id */ !std::holds_alternative<geom::check_point_t>(check.extent));
+  }
+}
+
+void PackedGridCollisionIndex::in_range(const vec2& point, fixed distance, ecs::component_id cid,
+                                        std::size_t max_n,
+                                        std::vector<SimInterface::range_info>& output) const {
+  auto min = grid_.min_coords(point - distance);
+  auto max = grid_.max_coords(point + distance);
+  auto output_begin = output.size();
+  fixed max_distance = 0;
+  std::size_t max_index = 0;
+  for (std::int32_t y = min.y; y <= max.y; ++y) {
+    for (std::int32_t x = min.x; x <= max.x; ++x) {
+      for (auto slot : cell(ivec2{x, y}).centre_slots) {
+        const auto& e = entries_[slot];
+        if (!e.handle.has(cid)) {
+          continue;
+        }
+        auto d = e.transform->centre - point;
+        auto d_sq = length_squared(d);
+        if (d_sq <= distance * distance && (!max_n || output.size() - output_begin < max_n)) {
+          if (!max_distance || d_sq > max_distance) {
+            max_distance = d_sq;
+            max_index = output.size();
+          }
+          output.emplace_back(SimInterface::range_info{e.handle, d, d_sq});
+          continue;
+        }
+        if (d_sq > max_distance) {
+          continue;
+        }
+        output[max_index] = {e.handle, d, d_sq};
+        max_distance = 0;
+        for (std::size_t i = output_begin; i < output.size(); ++i) {
+          auto& o = output[i];
+          if (!max_distance || o.distance_sq > max_distance) {
+            max_distance = o.distance_sq;
+            max_index = i;
+          }
+        }
+      }
+    }
+  }
+  std::sort(output.begin() + output_begin, output.end(),
+            [](const auto& a, const auto& b) { return a.h.id() < b.h.id(); });
+}
+
+auto PackedGridCollisionIndex::cell(const ivec2& cell_coords) const -> const cell_t& {
+  return cells_[grid_.cell_index(cell_coords)];
+}
+
+auto PackedGridCollisionIndex::cell(const ivec2& cell_coords) -> cell_t& {
+  return cells_[grid_.cell_index(cell_coords)];
+}
+
+void PackedGridCollisionIndex::clear_cells(const entry_t& e) {
+  for (std::int32_t y = e.min.y; y <= e.max.y; ++y) {
+    for (std::int32_t x = e.min.x; x <= e.max.x; ++x) {
+      cell(ivec2{x, y}).clear(e.id);
+    }
+  }
+  if (grid_.is_cell_valid(e.centre)) {
+    cell(e.centre).clear_centre(e.id);
+  }
+}
+
+void PackedGridCollisionIndex::insert_cells(std::uint32_t slot) {
+  auto& e = entries_[slot];
+  e.min = grid_.min_coords(e.transform->centre - e.collision->bounding_width);
+  e.max = grid_.max_coords(e.transform->centre + e.collision->bounding_width);
+  e.centre = grid_.cell_coords(e.transform->centre);
+  auto bounds = cached_bounds(e);
+  for (std::int32_t y = e.min.y; y <= e.max.y; ++y) {
+    for (std::int32_t x = e.min.x; x <= e.max.x; ++x) {
+      cell(ivec2{x, y}).insert(e.id, slot, bounds);
+    }
+  }
+  if (grid_.is_cell_valid(e.centre)) {
+    cell(e.centre).insert_centre(e.id, slot);
+  }
+}
+
+void PackedGridCollisionIndex::refresh_bounds(entry_t& e) {
+  auto bounds = cached_bounds(e);
+  for (std::int32_t y = e.min.y; y <= e.max.y; ++y) {
+    for (std::int32_t x = e.min.x; x <= e.max.x; ++x) {
+      cell(ivec2{x, y}).set_bounds(e.id, bounds);
+    }
+  }
+}
+
+std::optional<std::uint32_t> PackedGridCollisionIndex::find_slot(const ecs::handle& h) const {
+  auto entity_slot = h.slot();
+  if (entity_slot >= entity_slot_entries_.size()) {
+    return std::nullopt;
+  }
+  auto slot = entity_slot_entries_[entity_slot];
+  if (slot == kNoEntry || entries_[slot].id != h.id()) {
+    return std::nullopt;
+  }
+  return slot;
+}
+
+void PackedGridCollisionIndex::map_entity_slot(std::uint32_t slot) {
+  auto entity_slot = entries_[slot].entity_slot;
+  if (entity_slot >= entity_slot_entries_.size()) {
+    entity_slot_entries_.resize(entity_slot + 1, kNoEntry);
+  }
+  entity_slot_entries_[entity_slot] = slot;
+}
+
+void PackedGridCollisionIndex::set_slot(std::uint32_t slot) {
+  const auto& e = entries_[slot];
+  entity_slot_entries_[e.entity_slot] = slot;
+  for (std::int32_t y = e.min.y; y <= e.max.y; ++y) {
+    for (std::int32_t x = e.min.x; x <= e.max.x; ++x) {
+      cell(ivec2{x, y}).set_slot(e.id, slot);
+    }
+  }
+  if (grid_.is_cell_valid(e.centre)) {
+    cell(e.centre).set_centre_slot(e.id, slot);
+  }
+}
+
+auto PackedGridCollisionIndex::cached_bounds(entry_t& e) -> bounds_t {
+  e.cached_centre = e.transform->centre;
+  e.cached_bounding_width = e.collision->bounding_width;
+  auto min = e.cached_centre - e.cached_bounding_width;
+  auto max = e.cached_centre + e.cached_bounding_width;
+  if (e.cached_bounding_width < kMinCachedBoundingWidth || !in_bounds_limit(min) ||
+      !in_bounds_limit(max)) {
+    return {-kBoundsLimit, -kBoundsLimit, kBoundsLimit, kBoundsLimit};
+  }
+  return {min.x.to_internal(), min.y.to_internal(), max.x.to_internal(), max.y.to_internal()};
+}
+
+std::size_t PackedGridCollisionIndex::cell_t::find(ecs::entity_id id) const {
+  return static_cast<std::size_t>(std::lower_bound(ids.begin(), ids.end(), id) - ids.begin());
+}
+
+void PackedGridCollisionIndex::cell_t::insert(ecs::entity_id id, std::uint32_t slot,
+                                              const bounds_t& bounds) {
+  auto i = static_cast<std::ptrdiff_t>(find(id));
+  ids.insert(ids.begin() + i, id);
+  slots.insert(slots.begin() + i, slot);
+  x_min.insert(x_min.begin() + i, bounds.x_min);
+  y_min.insert(y_min.begin() + i, bounds.y_min);
+  x_max.insert(x_max.begin() + i, bounds.x_max);
+  y_max.insert(y_max.begin() + i, bounds.y_max);
+}
+
+void PackedGridCollisionIndex::cell_t::clear(ecs::entity_id id) {
+  auto i = static_cast<std::ptrdiff_t>(find(id));
+  ids.erase(ids.begin() + i);
+  slots.erase(slots.begin() + i);
+  x_min.erase(x_min.begin() + i);
+  y_min.erase(y_min.begin() + i);
+  x_max.erase(x_max.begin() + i);
+  y_max.erase(y_max.begin() + i);
+}
+
+void PackedGridCollisionIndex::cell_t::set_bounds(ecs::entity_id id, const bounds_t& bounds) {
+  auto i = find(id);
+  x_min[i] = bounds.x_min;
+  y_min[i] = bounds.y_min;
+  x_max[i] = bounds.x_max;
+  y_max[i] = bounds.y_max;
+}
+
+void PackedGridCollisionIndex::cell_t::set_slot(ecs::entity_id id, std::uint32_t slot) {
+  slots[find(id)] = slot;
+}
+
+void PackedGridCollisionIndex::cell_t::insert_centre(ecs::entity_id id, std::uint32_t slot) {
+  auto i = std::lower_bound(centre_ids.begin(), centre_ids.end(), id) - centre_ids.begin();
+  centre_ids.insert(centre_ids.begin() + i, id);
+  centre_slots.insert(centre_slots.begin() + i, slot);
+}
+
+void PackedGridCollisionIndex::cell_t::clear_centre(ecs::entity_id id) {
+  auto i = std::lower_bound(centre_ids.begin(), centre_ids.end(), id) - centre_ids.begin();
+  centre_ids.erase(centre_ids.begin() + i);
+  centre_slots.erase(centre_slots.begin() + i);
+}
+
+void PackedGridCollisionIndex::cell_t::set_centre_slot(ecs::entity_id id, std::uint32_t slot) {
+  auto i = std::lower_bound(centre_ids.begin(), centre_ids.end(), id) - centre_ids.begin();
+  centre_slots[static_cast<std::size_t>(i)] = slot;
+}
+
+void LegacyCollisionIndex::write(BinaryWriter& writer) const {
+  writer.put_size(entries_.size());
+  for (const auto& e : entries_) {
+    writer.put(e.id).put(e.x_min);
+  }
+}
+
+bool LegacyCollisionIndex::read(BinaryReader& reader, ecs::EntityIndex& index) {
+  std::size_t size = 0;
+  entries_.clear();
+  reader.get_size(size);
+  for (std::size_t i = 0; i < size && reader.ok(); ++i) {
+    ecs::entity_id id{0};
+    fixed x_min = 0;
+    reader.get(id).get(x_min);
+    if (auto h = read_handle(reader, index, id); h) {
+      ecs::const_handle ch{*h};
+      entries_.emplace_back(entry{id, *h, ch.get<Transform>(), ch.get<Collision>(), x_min});
+    }
+  }
+  return reader.ok();
+}
+
 void LegacyCollisionIndex::refresh_handles(const SimInterface& interface, ecs::EntityIndex& index) {
   interface_ = &interface;
   for (auto& e : entries_) {
     e.handle = *index.get(e.id);
-    e.collision = e.handle.get<Collision>();
-    e.transform = e.handle.get<Transform>();
+    e.collision = ecs::const_handle{e.handle}.get<Collision>();
+    e.transform = ecs::const_handle{e.handle}.get<Transform>();
+  }
+}
+
+void LegacyCollisionIndex::refresh_handles(ecs::EntityIndex& index,
+                                           std::span<const ecs::entity_id> ids) {
+  // There's no lookup by ID, so check each entry against the (sorted) IDs instead.
+  std::vector<ecs::entity_id> sorted(ids.begin(), ids.end());
+  std::sort(sorted.begin(), sorted.end());
+  for (auto& e : entries_) {
+    if (std::binary_search(sorted.begin(), sorted.end(), e.id)) {
+      e.handle = *index.get(e.id);
+      e.collision = ecs::const_handle{e.handle}.get<Collision>();
+      e.transform = ecs::const_handle{e.handle}.get<Transform>();
+    }
   }
 }
 
@@ -399,8 +1133,12 @@ bool LegacyCollisionIndex::collide_any(const geom::check_t& check) const {
     if (v.x + w < x || v.y + w < y || v.y - w > y) {
       continue;
     }
-    if (+(e.flags & check.mask) && +e.check_collision(collision.handle, check, *interface_).mask) {
-      return true;
+    if (+(e.flags & check.mask)) {
+      geom::hit_result hit;
+      e.check_collision(collision.handle, check, *interface_, hit);
+      if (+hit.mask) {
+        return true;
+      }
     }
   }
   return false;
@@ -431,7 +1169,9 @@ LegacyCollisionIndex::collide(const geom::check_t& check) const {
     if (!(e.flags & check.mask)) {
       continue;
     }
-    if (auto hit = e.check_collision(collision.handle, check, *interface_); +hit.mask) {
+    geom::hit_result hit;
+    e.check_collision(collision.handle, check, *interface_, hit);
+    if (+hit.mask) {
       r.emplace_back(SimInterface::collision_info{.h = collision.handle,
                                                   .hit_mask = hit.mask,
                                                   .shape_centres = std::move(hit.shape_centres)});
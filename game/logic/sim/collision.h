@@ -1,10 +1,12 @@
 #ifndef GAME_LOGIC_SIM_COLLISION_H
 #define GAME_LOGIC_SIM_COLLISION_H
+#include "game/common/binary.h"
 #include "game/common/math.h"
 #include "game/logic/ecs/index.h"
 #include "game/logic/sim/components.h"
 #include "game/logic/sim/sim_interface.h"
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <span>
@@ -20,8 +22,16 @@ class CollisionIndex {
 public:
   virtual ~CollisionIndex() = default;
 
-  virtual std::unique_ptr<CollisionIndex> clone() = 0;
+  // Replicate to target, reusing its storage if it's of the same type.
+  virtual void copy_to(std::unique_ptr<CollisionIndex>& target) const = 0;
+  // Serialise to a state that can be read back by an index of the same type and grid. Reading
+  // looks up entities in the (already-read) entity index, failing if any are missing; handles must
+  // still be refreshed afterwards.
+  virtual void write(BinaryWriter&) const = 0;
+  virtual bool read(BinaryReader&, ecs::EntityIndex&) = 0;
   virtual void refresh_handles(const SimInterface&, ecs::EntityIndex&) = 0;
+  // Refreshes handles only for the given entities (e.g. those moved by incremental compaction).
+  virtual void refresh_handles(ecs::EntityIndex&, std::span<const ecs::entity_id> ids) = 0;
   virtual void add(ecs::handle& h, const Collision& c) = 0;
   virtual void update(ecs::handle& h) = 0;
   virtual void remove(ecs::handle& h) = 0;
@@ -29,33 +39,66 @@ public:
 
   virtual bool collide_any(const geom::check_t&) const = 0;
   virtual std::vector<SimInterface::collision_info> collide(const geom::check_t&) const = 0;
+  // Appends results of each check to the arena. By default, calls collide() for each.
+  virtual void collide_batch(std::span<const geom::check_t>, SimInterface::collision_arena&) const;
   virtual void in_range(const vec2& point, fixed distance, ecs::component_id, std::size_t max_n,
                         std::vector<SimInterface::range_info>& output) const = 0;
 };
 
+namespace detail {
+// Cell layout shared by the grid-based indexes.
+struct collision_grid {
+  collision_grid(const uvec2& cell_dimensions, const ivec2& min_point, const ivec2& max_point);
+
+  ivec2 cell_position(const ivec2& c) const;
+  ivec2 cell_coords(const ivec2& v) const;
+  ivec2 cell_coords(const vec2& v) const;
+  ivec2 max_coords(const vec2& v) const;
+  ivec2 min_coords(const vec2& v) const;
+  bool is_cell_valid(const ivec2& cell_coords) const;
+  std::size_t cell_index(const ivec2& cell_coords) const;
+  std::size_t cell_total() const;
+
+  ivec2 cell_power{0, 0};
+  ivec2 cell_offset{0, 0};
+  ivec2 cell_count{0, 0};
+};
+}  // namespace detail
+
 // TODO: probably needs optimizing.
 class GridCollisionIndex : public CollisionIndex {
 public:
   GridCollisionIndex(const uvec2& cell_dimensions, const ivec2& min_point, const ivec2& max_point);
 
   ~GridCollisionIndex() override = default;
-  std::unique_ptr<CollisionIndex> clone() override {
-    return std::make_unique<GridCollisionIndex>(*this);
+  void copy_to(std::unique_ptr<CollisionIndex>& target) const override {
+    if (auto* index = dynamic_cast<GridCollisionIndex*>(target.get()); index) {
+      *index = *this;
+    } else {
+      target = std::make_unique<GridCollisionIndex>(*this);
+    }
   }
 
+  void write(BinaryWriter&) const override;
+  bool read(BinaryReader&, ecs::EntityIndex&) override;
   void refresh_handles(const SimInterface&, ecs::EntityIndex&) override;
+  void refresh_handles(ecs::EntityIndex&, std::span<const ecs::entity_id> ids) override;
   void add(ecs::handle& h, const Collision& c) override;
   void update(ecs::handle& h) override;
   void remove(ecs::handle& h) override;
   void begin_tick() override;
 
 private:
+  // Calls f(handle, hit, centres_begin) for each entity hit. Shape centres of each hit are appended
+  // to the given result from centres_begin; those of misses are discarded.
   template <typename F>
-  void iterate_collision_cells(const geom::check_t&, const F&) const;
+  void iterate_collision_cells(const geom::check_t&, geom::hit_result&, const F&) const;
 
 public:
   bool collide_any(const geom::check_t&) const override;
   std::vector<SimInterface::collision_info> collide(const geom::check_t&) const override;
+  void collide_batch(std::span<const geom::check_t>,
+                     SimInterface::collision_arena&) const override;
   void in_range(const vec2& point, fixed distance, ecs::component_id, std::size_t max_n,
                 std::vector<SimInterface::range_info>& output) const override;
 
@@ -63,12 +106,6 @@ private:
   struct cell_t;
   struct entry_t;
 
-  ivec2 cell_position(const ivec2& c) const;
-  ivec2 cell_coords(const ivec2& v) const;
-  ivec2 cell_coords(const vec2& v) const;
-  ivec2 max_coords(const vec2& v) const;
-  ivec2 min_coords(const vec2& v) const;
-  bool is_cell_valid(const ivec2& cell_coords) const;
   const cell_t& cell(const ivec2& cell_coords) const;
   cell_t& cell(const ivec2& cell_coords);
 
@@ -95,22 +132,137 @@ private:
   };
 
   const SimInterface* interface_ = nullptr;
-  ivec2 cell_power_{0, 0};
-  ivec2 cell_offset_{0, 0};
-  ivec2 cell_count_{0, 0};
+  detail::collision_grid grid_;
   std::vector<cell_t> cells_;
   std::unordered_map<ecs::entity_id, entry_t> entities_;
 };
 
+// Same grid and results as GridCollisionIndex, but entries live in dense slots, and each cell keeps
+// a structure-of-arrays cache of its entries' bounding boxes in fixed-point. Queries reject most
+// candidates in a tight loop over the cache, rather than looking up each entry and running the
+// exact bounds test.
+class PackedGridCollisionIndex : public CollisionIndex {
+public:
+  PackedGridCollisionIndex(const uvec2& cell_dimensions, const ivec2& min_point,
+                           const ivec2& max_point);
+
+  ~PackedGridCollisionIndex() override = default;
+  void copy_to(std::unique_ptr<CollisionIndex>& target) const override {
+    if (auto* index = dynamic_cast<PackedGridCollisionIndex*>(target.get()); index) {
+      *index = *this;
+    } else {
+      target = std::make_unique<PackedGridCollisionIndex>(*this);
+    }
+  }
+
+  void write(BinaryWriter&) const override;
+  bool read(BinaryReader&, ecs::EntityIndex&) override;
+  void refresh_handles(const SimInterface&, ecs::EntityIndex&) override;
+  void refresh_handles(ecs::EntityIndex&, std::span<const ecs::entity_id> ids) override;
+  void add(ecs::handle& h, const Collision& c) override;
+  void update(ecs::handle& h) override;
+  void remove(ecs::handle& h) override;
+  void begin_tick() override;
+
+private:
+  // Calls f(handle, hit, centres_begin) for each entity hit. Shape centres of each hit are appended
+  // to the given result from centres_begin; those of misses are discarded.
+  template <typename F>
+  void iterate_collision_cells(const geom::check_t&, geom::hit_result&, const F&) const;
+
+public:
+  bool collide_any(const geom::check_t&) const override;
+  std::vector<SimInterface::collision_info> collide(const geom::check_t&) const override;
+  void collide_batch(std::span<const geom::check_t>,
+                     SimInterface::collision_arena&) const override;
+  void in_range(const vec2& point, fixed distance, ecs::component_id, std::size_t max_n,
+                std::vector<SimInterface::range_info>& output) const override;
+
+private:
+  struct cell_t;
+  struct entry_t;
+
+  const cell_t& cell(const ivec2& cell_coords) const;
+  cell_t& cell(const ivec2& cell_coords);
+
+  void clear_cells(const entry_t& e);
+  void insert_cells(std::uint32_t slot);
+  void refresh_bounds(entry_t& e);
+  void set_slot(std::uint32_t slot);
+  // Looks up the entry slot for an entity, if it has one.
+  std::optional<std::uint32_t> find_slot(const ecs::handle& h) const;
+  void map_entity_slot(std::uint32_t slot);
+
+  // Bounding box in fixed-point internal representation.
+  struct bounds_t {
+    std::int64_t x_min = 0;
+    std::int64_t y_min = 0;
+    std::int64_t x_max = 0;
+    std::int64_t y_max = 0;
+  };
+  // Updates the cached centre and bounding width of the entry, and returns its cell bounds.
+  static bounds_t cached_bounds(entry_t& e);
+
+  struct cell_t {
+    std::size_t find(ecs::entity_id id) const;
+    void insert(ecs::entity_id id, std::uint32_t slot, const bounds_t& bounds);
+    void clear(ecs::entity_id id);
+    void set_bounds(ecs::entity_id id, const bounds_t& bounds);
+    void set_slot(ecs::entity_id id, std::uint32_t slot);
+    void insert_centre(ecs::entity_id id, std::uint32_t slot);
+    void clear_centre(ecs::entity_id id);
+    void set_centre_slot(ecs::entity_id id, std::uint32_t slot);
+
+    // Sorted by entity ID.
+    std::vector<ecs::entity_id> ids;
+    std::vector<std::uint32_t> slots;
+    std::vector<std::int64_t> x_min;
+    std::vector<std::int64_t> y_min;
+    std::vector<std::int64_t> x_max;
+    std::vector<std::int64_t> y_max;
+    std::vector<ecs::entity_id> centre_ids;
+    std::vector<std::uint32_t> centre_slots;
+  };
+
+  struct entry_t {
+    ecs::entity_id id;
+    ecs::handle handle;
+    const Transform* transform = nullptr;
+    const Collision* collision = nullptr;
+    ecs::index_type entity_slot = 0;
+    ivec2 min{0, 0};
+    ivec2 max{0, 0};
+    ivec2 centre{0, 0};
+    // Values the cached cell bounds were computed from.
+    vec2 cached_centre{0};
+    fixed cached_bounding_width = 0;
+  };
+
+  const SimInterface* interface_ = nullptr;
+  detail::collision_grid grid_;
+  std::vector<cell_t> cells_;
+  std::vector<entry_t> entries_;
+  // Entry slot for each entity table slot (kNoEntry if none).
+  static constexpr std::uint32_t kNoEntry = ~std::uint32_t{0};
+  std::vector<std::uint32_t> entity_slot_entries_;
+};
+
 // Buggy, legacy collision system for use with legacy compatibility mode.
 class LegacyCollisionIndex : public CollisionIndex {
 public:
   ~LegacyCollisionIndex() override = default;
-  std::unique_ptr<CollisionIndex> clone() override {
-    return std::make_unique<LegacyCollisionIndex>(*this);
+  void copy_to(std::unique_ptr<CollisionIndex>& target) const override {
+    if (auto* index = dynamic_cast<LegacyCollisionIndex*>(target.get()); index) {
+      *index = *this;
+    } else {
+      target = std::make_unique<LegacyCollisionIndex>(*this);
+    }
   }
 
+  void write(BinaryWriter&) const override;
+  bool read(BinaryReader&, ecs::EntityIndex&) override;
   void refresh_handles(const SimInterface&, ecs::EntityIndex&) override;
+  void refresh_handles(ecs::EntityIndex&, std::span<const ecs::entity_id> ids) override;
   void add(ecs::handle& h, const Collision& c) override;
   void update(ecs::handle& h) override;
   void remove(ecs::handle& h) override;
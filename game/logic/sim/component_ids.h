@@ -0,0 +1,95 @@
+#ifndef II_GAME_LOGIC_SIM_COMPONENT_IDS_H
+#define II_GAME_LOGIC_SIM_COMPONENT_IDS_H
+#include "game/logic/ecs/id.h"
+#include <cstddef>
+
+namespace ii {
+
+// Registry of every sim component type. Each component declares its entry as its kComponentId, so
+// component IDs are dense and don't depend on build or initialization order. IDs may be persisted
+// (e.g. in state snapshots): add new entries at the end, and don't reorder or remove them.
+enum class sim_component : ecs::index_type {
+  // Common.
+  kDestroy,
+  kTransform,
+  kCollision,
+  kUpdate,
+  kPostUpdate,
+  kRender,
+  kPrivateRandom,
+  kWallTag,
+  kPowerupTag,
+  kBoss,
+  kEnemy,
+  kHealth,
+  kPlayer,
+
+  // V0.
+  kV0AiFocusTag,
+  kV0AiClickTag,
+  kV0GlobalData,
+  kV0DropTable,
+  kV0ColourOverride,
+  kV0Physics,
+  kV0EnemyStatus,
+  kV0AiPlayer,
+  kV0Overmind,
+  kV0PlayerLoadout,
+  kV0PlayerLogic,
+  kV0PlayerShot,
+  kV0ModUpgrade,
+  kV0PlayerBubble,
+  kV0ShieldPowerup,
+  kV0BombPowerup,
+  kV0Follow,
+  kV0Chaser,
+  kV0FollowSponge,
+  kV0FollowHub,
+  kV0Shielder,
+  kV0Tractor,
+  kV0ShieldHub,
+  kV0ShieldEffect,
+  kV0Square,
+  kV0Wall,
+  kV0SquareBoss,
+
+  // Legacy.
+  kLegacyPlayerScore,
+  kLegacyGlobalData,
+  kLegacyOvermind,
+  kLegacyShot,
+  kLegacyPlayerLogic,
+  kLegacyPowerup,
+  kLegacyBounce,
+  kLegacyFollow,
+  kLegacyChaser,
+  kLegacyFollowHub,
+  kLegacyShielder,
+  kLegacyTractor,
+  kLegacySnake,
+  kLegacySnakeTail,
+  kLegacySquare,
+  kLegacyWall,
+  kLegacyBossShot,
+  kLegacyBigSquareBoss,
+  kLegacyShieldBombBoss,
+  kLegacyChaserBossSharedState,
+  kLegacyChaserBoss,
+  kLegacyTractorBoss,
+  kLegacyGhostWall,
+  kLegacyGhostMine,
+  kLegacyGhostBoss,
+  kLegacyDeathRay,
+  kLegacyDeathArm,
+  kLegacyDeathRayBoss,
+  kLegacySuperBossArc,
+  kLegacySuperBoss,
+
+  kMax,
+};
+
+static_assert(static_cast<std::size_t>(sim_component::kMax) <= ecs::kMaxComponents);
+
+}  // namespace ii
+
+#endif
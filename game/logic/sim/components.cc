@@ -5,17 +5,21 @@
 
 namespace ii {
 
-void Render::render_all(ecs::const_handle h, transient_render_state::entity_state& state,
-                        bool paused, std::vector<render::shape>& shapes_out,
-                        std::vector<render::combo_panel>& panels_out, const SimInterface& sim) {
+void Render::update_trails(transient_render_state::entity_state& state) {
   // TODO: trails should be reset on entity creation? Unless was created on same tick count
   // and with same components as we expected?
-  static constexpr float kMaxTrailDistance = 64.f;
-  static constexpr float kMaxTrailAngle = pi<float> / 3.f;
   if (clear_trails) {
     state.trails.clear();
     clear_trails = false;
   }
+}
+
+void Render::render_all(ecs::const_handle h, transient_render_state::entity_state& state,
+                        bool paused, std::vector<render::shape>& shapes_out,
+                        std::vector<render::combo_panel>& panels_out,
+                        const SimInterface& sim) const {
+  static constexpr float kMaxTrailDistance = 64.f;
+  static constexpr float kMaxTrailAngle = pi<float> / 3.f;
 
   std::unordered_map<render::tag_t, std::size_t> index_counts;
   auto handle = [&](render::shape& s) {
@@ -100,6 +104,8 @@ void Health::damage(ecs::handle h, SimInterface& sim, std::uint32_t damage, dama
 
   if (type != damage_type::kPredicted) {
     hp = hp < damage ? 0 : hp - damage;
+  } else {
+    sim.mark_predicted_effect();
   }
   auto e = sim.emit(resolve_key::reconcile(h.id(), resolve_tag::kOnHit, hp));
   if (on_hit) {
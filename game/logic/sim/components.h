@@ -6,6 +6,7 @@
 #include "game/common/ustring.h"
 #include "game/geometry/types.h"
 #include "game/logic/ecs/index.h"
+#include "game/logic/sim/component_ids.h"
 #include "game/logic/sim/io/output.h"
 #include "game/mixer/sound.h"
 #include "game/render/data/background.h"
@@ -37,12 +38,14 @@ enum class rumble_type {
 };
 
 struct Destroy : ecs::component {
+  static constexpr auto kComponentId = sim_component::kDestroy;
   std::optional<ecs::entity_id> source;
   std::optional<damage_type> destroy_type;
 };
-DEBUG_STRUCT_TUPLE(Destroy);
+DEBUG_STRUCT_TUPLE(Destroy, source, destroy_type);
 
 struct Transform : ecs::component {
+  static constexpr auto kComponentId = sim_component::kTransform;
   vec2 centre = {0, 0};
   fixed rotation = 0;
 
@@ -53,29 +56,34 @@ struct Transform : ecs::component {
 DEBUG_STRUCT_TUPLE(Transform, centre, rotation);
 
 struct Collision : ecs::component {
+  static constexpr auto kComponentId = sim_component::kCollision;
   shape_flag flags = shape_flag::kNone;
   fixed bounding_width = 0;
 
-  using check_collision_t = geom::hit_result(ecs::const_handle, const geom::check_t&,
-                                             const SimInterface&);
+  // Adds the flags of any shapes hit, and their centres, to the result.
+  using check_collision_t = void(ecs::const_handle, const geom::check_t&, const SimInterface&,
+                                 geom::hit_result&);
   sfn::ptr<check_collision_t> check_collision = nullptr;
 };
 DEBUG_STRUCT_TUPLE(Collision, flags, bounding_width, check_collision);
 
 struct Update : ecs::component {
+  static constexpr auto kComponentId = sim_component::kUpdate;
   bool skip_update = false;
   using update_t = void(ecs::handle, SimInterface&);
   sfn::ptr<update_t> update = nullptr;
 };
-DEBUG_STRUCT_TUPLE(Update, update);
+DEBUG_STRUCT_TUPLE(Update, skip_update, update);
 
 struct PostUpdate : ecs::component {
+  static constexpr auto kComponentId = sim_component::kPostUpdate;
   using update_t = void(ecs::handle, SimInterface&);
   sfn::ptr<update_t> post_update = nullptr;
 };
 DEBUG_STRUCT_TUPLE(PostUpdate, post_update);
 
 struct Render : ecs::component {
+  static constexpr auto kComponentId = sim_component::kRender;
   using render_t = void(ecs::const_handle, std::vector<render::shape>&, const SimInterface&);
   using render_panel_t = void(ecs::const_handle, std::vector<render::combo_panel>&,
                               const SimInterface&);
@@ -83,13 +91,17 @@ struct Render : ecs::component {
   sfn::ptr<render_panel_t> render_panel = nullptr;
   bool clear_trails = false;
 
+  // Clears motion trails from the transient state if requested. Called before render_all().
+  void update_trails(transient_render_state::entity_state& state);
   void render_all(ecs::const_handle, transient_render_state::entity_state& state, bool paused,
                   std::vector<render::shape>&, std::vector<render::combo_panel>&,
-                  const SimInterface&);
+                  const SimInterface&) const;
 };
-DEBUG_STRUCT_TUPLE(Render, render);
+DEBUG_STRUCT_TUPLE(Render, render, render_panel, clear_trails);
 
 struct PrivateRandom : ecs::component {
+  static constexpr auto kComponentId = sim_component::kPrivateRandom;
+  PrivateRandom() = default;
   PrivateRandom(std::uint32_t seed) : engine{seed} {}
   PrivateRandom(const PrivateRandom& r) : engine{r.engine.state()} {}
   PrivateRandom& operator=(const PrivateRandom& r) {
@@ -98,28 +110,33 @@ struct PrivateRandom : ecs::component {
     }
     return *this;
   }
-  RandomEngine engine;
+  RandomEngine engine{0};
 };
-DEBUG_STRUCT_TUPLE(PrivateRandom, engine.state());
+DEBUG_STRUCT_TUPLE(PrivateRandom, engine);
 
-struct WallTag : ecs::component {};
+struct WallTag : ecs::component {
+  static constexpr auto kComponentId = sim_component::kWallTag;
+};
 DEBUG_STRUCT_TUPLE(WallTag);
 
 struct PowerupTag : ecs::component {
+  static constexpr auto kComponentId = sim_component::kPowerupTag;
   using ai_requires_t = bool(ecs::const_handle, const SimInterface&, ecs::const_handle);
   sfn::ptr<ai_requires_t> ai_requires = nullptr;
 };
-DEBUG_STRUCT_TUPLE(PowerupTag);
+DEBUG_STRUCT_TUPLE(PowerupTag, ai_requires);
 
 struct Boss : ecs::component {
+  static constexpr auto kComponentId = sim_component::kBoss;
   boss_flag boss = boss_flag{0};
   ustring name;
   cvec4 colour = colour::kWhite0;
   bool show_hp_bar = false;
 };
-DEBUG_STRUCT_TUPLE(Boss, boss, show_hp_bar);
+DEBUG_STRUCT_TUPLE(Boss, boss, name, colour, show_hp_bar);
 
 struct Enemy : ecs::component {
+  static constexpr auto kComponentId = sim_component::kEnemy;
   std::uint32_t threat_value = 1;
   std::uint32_t score_reward = 0;
   std::uint32_t boss_score_reward = 0;
@@ -127,6 +144,7 @@ struct Enemy : ecs::component {
 DEBUG_STRUCT_TUPLE(Enemy, threat_value, score_reward, boss_score_reward);
 
 struct Health : ecs::component {
+  static constexpr auto kComponentId = sim_component::kHealth;
   std::uint32_t hp = 0;
   std::uint32_t max_hp = hp;
   std::uint32_t hit_timer = 0;
@@ -161,9 +179,12 @@ struct Health : ecs::component {
   void damage(ecs::handle h, SimInterface&, std::uint32_t damage, damage_type type,
               ecs::entity_id source_id, std::optional<vec2> source_position = std::nullopt);
 };
-DEBUG_STRUCT_TUPLE(Health, hp, max_hp, damage_transform, on_hit, on_destroy);
+DEBUG_STRUCT_TUPLE(Health::hit_t, source, tick);
+DEBUG_STRUCT_TUPLE(Health, hp, max_hp, hit_timer, hit_sound0, hit_sound1, destroy_sound,
+                   destroy_rumble, hits, damage_transform, on_hit, on_destroy);
 
 struct Player : ecs::component {
+  static constexpr auto kComponentId = sim_component::kPlayer;
   std::uint32_t player_number = 0;
   std::uint32_t death_count = 0;
   bool is_killed = false;
@@ -180,8 +201,8 @@ struct Player : ecs::component {
   using render_info_t = std::optional<player_info>(ecs::const_handle, const SimInterface&);
   sfn::ptr<render_info_t> render_info = nullptr;
 };
-DEBUG_STRUCT_TUPLE(Player, player_number, death_count, is_killed, super_charge, bomb_count,
-                   shield_count, is_predicted, speed);
+DEBUG_STRUCT_TUPLE(Player, player_number, death_count, is_killed, is_clicking, mod_upgrade_chosen,
+                   super_charge, bomb_count, shield_count, is_predicted, speed, render_info);
 
 void add(ecs::handle, const Destroy&);
 void add(ecs::handle, const Transform&);
@@ -8,10 +8,11 @@
 #include "game/render/data/panel.h"
 #include "game/render/data/shapes.h"
 #include <bit>
+#include <cstddef>
 #include <cstdint>
-#include <deque>
 #include <optional>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace ii {
@@ -30,25 +31,129 @@ struct rumble_out {
   float hf = 0.f;
 };
 
-struct aggregate_event {
-  std::uint32_t delay_ticks = 0u;
-  std::optional<render::background::update> background;
-  std::vector<particle> particles;
-  std::vector<sound_out> sounds;
-  std::vector<rumble_out> rumble;
-};
-
+// Effects emitted by the simulation. Particles, sounds and rumble of all entries are stored in flat
+// streams, each element tagged with the index of the entry it belongs to. Storage is only cleared,
+// never released, and whole outputs are moved by swapping storage where possible; so once capacity
+// has grown to fit the busiest ticks, emitting, merging and consuming output doesn't allocate.
 struct aggregate_output {
-  void clear() { entries.clear(); }
-  void append_to(aggregate_output& output) const {
-    output.entries.insert(output.entries.end(), entries.begin(), entries.end());
-  }
-
   struct entry {
     resolve_key key;
-    aggregate_event e;
+    std::uint32_t delay_ticks = 0u;
+    std::optional<render::background::update> background;
   };
-  std::deque<entry> entries;
+
+  template <typename T>
+  struct element {
+    std::uint32_t entry = 0u;
+    T value;
+  };
+
+  std::vector<entry> entries;
+  std::vector<element<particle>> particles;
+  std::vector<element<sound_out>> sounds;
+  std::vector<element<rumble_out>> rumble;
+
+  bool empty() const { return entries.empty(); }
+
+  void clear() {
+    entries.clear();
+    particles.clear();
+    sounds.clear();
+    rumble.clear();
+  }
+
+  // Appends all entries to target and clears this output. If target is empty, just swaps storage.
+  void move_to(aggregate_output& target) {
+    if (!target.empty()) {
+      move_to(target, [](std::uint32_t) { return true; });
+      return;
+    }
+    std::swap(entries, target.entries);
+    std::swap(particles, target.particles);
+    std::swap(sounds, target.sounds);
+    std::swap(rumble, target.rumble);
+    clear();
+  }
+
+  // Appends entries for which keep(i) returns true (along with their stream elements) to target,
+  // preserving order, and clears this output. keep is called once for each entry index, in order,
+  // before anything is moved.
+  void move_to(aggregate_output& target, auto&& keep) {
+    auto base = static_cast<std::uint32_t>(target.entries.size());
+    if (!remap(keep, base)) {
+      clear();
+      return;
+    }
+    for (std::uint32_t i = 0; i < entries.size(); ++i) {
+      if (remap_[i] != kRemoved) {
+        target.entries.emplace_back(std::move(entries[i]));
+      }
+    }
+    auto move_stream = [&](auto& source, auto& dest) {
+      for (auto& x : source) {
+        if (auto i = remap_[x.entry]; i != kRemoved) {
+          dest.push_back({i, std::move(x.value)});
+        }
+      }
+    };
+    move_stream(particles, target.particles);
+    move_stream(sounds, target.sounds);
+    move_stream(rumble, target.rumble);
+    clear();
+  }
+
+  // Removes entries for which keep(i) returns false, along with their stream elements, preserving
+  // order. keep is called once for each entry index, in order, before anything is removed.
+  void retain(auto&& keep) {
+    if (!remap(keep, 0u)) {
+      clear();
+      return;
+    }
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+      if (remap_[i] == kRemoved) {
+        continue;
+      }
+      if (n != i) {
+        entries[n] = std::move(entries[i]);
+      }
+      ++n;
+    }
+    entries.erase(entries.begin() + static_cast<std::ptrdiff_t>(n), entries.end());
+    auto compact_stream = [&](auto& stream) {
+      std::size_t k = 0;
+      for (std::size_t j = 0; j < stream.size(); ++j) {
+        if (auto i = remap_[stream[j].entry]; i != kRemoved) {
+          stream[j].entry = i;
+          if (k != j) {
+            stream[k] = std::move(stream[j]);
+          }
+          ++k;
+        }
+      }
+      stream.erase(stream.begin() + static_cast<std::ptrdiff_t>(k), stream.end());
+    };
+    compact_stream(particles);
+    compact_stream(sounds);
+    compact_stream(rumble);
+  }
+
+private:
+  static constexpr std::uint32_t kRemoved = ~0u;
+
+  // Maps each entry index to its new index (starting from base), or kRemoved. Returns whether any
+  // entry is kept.
+  bool remap(auto& keep, std::uint32_t base) {
+    remap_.clear();
+    auto n = base;
+    for (std::uint32_t i = 0; i < entries.size(); ++i) {
+      remap_.push_back(keep(i) ? n++ : kRemoved);
+    }
+    return n != base;
+  }
+
+  // Scratch space for move_to() and retain().
+  std::vector<std::uint32_t> remap_;
 };
 
 struct player_info {
@@ -27,6 +27,8 @@ struct input_frame {
   std::optional<vec2> target_absolute;
   std::optional<vec2> target_relative;
   std::uint32_t keys = 0;
+
+  bool operator==(const input_frame&) const = default;
 };
 
 struct input_source_mapping {
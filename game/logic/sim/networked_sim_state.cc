@@ -1,7 +1,14 @@
 #include "game/logic/sim/networked_sim_state.h"
+#include "game/common/job_pool.h"
+#include "game/data/replay.h"
 #include "game/logic/sim/io/conditions.h"
+#include <blockingconcurrentqueue.h>
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <iterator>
+#include <mutex>
+#include <thread>
 
 namespace ii {
 namespace {
@@ -50,20 +57,138 @@ filter_ai_players(const network_input_mapping& mapping, std::span<std::uint32_t>
   }
   return result;
 }
+// Alternative guesses at remote input simulated by speculative prediction branches, each derived
+// from the latest input actually received.
+enum class input_hypothesis {
+  kHold,
+  kToggleFire,
+  kBomb,
+  kRelease,
+};
+
+constexpr std::array kInputHypotheses = {input_hypothesis::kHold, input_hypothesis::kToggleFire,
+                                         input_hypothesis::kBomb, input_hypothesis::kRelease};
+
+input_frame hypothesise(input_hypothesis h, const input_frame& latest) {
+  auto frame = latest;
+  switch (h) {
+  case input_hypothesis::kHold:
+    break;
+  case input_hypothesis::kToggleFire:
+    frame.keys ^= input_frame::kFire;
+    break;
+  case input_hypothesis::kBomb:
+    frame.keys |= input_frame::kBomb;
+    break;
+  case input_hypothesis::kRelease:
+    frame.velocity = vec2{0};
+    frame.keys = input_frame::kNone;
+    break;
+  }
+  return frame;
+}
 }  // namespace
 
+// Owns the canonical state while enabled, advancing it on its own thread by each input frame taken
+// from a lock-free queue. Once the queue is drained (or enough ticks have built up), the state is
+// copied to the published state, along with the output and checksum of each tick simulated since.
+struct NetworkedSimState::canonical_worker {
+  static constexpr std::size_t kMaxUnpublishedTicks = 8;
+
+  struct canonical_tick {
+    std::uint64_t tick_count = 0;
+    std::uint32_t checksum = 0;
+    SimState::checksum_tier tier = SimState::checksum_tier::kFast;
+    aggregate_output output;
+    std::vector<input_frame> replay_input;
+  };
+
+  canonical_worker(SimState&& s, SimState::checksum_tier tier, std::uint32_t player_count)
+  : state{std::move(s)}, tier{tier}, player_count{player_count} {
+    state.copy_to(published);
+    published_tick = state.tick_count();
+  }
+
+  ~canonical_worker() {
+    if (thread.joinable()) {
+      stop = true;
+      queue.enqueue(std::vector<input_frame>{});
+      thread.join();
+    }
+  }
+
+  void start() {
+    if (!thread.joinable()) {
+      thread = std::thread{[this] { run(); }};
+    }
+  }
+
+  void run() {
+    std::vector<canonical_tick> pending;
+    std::vector<input_frame> input;
+    while (true) {
+      queue.wait_dequeue(input);
+      if (stop) {
+        return;
+      }
+      // Frames may be queued before game over is adopted; the replay must still end there.
+      if (state.game_over()) {
+        continue;
+      }
+      // Updates are skipped once game over, so every tick's input goes in the replay.
+      auto& t = pending.emplace_back();
+      t.replay_input = input;
+      t.replay_input.resize(player_count);
+      state.update(std::move(input));
+      t.tick_count = state.tick_count();
+      t.checksum = state.checksum(tier);
+      t.tier = tier;
+      state.output().move_to(t.output);
+      if (queue.size_approx() && pending.size() < kMaxUnpublishedTicks) {
+        continue;
+      }
+      {
+        std::lock_guard lock{mutex};
+        state.copy_to(published, /* delta */ true);
+        std::move(pending.begin(), pending.end(), std::back_inserter(published_ticks));
+      }
+      published_tick.store(state.tick_count(), std::memory_order_release);
+      pending.clear();
+    }
+  }
+
+  // Only accessed by the worker thread once started.
+  SimState state;
+  SimState::checksum_tier tier;
+  std::uint32_t player_count = 0;
+  std::thread thread;
+  std::atomic<bool> stop{false};
+  moodycamel::BlockingConcurrentQueue<std::vector<input_frame>> queue;
+
+  std::mutex mutex;
+  SimState published;                          // Guarded by mutex.
+  std::vector<canonical_tick> published_ticks;  // Guarded by mutex.
+  std::atomic<std::uint64_t> published_tick{0};
+};
+
+NetworkedSimState::~NetworkedSimState() = default;
+NetworkedSimState::NetworkedSimState(NetworkedSimState&&) noexcept = default;
+NetworkedSimState& NetworkedSimState::operator=(NetworkedSimState&&) noexcept = default;
+
 NetworkedSimState::NetworkedSimState(const initial_conditions& conditions,
                                      network_input_mapping mapping, data::ReplayWriter* writer,
                                      std::span<std::uint32_t> ai_players)
 : local_ai_players_{filter_ai_players(mapping, ai_players)}
 , canonical_state_{conditions, writer, local_ai_players_}
 , mapping_{std::move(mapping)}
+, remote_players_{remote_players(mapping_)}
 , player_count_{conditions.player_count} {
   (void)&check_mapping;
   assert(check_mapping(conditions, mapping_));
   canonical_state_.copy_to(predicted_state_);
   latest_input_.resize(player_count_);
-  local_checksums_.emplace_back(0u, canonical_state_.checksum());
+  received_input_.resize(player_count_);
+  record_canonical_checksum();
   for (const auto& pair : mapping_.remote) {
     for (auto n : pair.second.player_numbers) {
       smoothing_data_.players[n];
@@ -83,6 +208,51 @@ void NetworkedSimState::set_input_delay_ticks(std::uint64_t delay_ticks) {
   input_delay_ticks_ = delay_ticks;
 }
 
+void NetworkedSimState::set_checksum_tier(SimState::checksum_tier tier) {
+  assert(!canonical_worker_ || !canonical_worker_->thread.joinable());
+  checksum_tier_ = tier;
+  if (canonical_worker_) {
+    canonical_worker_->tier = tier;
+  }
+}
+
+void NetworkedSimState::set_job_pool(JobPool* pool) {
+  assert(!canonical_worker_ || !canonical_worker_->thread.joinable());
+  job_pool_ = pool;
+  canonical_state_.set_job_pool(pool);
+  predicted_state_.set_job_pool(pool);
+  for (auto& b : prediction_branches_) {
+    b.state.set_job_pool(pool);
+  }
+  if (canonical_worker_) {
+    canonical_worker_->state.set_job_pool(pool);
+  }
+}
+
+void NetworkedSimState::set_speculative_prediction(bool enabled) {
+  speculative_prediction_ = enabled;
+  if (!enabled) {
+    for (auto& b : prediction_branches_) {
+      b.active = false;
+    }
+  }
+}
+
+void NetworkedSimState::enable_canonical_worker() {
+  assert(!predicted_state_.tick_count());
+  if (canonical_worker_) {
+    return;
+  }
+  // The worker takes over the real canonical state; what's left here is a copy, refreshed whenever
+  // the worker publishes. The replay writer stays on this thread.
+  replay_writer_ = canonical_state_.replay_writer();
+  canonical_state_.set_replay_writer(nullptr);
+  canonical_worker_ = std::make_unique<canonical_worker>(std::move(canonical_state_),
+                                                         checksum_tier_, player_count_);
+  canonical_state_ = SimState{};
+  canonical_worker_->published.copy_to(canonical_state_);
+}
+
 void NetworkedSimState::input_packet(const std::string& remote_id, const data::sim_packet& packet) {
   auto it = mapping_.remote.find(remote_id);
   if (it == mapping_.remote.end()) {
@@ -106,7 +276,8 @@ void NetworkedSimState::input_packet(const std::string& remote_id, const data::s
   remote.latest_tick = 1 + packet.tick_count;
   remote.canonical_tick = packet.canonical_tick_count;
   if (remote.checksums.empty() || remote.checksums.back().tick_count < remote.canonical_tick) {
-    remote.checksums.emplace_back(remote.canonical_tick, packet.canonical_checksum);
+    auto tier = static_cast<SimState::checksum_tier>(packet.canonical_checksum_tier);
+    remote.checksums.emplace_back(remote.canonical_tick, packet.canonical_checksum, tier);
   }
 
   if (tick_offset == partial_frames_.size()) {
@@ -121,24 +292,18 @@ void NetworkedSimState::input_packet(const std::string& remote_id, const data::s
       return;  // Duplicate packet?
     }
     partial.input_frames[player_number] = latest_input_[player_number] =
-        i < packet.input_frames.size() ? packet.input_frames[i] : input_frame{};
+        received_input_[player_number] =
+            i < packet.input_frames.size() ? packet.input_frames[i] : input_frame{};
   }
 
   bool frame_complete = std::all_of(partial.input_frames.begin(), partial.input_frames.end(),
                                     [&](const auto& f) { return f.has_value(); });
-  if (tick_offset || !frame_complete || canonical_state_.game_over()) {
+  if (tick_offset != canonical_in_flight_ || !frame_complete || canonical_state_.game_over()) {
     return;
   }
 
   // Canonical state can be advanced.
-  std::vector<input_frame> v;
-  for (const auto& f : partial.input_frames) {
-    v.emplace_back(*f);
-  }
-  canonical_state_.update(std::move(v));
-  handle_canonical_output(canonical_state_.tick_count(), canonical_state_.output());
-  local_checksums_.emplace_back(canonical_state_.tick_count(), canonical_state_.checksum());
-  partial_frames_.pop_front();
+  advance_canonical(partial);
 }
 
 std::vector<data::sim_packet> NetworkedSimState::update(std::vector<input_frame> local_input) {
@@ -161,24 +326,74 @@ std::vector<data::sim_packet> NetworkedSimState::update(std::vector<input_frame>
     latest_input_[k].velocity *= kInputPredictionSmoothingFactor;
     return latest_input_[k];
   };
-  auto predicted_players = remote_players(mapping_);
+  const auto& predicted_players = remote_players_;
 
+  adopt_canonical();
+  rollback_depth_ = rollback_ticks_ = 0;
   if (predicted_tick_base_ < canonical_state_.tick_count()) {
-    // Canonical state has advanced since last prediction; rewind and replay.
-    auto replay_ticks = predicted_state_.tick_count() >= canonical_state_.tick_count()
-        ? predicted_state_.tick_count() - canonical_state_.tick_count()
-        : 0u;
-    canonical_state_.copy_to(predicted_state_);
-    predicted_tick_base_ = canonical_state_.tick_count();
-    for (std::uint64_t i = 0; i < replay_ticks; ++i) {
-      std::vector<input_frame> predicted_inputs;
-      for (std::uint32_t k = 0; k < player_count_; ++k) {
-        predicted_inputs.emplace_back(frame_for(i, k));
+    // Canonical state has advanced since last prediction; rewind to the latest point at which the
+    // prediction is still valid (restoring from a snapshot if possible) and replay.
+    auto canonical_tick = canonical_state_.tick_count();
+    auto predicted_tick = predicted_state_.tick_count();
+    auto valid_tick = valid_prediction_tick(prediction_history_, prediction_diverged_);
+    auto* branch = resolve_prediction_branches();
+    rollback_depth_ = predicted_tick >= canonical_tick ? predicted_tick - canonical_tick : 0u;
+
+    if ((!valid_tick || *valid_tick != predicted_tick) && branch) {
+      // A speculative branch guessed the newly-known input correctly, and is now the prediction.
+      branch->state.copy_to(predicted_state_, /* delta */ true);
+      prediction_history_.swap(branch->history);
+      for (auto& s : prediction_snapshots_) {
+        if (s.tick_count && *s.tick_count >= branch->split_tick) {
+          s.tick_count.reset();
+        }
+      }
+      for (auto& t : branch->output) {
+        handle_replay_output(t.tick_count, t.output);
+      }
+      for (auto& b : prediction_branches_) {
+        b.active = false;
+      }
+      ++hypotheses_adopted_;
+    } else if (!valid_tick || *valid_tick != predicted_tick) {
+      const prediction_snapshot* snapshot = nullptr;
+      for (auto tick = valid_tick.value_or(canonical_tick); valid_tick && tick > canonical_tick;
+           --tick) {
+        const auto& s = prediction_snapshots_[tick % kPredictionSnapshotCount];
+        if (s.tick_count == tick) {
+          snapshot = &s;
+          break;
+        }
+      }
+      if (snapshot) {
+        snapshot->state.copy_to(predicted_state_, /* delta */ true);
+      } else {
+        canonical_state_.copy_to(predicted_state_, /* delta */ true);
+        reset_prediction();
+      }
+      auto restore_tick = predicted_state_.tick_count();
+      std::erase_if(prediction_history_,
+                    [&](const prediction_tick& p) { return p.tick_count > restore_tick; });
+      for (auto& s : prediction_snapshots_) {
+        if (s.tick_count && *s.tick_count > restore_tick) {
+          s.tick_count.reset();
+        }
+      }
+
+      for (auto tick = restore_tick; tick < predicted_tick; ++tick) {
+        std::vector<input_frame> predicted_inputs;
+        for (std::uint32_t k = 0; k < player_count_; ++k) {
+          predicted_inputs.emplace_back(frame_for(tick - canonical_tick, k));
+        }
+        predicted_state_.set_predicted_players(predicted_players);
+        predicted_state_.update(predicted_inputs);
+        record_prediction(std::move(predicted_inputs));
+        handle_replay_output(predicted_state_.tick_count(), predicted_state_.output());
+        ++rollback_ticks_;
       }
-      predicted_state_.set_predicted_players(predicted_players);
-      predicted_state_.update(std::move(predicted_inputs));
-      handle_replay_output(predicted_state_.tick_count(), predicted_state_.output());
     }
+    predicted_tick_base_ = canonical_tick;
+    prediction_diverged_ = false;
   }
 
   // Now predicted_state >= canonical_state; advance one tick.
@@ -202,24 +417,74 @@ std::vector<data::sim_packet> NetworkedSimState::update(std::vector<input_frame>
   for (std::uint32_t k = 0; k < player_count_; ++k) {
     inputs.emplace_back(frame_for(tick_offset, k));
   }
-  if (!tick_offset && frame_complete) {
+  if (!canonical_worker_ && !tick_offset && frame_complete) {
     // Can just advance canonical state.
     canonical_state_.update(std::move(inputs));
     handle_dual_output(canonical_state_.output());
 
-    local_checksums_.emplace_back(canonical_state_.tick_count(), canonical_state_.checksum());
+    record_canonical_checksum();
     partial_frames_.pop_front();
-    canonical_state_.copy_to(predicted_state_);
+    canonical_state_.copy_to(predicted_state_, /* delta */ true);
+    reset_prediction();
     ++predicted_tick_base_;
   } else {
-    predicted_state_.set_predicted_players(predicted_players);
-    predicted_state_.update(std::move(inputs));
+    if (canonical_worker_ && tick_offset == canonical_in_flight_ && frame_complete &&
+        !canonical_state_.game_over()) {
+      advance_canonical(partial);
+    }
+    if (speculative_prediction_ && !frame_complete &&
+        std::none_of(prediction_branches_.begin(), prediction_branches_.end(),
+                     [](const prediction_branch& b) { return b.active; })) {
+      spawn_prediction_branches(partial, inputs);
+    }
+    bool speculating = false;
+    for (auto& b : prediction_branches_) {
+      if (b.active) {
+        speculating = true;
+        b.input = inputs;
+        for (std::uint32_t k = 0; k < player_count_; ++k) {
+          if (!partial.input_frames[k]) {
+            b.input[k] = b.hypothesis[k];
+          }
+        }
+      }
+    }
+    // Branches are simulated alongside the prediction itself.
+    auto predict = [&](std::size_t i) {
+      auto* b = i ? &prediction_branches_[i - 1] : nullptr;
+      if (b && !b->active) {
+        return;
+      }
+      auto& state = b ? b->state : predicted_state_;
+      state.set_predicted_players(predicted_players);
+      state.update(b ? b->input : inputs);
+    };
+    if (speculating && job_pool_) {
+      job_pool_->parallel_for(1 + prediction_branches_.size(), predict);
+    } else {
+      for (std::size_t i = 0; i < (speculating ? 1 + prediction_branches_.size() : 1); ++i) {
+        predict(i);
+      }
+    }
+    for (auto& b : prediction_branches_) {
+      if (b.active) {
+        b.history.emplace_back(prediction_tick{b.state.tick_count(), b.state.checksum(),
+                                               b.state.has_predicted_effects(),
+                                               std::move(b.input)});
+        auto& t = b.output.emplace_back();
+        t.tick_count = b.state.tick_count();
+        b.state.output().move_to(t.output);
+      }
+    }
+    record_prediction(std::move(inputs));
     handle_predicted_output(predicted_state_.tick_count(), predicted_state_.output());
   }
   predicted_state_.update_smoothing(smoothing_data_);
   if (!packet_output.empty()) {
     packet_output.front().canonical_tick_count = local_checksums_.back().tick_count;
     packet_output.front().canonical_checksum = local_checksums_.back().checksum;
+    packet_output.front().canonical_checksum_tier =
+        static_cast<std::uint32_t>(local_checksums_.back().tier);
   }
 
   // Verify and discard checksums.
@@ -236,7 +501,8 @@ std::vector<data::sim_packet> NetworkedSimState::update(std::vector<input_frame>
         continue;
       }
       auto& r = remote_checksums.front();
-      if (r.tick_count == c.tick_count && r.checksum && r.checksum != c.checksum) {
+      if (r.tick_count == c.tick_count && r.checksum && r.tier == c.tier &&
+          r.checksum != c.checksum) {
         checksum_failed_remote_ids_.emplace(pair.first);
       }
     }
@@ -254,36 +520,193 @@ auto NetworkedSimState::remote(const std::string& remote_id) const -> remote_sta
     stats.latest_tick = it->second.latest_tick;
     stats.canonical_tick = it->second.canonical_tick;
   }
+  stats.rollback_depth = rollback_depth_;
+  stats.rollback_ticks = rollback_ticks_;
+  stats.hypotheses_adopted = hypotheses_adopted_;
   return stats;
 }
 
+void NetworkedSimState::advance_canonical(const partial_frame& partial) {
+  std::vector<input_frame> v;
+  for (const auto& f : partial.input_frames) {
+    v.emplace_back(*f);
+  }
+  auto tick_count = canonical_state_.tick_count() + canonical_in_flight_ + 1;
+  auto check_history = [&](std::deque<prediction_tick>& history, bool& diverged) {
+    while (!history.empty() && history.front().tick_count <= canonical_state_.tick_count()) {
+      history.pop_front();
+    }
+    auto it = std::find_if(history.begin(), history.end(),
+                           [&](const prediction_tick& p) { return p.tick_count == tick_count; });
+    if (it != history.end() && it->input != v) {
+      diverged = true;
+    }
+  };
+  check_history(prediction_history_, prediction_diverged_);
+  for (auto& b : prediction_branches_) {
+    if (b.active) {
+      check_history(b.history, b.diverged);
+    }
+  }
+
+  if (canonical_worker_) {
+    // Input stays in partial_frames_ until the resulting state is adopted.
+    canonical_worker_->start();
+    canonical_worker_->queue.enqueue(std::move(v));
+    ++canonical_in_flight_;
+    return;
+  }
+  canonical_state_.update(std::move(v));
+  handle_canonical_output(canonical_state_.tick_count(), canonical_state_.output());
+  record_canonical_checksum();
+  partial_frames_.pop_front();
+}
+
+void NetworkedSimState::adopt_canonical() {
+  if (!canonical_worker_ ||
+      canonical_worker_->published_tick.load(std::memory_order_acquire) ==
+          canonical_state_.tick_count()) {
+    return;
+  }
+  std::vector<canonical_worker::canonical_tick> ticks;
+  {
+    std::lock_guard lock{canonical_worker_->mutex};
+    canonical_worker_->published.copy_to(canonical_state_, /* delta */ true);
+    ticks.swap(canonical_worker_->published_ticks);
+  }
+  for (auto& t : ticks) {
+    handle_canonical_output(t.tick_count, t.output);
+    local_checksums_.emplace_back(t.tick_count, t.checksum, t.tier);
+    if (replay_writer_) {
+      for (const auto& f : t.replay_input) {
+        replay_writer_->add_input_frame(f);
+      }
+    }
+    partial_frames_.pop_front();
+    --canonical_in_flight_;
+  }
+}
+
+void NetworkedSimState::record_canonical_checksum() {
+  local_checksums_.emplace_back(canonical_state_.tick_count(),
+                                canonical_state_.checksum(checksum_tier_), checksum_tier_);
+}
+
+void NetworkedSimState::reset_prediction() {
+  prediction_base_tick_ = canonical_state_.tick_count();
+  prediction_diverged_ = false;
+  prediction_history_.clear();
+  for (auto& s : prediction_snapshots_) {
+    s.tick_count.reset();
+  }
+  for (auto& b : prediction_branches_) {
+    b.active = false;
+  }
+}
+
+void NetworkedSimState::record_prediction(std::vector<input_frame> input) {
+  auto tick_count = predicted_state_.tick_count();
+  prediction_history_.emplace_back(prediction_tick{tick_count, predicted_state_.checksum(),
+                                                   predicted_state_.has_predicted_effects(),
+                                                   std::move(input)});
+  auto& snapshot = prediction_snapshots_[tick_count % kPredictionSnapshotCount];
+  predicted_state_.copy_to(snapshot.state, /* delta */ true);
+  snapshot.tick_count = tick_count;
+}
+
+void NetworkedSimState::spawn_prediction_branches(const partial_frame& partial,
+                                                  const std::vector<input_frame>& inputs) {
+  static_assert(kInputHypotheses.size() == kPredictionBranchCount);
+  for (std::size_t i = 0; i < kPredictionBranchCount; ++i) {
+    auto& b = prediction_branches_[i];
+    b.hypothesis.resize(player_count_);
+    bool distinct = false;
+    for (std::uint32_t k = 0; k < player_count_; ++k) {
+      b.hypothesis[k] = hypothesise(kInputHypotheses[i], received_input_[k]);
+      distinct = distinct || (!partial.input_frames[k] && b.hypothesis[k] != inputs[k]);
+    }
+    // No point simulating the same guess as the prediction itself.
+    if (!distinct) {
+      continue;
+    }
+    b.active = true;
+    b.split_tick = predicted_state_.tick_count() + 1;
+    b.diverged = prediction_diverged_;
+    b.history = prediction_history_;
+    b.output.clear();
+    predicted_state_.copy_to(b.state, /* delta */ true);
+  }
+}
+
+auto NetworkedSimState::resolve_prediction_branches() -> prediction_branch* {
+  prediction_branch* result = nullptr;
+  for (auto& b : prediction_branches_) {
+    if (!b.active) {
+      continue;
+    }
+    if (auto tick = valid_prediction_tick(b.history, b.diverged);
+        tick && *tick == b.state.tick_count()) {
+      result = result ? result : &b;
+    } else {
+      b.active = false;
+    }
+  }
+  return result;
+}
+
+std::optional<std::uint64_t>
+NetworkedSimState::valid_prediction_tick(const std::deque<prediction_tick>& history,
+                                         bool diverged) const {
+  // The prediction can only be kept if it reached the same state as the canonical state at the
+  // canonical tick, using the same input. The checksum only covers positions, so that's only the
+  // case if predicted players haven't done anything canonical simulation would do differently
+  // (e.g. predicted damage) since the prediction was last rebased onto canonical state. As a
+  // safeguard, it's also rebased at least every kMaxReconcileTickDifference ticks.
+  auto canonical_tick = canonical_state_.tick_count();
+  if (diverged || canonical_tick > prediction_base_tick_ + kMaxReconcileTickDifference) {
+    return std::nullopt;
+  }
+  auto it = std::find_if(history.begin(), history.end(),
+                         [&](const prediction_tick& p) { return p.tick_count == canonical_tick; });
+  if (it == history.end() || it->predicted_effects ||
+      it->checksum != canonical_state_.checksum()) {
+    return std::nullopt;
+  }
+  // After that, it remains valid until the first tick with newly-known input that differs.
+  auto tick = canonical_tick;
+  for (++it; it != history.end(); ++it) {
+    const auto& partial = partial_frames_[it->tick_count - 1 - canonical_tick];
+    for (std::uint32_t k = 0; k < player_count_; ++k) {
+      if (partial.input_frames[k] && *partial.input_frames[k] != it->input[k]) {
+        return tick;
+      }
+    }
+    tick = it->tick_count;
+  }
+  return tick;
+}
+
 void NetworkedSimState::handle_predicted_output(std::uint64_t tick_count,
                                                 aggregate_output& output) {
-  auto remote = remote_players(mapping_);
-  for (auto& e : output.entries) {
-    bool resolve = false;
-    switch (e.key.type) {
+  output.move_to(merged_output_, [&](std::uint32_t i) {
+    const auto& key = output.entries[i].key;
+    switch (key.type) {
     case resolve::kPredicted:
-      resolve = true;
-      break;
+      return true;
     case resolve::kCanonical:
-      break;
+      return false;
     case resolve::kLocal:
-      resolve = !e.key.cause_player_id ||
-          std::find(remote.begin(), remote.end(), *e.key.cause_player_id) == remote.end();
-      break;
+      return !key.cause_player_id ||
+          std::find(remote_players_.begin(), remote_players_.end(), *key.cause_player_id) ==
+              remote_players_.end();
     case resolve::kReconcile:
-      resolve = true;
       // TODO: seems to work fine, but should maybe have multiple entries for each key just to
       // be sure? Easy with unordered_multimap?
-      reconciliation_map_[e.key] = tick_count;
-      break;
+      reconciliation_map_[key] = tick_count;
+      return true;
     }
-    if (resolve) {
-      merged_output_.entries.emplace_back(std::move(e));
-    }
-  }
-  output.clear();
+    return false;
+  });
 }
 
 void NetworkedSimState::handle_canonical_output(std::uint64_t tick_count,
@@ -291,49 +714,42 @@ void NetworkedSimState::handle_canonical_output(std::uint64_t tick_count,
   std::erase_if(reconciliation_map_, [&](const auto& pair) {
     return pair.second + kMaxReconcileTickDifference <= tick_count;
   });
-  auto remote = remote_players(mapping_);
-  for (auto& e : output.entries) {
-    bool resolve = false;
-    switch (e.key.type) {
+  output.move_to(merged_output_, [&](std::uint32_t i) {
+    const auto& key = output.entries[i].key;
+    switch (key.type) {
     case resolve::kPredicted:
-      break;
+      return false;
     case resolve::kCanonical:
-      resolve = true;
-      break;
+      return true;
     case resolve::kLocal:
-      resolve = e.key.cause_player_id &&
-          std::find(remote.begin(), remote.end(), *e.key.cause_player_id) != remote.end();
-      break;
+      return key.cause_player_id &&
+          std::find(remote_players_.begin(), remote_players_.end(), *key.cause_player_id) !=
+              remote_players_.end();
     case resolve::kReconcile:
-      auto it = reconciliation_map_.find(e.key);
-      if (it == reconciliation_map_.end()) {
-        resolve = true;
-      } else {
+      if (auto it = reconciliation_map_.find(key); it != reconciliation_map_.end()) {
         reconciliation_map_.erase(it);
+        return false;
       }
-      break;
-    }
-    if (resolve) {
-      merged_output_.entries.emplace_back(std::move(e));
+      return true;
     }
-  }
-  output.clear();
+    return false;
+  });
 }
 
 void NetworkedSimState::handle_replay_output(std::uint64_t tick_count, aggregate_output& output) {
-  for (auto& e : output.entries) {
-    if (e.key.type == resolve::kReconcile && !reconciliation_map_.contains(e.key)) {
-      reconciliation_map_[e.key] = tick_count;
-      merged_output_.entries.emplace_back(std::move(e));
+  output.move_to(merged_output_, [&](std::uint32_t i) {
+    const auto& key = output.entries[i].key;
+    if (key.type == resolve::kReconcile && !reconciliation_map_.contains(key)) {
+      reconciliation_map_[key] = tick_count;
+      return true;
     }
-  }
-  output.clear();
+    return false;
+  });
 }
 
 void NetworkedSimState::handle_dual_output(aggregate_output& output) {
   // Called when updating predicted and canonical state in sync, so no fancy stuff needed.
-  output.append_to(merged_output_);
-  output.clear();
+  output.move_to(merged_output_);
 }
 
 }  // namespace ii
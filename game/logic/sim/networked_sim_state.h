@@ -4,8 +4,11 @@
 #include "game/logic/sim/io/output.h"
 #include "game/logic/sim/io/player.h"
 #include "game/logic/sim/sim_state.h"
+#include <array>
 #include <cstdint>
 #include <deque>
+#include <memory>
+#include <optional>
 #include <span>
 #include <string>
 #include <unordered_map>
@@ -24,10 +27,10 @@ class ReplayWriter;
 // - motion blur when acquiring shield powerup shouldn't happen?
 class NetworkedSimState : public ISimState {
 public:
-  ~NetworkedSimState() override = default;
-  NetworkedSimState(NetworkedSimState&&) noexcept = default;
+  ~NetworkedSimState() override;
+  NetworkedSimState(NetworkedSimState&&) noexcept;
   NetworkedSimState(const NetworkedSimState&) = delete;
-  NetworkedSimState& operator=(NetworkedSimState&&) noexcept = default;
+  NetworkedSimState& operator=(NetworkedSimState&&) noexcept;
   NetworkedSimState& operator=(const NetworkedSimState&) = delete;
 
   NetworkedSimState(const initial_conditions& conditions, network_input_mapping mapping,
@@ -38,18 +41,44 @@ public:
   // Ticks by which to delay input (increases prediction accuracy in exchange for small amounts of
   // input lag).
   void set_input_delay_ticks(std::uint64_t delay_ticks);
-  // May update canonical state; never updates predicted state.
+  // Checksum of canonical state exchanged with remotes to detect desyncs (by default, the fast
+  // position-only checksum). Checksums of a different tier from a remote are ignored, so all peers
+  // should use the same one.
+  void set_checksum_tier(SimState::checksum_tier tier);
+  // Sets the job pool used by both canonical and predicted states (see SimState::set_job_pool).
+  void set_job_pool(JobPool* pool);
+  // Advance canonical state on a dedicated worker thread, rather than on the caller's thread while
+  // handling input. Complete input frames are queued for the worker, which publishes the canonical
+  // state it reaches; update() adopts the latest published state and rebases prediction on it. The
+  // input consumed by the worker is handed back along with it, so the replay writer is still only
+  // written from update(). This, set_checksum_tier() and set_job_pool() must be called before the
+  // first update().
+  void enable_canonical_worker();
+  // Alongside the usual prediction of remote input, speculatively simulate a few alternative
+  // guesses (e.g. fire toggled, or bomb pressed) from the first tick at which remote input is
+  // unknown. If the actual input turns out to match one of them, that branch replaces the
+  // prediction instead of rewinding and replaying. Branches are simulated in parallel using the job
+  // pool, so this is only worthwhile with spare cores.
+  void set_speculative_prediction(bool enabled);
+  // May update canonical state (unless using the canonical worker); never updates predicted state.
   void input_packet(const std::string& remote_id, const data::sim_packet& packet);
   // Always updates predicted state, advancing its tick count by exactly one. May or may not update
   // canonical state.
   std::vector<data::sim_packet> update(std::vector<input_frame> local_input);
 
+  // With the canonical worker enabled, this is the most recently adopted canonical state.
   const SimState& canonical() const { return canonical_state_; }
   const SimState& predicted() const { return predicted_state_; }
 
   struct remote_stats {
     std::uint64_t latest_tick = 0;
     std::uint64_t canonical_tick = 0;
+    // Rollback performed by the most recent update: number of predicted ticks invalidated by the
+    // canonical state advancing, and number of ticks actually re-simulated.
+    std::uint64_t rollback_depth = 0;
+    std::uint64_t rollback_ticks = 0;
+    // Number of times a speculative branch has been adopted in place of a rollback.
+    std::uint64_t hypotheses_adopted = 0;
   };
   remote_stats remote(const std::string& remote_id) const;
 
@@ -67,6 +96,21 @@ public:
 
 private:
   static constexpr std::uint64_t kMaxReconcileTickDifference = 16;
+  static constexpr std::uint64_t kPredictionSnapshotCount = 8;
+  static constexpr std::size_t kPredictionBranchCount = 4;
+  struct canonical_worker;
+  struct partial_frame;
+  struct prediction_branch;
+  struct prediction_tick;
+  void advance_canonical(const partial_frame& partial);
+  void adopt_canonical();
+  void reset_prediction();
+  void record_prediction(std::vector<input_frame> input);
+  std::optional<std::uint64_t> valid_prediction_tick(const std::deque<prediction_tick>& history,
+                                                     bool diverged) const;
+  void spawn_prediction_branches(const partial_frame& partial,
+                                 const std::vector<input_frame>& inputs);
+  prediction_branch* resolve_prediction_branches();
   void handle_predicted_output(std::uint64_t tick_count, aggregate_output& output);
   void handle_canonical_output(std::uint64_t tick_count, aggregate_output& output);
   void handle_replay_output(std::uint64_t tick_count, aggregate_output& output);
@@ -77,9 +121,17 @@ private:
   SimState predicted_state_;
   aggregate_output merged_output_;
   network_input_mapping mapping_;
+  std::vector<std::uint32_t> remote_players_;
   std::uint32_t player_count_ = 0;
   std::uint64_t input_delay_ticks_ = 0;
   std::uint64_t predicted_tick_base_ = 0;
+  JobPool* job_pool_ = nullptr;
+  bool speculative_prediction_ = false;
+  std::unique_ptr<canonical_worker> canonical_worker_;
+  // Taken over from canonical state while the canonical worker is enabled.
+  data::ReplayWriter* replay_writer_ = nullptr;
+  // Number of complete frames queued for the canonical worker and not yet adopted.
+  std::uint64_t canonical_in_flight_ = 0;
 
   struct resolve_key_hash {
     std::size_t operator()(const resolve_key& k) const { return k.hash(); }
@@ -93,28 +145,79 @@ private:
   };
 
   struct tick_checksum {
-    tick_checksum(std::uint64_t tick_count, std::uint32_t checksum)
-    : tick_count{tick_count}, checksum{checksum} {}
+    tick_checksum(std::uint64_t tick_count, std::uint32_t checksum, SimState::checksum_tier tier)
+    : tick_count{tick_count}, checksum{checksum}, tier{tier} {}
     std::uint64_t tick_count = 0;
     std::uint32_t checksum = 0;
+    SimState::checksum_tier tier = SimState::checksum_tier::kFast;
   };
+  void record_canonical_checksum();
 
   struct remote_info {
     std::deque<tick_checksum> checksums;
     std::uint64_t latest_tick = 0;
     std::uint64_t canonical_tick = 0;
   };
+  SimState::checksum_tier checksum_tier_ = SimState::checksum_tier::kFast;
   std::deque<tick_checksum> local_checksums_;
   std::unordered_map<std::string, remote_info> remotes_;
   std::unordered_set<std::string> checksum_failed_remote_ids_;
 
-  // Latest known input for each player.
+  // Latest known input for each player (decayed as it's used for prediction).
   std::vector<input_frame> latest_input_;
+  // Latest input actually received for each remote player.
+  std::vector<input_frame> received_input_;
   // Partial input data, starting at canonical tick.
   std::deque<partial_frame> partial_frames_;
   // Queue of delayed local inputs.
   std::deque<std::vector<input_frame>> input_delayed_frames_;
   mutable std::vector<ai_state> ai_state_;
+
+  struct prediction_tick {
+    std::uint64_t tick_count = 0;
+    std::uint32_t checksum = 0;
+    bool predicted_effects = false;  // See SimState::has_predicted_effects().
+    std::vector<input_frame> input;  // Input used to advance to this tick.
+  };
+
+  struct prediction_snapshot {
+    std::optional<std::uint64_t> tick_count;
+    SimState state;
+  };
+
+  // Canonical tick the predicted state was last rewound to.
+  std::uint64_t prediction_base_tick_ = 0;
+  // Set if canonical state consumed input that differs from what was predicted.
+  bool prediction_diverged_ = false;
+  // Each tick predicted since the canonical tick.
+  std::deque<prediction_tick> prediction_history_;
+  // Pooled snapshots of recent predicted states, indexed by tick count.
+  std::array<prediction_snapshot, kPredictionSnapshotCount> prediction_snapshots_;
+
+  // Speculative prediction using an alternative guess for unknown remote input. Branches always
+  // have the same tick count as the predicted state, and track validity in the same way.
+  struct prediction_branch {
+    bool active = false;
+    // Tick at which the branch split from the prediction.
+    std::uint64_t split_tick = 0;
+    bool diverged = false;
+    std::deque<prediction_tick> history;
+    // Guessed input for each player, used whenever actual input is unknown.
+    std::vector<input_frame> hypothesis;
+    std::vector<input_frame> input;
+    SimState state;
+    // Output of each tick simulated since the split, replayed tick by tick on adoption.
+    struct tick_output {
+      std::uint64_t tick_count = 0;
+      aggregate_output output;
+    };
+    std::vector<tick_output> output;
+  };
+  std::array<prediction_branch, kPredictionBranchCount> prediction_branches_;
+  std::uint64_t hypotheses_adopted_ = 0;
+  // Rollback performed by the most recent update.
+  std::uint64_t rollback_depth_ = 0;
+  std::uint64_t rollback_ticks_ = 0;
 };
 
 }  // namespace ii
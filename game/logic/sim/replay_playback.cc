@@ -0,0 +1,49 @@
+#include "game/logic/sim/replay_playback.h"
+#include "game/data/replay.h"
+#include "game/logic/sim/io/conditions.h"
+#include "game/logic/sim/io/output.h"
+#include <algorithm>
+
+namespace ii {
+
+ReplayPlayback::ReplayPlayback(data::ReplayReader& reader, std::uint64_t checkpoint_interval)
+: reader_{&reader}
+, checkpoint_interval_{std::max<std::uint64_t>(1u, checkpoint_interval)}
+, state_{reader.initial_conditions()} {
+  record_checkpoint();
+}
+
+void ReplayPlayback::update() {
+  if (state_.game_over()) {
+    return;
+  }
+  state_.update(reader_->next_tick_input_frames());
+  record_checkpoint();
+}
+
+void ReplayPlayback::seek(std::uint64_t tick) {
+  // Restore from the closest checkpoint at or before the target, unless the current state is
+  // already closer. Output from skipped ticks is discarded.
+  auto index = std::min<std::size_t>(tick / checkpoint_interval_, checkpoints_.size() - 1);
+  const auto& checkpoint = checkpoints_[index];
+  if (tick < tick_count() || checkpoint.state.tick_count() > tick_count()) {
+    checkpoint.state.copy_to(state_, /* delta */ true);
+    reader_->seek_input_frame(checkpoint.input_frame);
+  }
+  while (tick_count() < tick && !state_.game_over()) {
+    update();
+    state_.output().clear();
+  }
+}
+
+void ReplayPlayback::record_checkpoint() {
+  if (tick_count() % checkpoint_interval_ ||
+      tick_count() / checkpoint_interval_ != checkpoints_.size()) {
+    return;
+  }
+  auto& checkpoint = checkpoints_.emplace_back();
+  state_.copy_to(checkpoint.state);
+  checkpoint.input_frame = reader_->current_input_frame();
+}
+
+}  // namespace ii
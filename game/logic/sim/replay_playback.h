@@ -0,0 +1,56 @@
+#ifndef II_GAME_LOGIC_SIM_REPLAY_PLAYBACK_H
+#define II_GAME_LOGIC_SIM_REPLAY_PLAYBACK_H
+#include "game/logic/sim/sim_state.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ii {
+namespace data {
+class ReplayReader;
+}  // namespace data
+
+// Plays back a replay, keeping a copy of the sim state every checkpoint interval ticks the first
+// time each is reached. Seeking to a tick at or before the furthest point reached so far simulates
+// at most one interval's worth of ticks from the closest earlier checkpoint.
+class ReplayPlayback {
+public:
+  static constexpr std::uint64_t kDefaultCheckpointInterval = 1024;
+
+  ~ReplayPlayback() = default;
+  ReplayPlayback(ReplayPlayback&&) noexcept = default;
+  ReplayPlayback(const ReplayPlayback&) = delete;
+  ReplayPlayback& operator=(ReplayPlayback&&) noexcept = default;
+  ReplayPlayback& operator=(const ReplayPlayback&) = delete;
+
+  // The reader must outlive the playback, and shouldn't be read from elsewhere.
+  ReplayPlayback(data::ReplayReader& reader,
+                 std::uint64_t checkpoint_interval = kDefaultCheckpointInterval);
+
+  SimState& state() { return state_; }
+  const SimState& state() const { return state_; }
+  std::uint64_t tick_count() const { return state_.tick_count(); }
+  std::size_t checkpoint_count() const { return checkpoints_.size(); }
+
+  // Advances the state by one tick using the next replay input.
+  void update();
+  // Moves the state to the given tick, or to the end of the game if it finishes before then.
+  void seek(std::uint64_t tick);
+
+private:
+  struct checkpoint_t {
+    SimState state;
+    std::size_t input_frame = 0;
+  };
+  void record_checkpoint();
+
+  data::ReplayReader* reader_ = nullptr;
+  std::uint64_t checkpoint_interval_ = 0;
+  SimState state_;
+  // Checkpoint i holds the state at tick i * checkpoint_interval_.
+  std::vector<checkpoint_t> checkpoints_;
+};
+
+}  // namespace ii
+
+#endif
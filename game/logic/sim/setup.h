@@ -15,9 +15,24 @@ class SimSetup {
 public:
   virtual ~SimSetup() = default;
 
+  // Collision index used outside of legacy compatibility mode. Both produce identical results.
+  enum class collision_index_type {
+    kGrid,
+    kPackedGrid,
+  };
+
+  // Order in which compaction leaves Transform and Collision storage. Spatial order keeps nearby
+  // entities close together in memory; other components always stay in order of creation.
+  enum class compaction_order {
+    kCreation,
+    kSpatial,
+  };
+
   struct game_parameters {
     std::uint32_t fps = 0;
     vec2 dimensions{0};
+    collision_index_type collision_index = collision_index_type::kGrid;
+    compaction_order compaction = compaction_order::kCreation;
   };
 
   virtual game_parameters parameters(const initial_conditions&) const = 0;
@@ -25,17 +25,17 @@ RandomEngine& EmitHandle::random() {
 }
 
 EmitHandle& EmitHandle::set_delay_ticks(std::uint32_t ticks) {
-  e->delay_ticks = ticks;
+  output->entries[entry].delay_ticks = ticks;
   return *this;
 }
 
 EmitHandle& EmitHandle::background(render::background::update background) {
-  e->background = background;
+  output->entries[entry].background = background;
   return *this;
 }
 
 EmitHandle& EmitHandle::add(particle particle) {
-  e->particles.emplace_back(particle);
+  output->particles.push_back({entry, particle});
   return *this;
 }
 
@@ -71,7 +71,7 @@ EmitHandle& EmitHandle::explosion(const fvec2& v, const cvec4& c, std::uint32_t
 }
 
 EmitHandle& EmitHandle::rumble(std::uint32_t player, std::uint32_t time_ticks, float lf, float hf) {
-  e->rumble.emplace_back(rumble_out{player, time_ticks, lf, hf});
+  output->rumble.push_back({entry, rumble_out{player, time_ticks, lf, hf}});
   return *this;
 }
 
@@ -83,11 +83,12 @@ EmitHandle& EmitHandle::rumble_all(std::uint32_t time_ticks, float lf, float hf)
 }
 
 EmitHandle& EmitHandle::play(sound s, float volume, float pan, float repitch) {
-  auto& se = e->sounds.emplace_back();
-  se.sound_id = s;
-  se.volume = volume;
-  se.pan = pan;
-  se.pitch = repitch;
+  auto& se = output->sounds.emplace_back();
+  se.entry = entry;
+  se.value.sound_id = s;
+  se.value.volume = volume;
+  se.value.pan = pan;
+  se.value.pitch = repitch;
   return *this;
 }
 
@@ -115,6 +116,17 @@ bool SimInterface::is_legacy() const {
   return internals_->conditions.compatibility == compatibility_level::kLegacy;
 }
 
+bool SimInterface::suppress_predicted(const Player& p) {
+  if (p.is_predicted) {
+    mark_predicted_effect();
+  }
+  return p.is_predicted;
+}
+
+void SimInterface::mark_predicted_effect() {
+  internals_->predicted_effects = true;
+}
+
 input_frame& SimInterface::input(std::uint32_t player_number) {
   if (player_number < internals_->input_frames.size()) {
     return internals_->input_frames[player_number];
@@ -135,6 +147,10 @@ ecs::EntityIndex& SimInterface::index() {
   return internals_->index;
 }
 
+ecs::CommandBuffer& SimInterface::commands() {
+  return internals_->commands;
+}
+
 ecs::const_handle SimInterface::global_entity() const {
   return *internals_->global_entity_handle;
 }
@@ -171,6 +187,11 @@ bool SimInterface::random_bool() {
 }
 
 geom::ShapeBank& SimInterface::shape_bank() const {
+  if (internals_->job_pool) {
+    if (auto i = internals_->job_pool->worker_index(); i) {
+      return *internals_->worker_shape_banks[*i];
+    }
+  }
   return internals_->shape_bank;
 }
 
@@ -182,6 +203,19 @@ auto SimInterface::collide(const geom::check_t& check) const -> std::vector<coll
   return internals_->collision_index->collide(check);
 }
 
+auto SimInterface::collide(std::span<const geom::check_t> checks) const
+    -> const collision_arena& {
+  auto* arena = &internals_->collision_arena;
+  if (internals_->job_pool) {
+    if (auto i = internals_->job_pool->worker_index(); i) {
+      arena = &internals_->worker_collision_arenas[*i];
+    }
+  }
+  arena->clear();
+  internals_->collision_index->collide_batch(checks, *arena);
+  return *arena;
+}
+
 bool SimInterface::is_on_screen(const vec2& point) const {
   return all(greaterThanEqual(point, vec2{0})) && all(lessThanEqual(point, dimensions()));
 }
@@ -305,9 +339,9 @@ ecs::handle SimInterface::nearest_player(const vec2& point) {
 }
 
 EmitHandle SimInterface::emit(const resolve_key& key) {
-  auto& e = internals_->output.entries.emplace_back();
-  e.key = key;
-  return {*this, e.e};
+  auto& output = internals_->output;
+  output.entries.emplace_back().key = key;
+  return {*this, output, static_cast<std::uint32_t>(output.entries.size() - 1)};
 }
 
 void SimInterface::trigger(const run_event& event) {
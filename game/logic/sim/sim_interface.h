@@ -3,9 +3,11 @@
 #include "game/common/math.h"
 #include "game/common/random.h"
 #include "game/geometry/types.h"
+#include "game/logic/ecs/command_buffer.h"
 #include "game/logic/ecs/index.h"
 #include "game/logic/sim/io/aggregate.h"
 #include "game/mixer/sound.h"
+#include <algorithm>
 #include <cstdint>
 #include <span>
 #include <vector>
@@ -20,8 +22,9 @@ namespace geom {
 class ShapeBank;
 };
 class SimInterface;
+struct Player;
 struct SimInternals;
-struct aggregate_event;
+struct aggregate_output;
 struct initial_conditions;
 struct input_frame;
 struct run_event;
@@ -65,9 +68,11 @@ public:
 
 private:
   friend class SimInterface;
-  EmitHandle(SimInterface& sim, aggregate_event& e) : sim{&sim}, e{&e} {}
+  EmitHandle(SimInterface& sim, aggregate_output& output, std::uint32_t entry)
+  : sim{&sim}, output{&output}, entry{entry} {}
   SimInterface* sim = nullptr;
-  aggregate_event* e = nullptr;
+  aggregate_output* output = nullptr;
+  std::uint32_t entry = 0;
 };
 
 class SimInterface {
@@ -80,9 +85,18 @@ public:
   bool is_legacy() const;
   input_frame& input(std::uint32_t player_number);
   std::uint64_t tick_count() const;
+  // Predicted players skip actions whose outcome can't be predicted reliably. Returns true if the
+  // player's action must be skipped, in which case the state no longer matches what canonical
+  // simulation would produce. Check it last, only once the action would otherwise happen.
+  bool suppress_predicted(const Player&);
+  // Records any other predicted-only effect, such as predicted damage.
+  void mark_predicted_effect();
 
   const ecs::EntityIndex& index() const;
   ecs::EntityIndex& index();
+  // Structural changes recorded here are applied in order at fixed sync points during the tick:
+  // after all entities have updated, after destroyed entities are removed, and after post-update.
+  ecs::CommandBuffer& commands();
   ecs::const_handle global_entity() const;
   ecs::handle global_entity();
 
@@ -104,9 +118,67 @@ public:
     fixed distance_sq = 0;
   };
 
+  // Results of a batch of collision checks. Each worker thread reuses its own arena across batches,
+  // so that result storage isn't allocated for every check.
+  class collision_arena {
+  public:
+    struct hit {
+      ecs::handle h;
+      shape_flag hit_mask{0};
+      std::uint32_t centres_begin = 0;
+      std::uint32_t centres_end = 0;
+    };
+
+    // Number of checks in the last batch.
+    std::size_t size() const { return check_begin_.size(); }
+    // Hits for the given check of the last batch, in the same order as collide() would return.
+    std::span<const hit> hits(std::size_t check_index) const {
+      auto begin = check_begin_[check_index];
+      auto end =
+          check_index + 1 < check_begin_.size() ? check_begin_[check_index + 1] : hits_.size();
+      return std::span{hits_}.subspan(begin, end - begin);
+    }
+    std::span<const vec2> shape_centres(const hit& h) const {
+      return std::span{buffer_.shape_centres}.subspan(h.centres_begin,
+                                                      h.centres_end - h.centres_begin);
+    }
+
+    // Used by the collision index to fill in results. Shapes are checked directly against the
+    // buffer, so that shape centres of every hit end up in one flat array.
+    void clear() {
+      hits_.clear();
+      buffer_.mask = shape_flag::kNone;
+      buffer_.shape_centres.clear();
+      check_begin_.clear();
+    }
+    void begin_check() { check_begin_.emplace_back(hits_.size()); }
+    geom::hit_result& buffer() { return buffer_; }
+    // Records a hit whose shape centres were appended to the buffer from the given offset.
+    void add(ecs::handle h, shape_flag hit_mask, std::size_t centres_begin) {
+      hits_.emplace_back(collision_arena::hit{h, hit_mask,
+                                              static_cast<std::uint32_t>(centres_begin),
+                                              static_cast<std::uint32_t>(
+                                                  buffer_.shape_centres.size())});
+    }
+    void end_check(bool sort_by_id) {
+      if (sort_by_id) {
+        std::sort(hits_.begin() + static_cast<std::ptrdiff_t>(check_begin_.back()), hits_.end(),
+                  [](const auto& a, const auto& b) { return a.h.id() < b.h.id(); });
+      }
+    }
+
+  private:
+    std::vector<hit> hits_;
+    geom::hit_result buffer_;
+    std::vector<std::size_t> check_begin_;
+  };
+
   geom::ShapeBank& shape_bank() const;
   bool collide_any(const geom::check_t&) const;
   std::vector<collision_info> collide(const geom::check_t&) const;
+  // Runs each check in turn. Results are stored in the calling worker thread's arena, and are only
+  // valid until its next batch.
+  const collision_arena& collide(std::span<const geom::check_t>) const;
   bool is_on_screen(const vec2& point) const;
   vec2 rotate_compatibility(const vec2& v, fixed theta) const;
 
@@ -1,12 +1,15 @@
 #ifndef II_GAME_LOGIC_SIM_SIM_INTERNALS_H
 #define II_GAME_LOGIC_SIM_SIM_INTERNALS_H
+#include "game/common/job_pool.h"
 #include "game/common/random.h"
 #include "game/geometry/shape_bank.h"
+#include "game/logic/ecs/command_buffer.h"
 #include "game/logic/ecs/index.h"
 #include "game/logic/sim/collision.h"
 #include "game/logic/sim/io/conditions.h"
 #include "game/logic/sim/io/output.h"
 #include "game/logic/sim/io/player.h"
+#include "game/logic/sim/setup.h"
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -29,15 +32,33 @@ struct SimInternals {
   initial_conditions conditions;
   vec2 dimensions{0};
   ecs::EntityIndex index;
+  ecs::CommandBuffer commands;
+  std::vector<ecs::entity_id> compact_moved;
   ecs::entity_id global_entity_id{0};
   std::optional<ecs::handle> global_entity_handle;
   std::uint64_t tick_count = 0;
+  // Set once predicted players have done anything that canonical simulation would do differently.
+  bool predicted_effects = false;
   std::unique_ptr<CollisionIndex> collision_index;
+  std::optional<SimSetup::collision_index_type> collision_index_override;
   geom::ShapeBank shape_bank;
 
+  SimInterface::collision_arena collision_arena;
+
+  // Parallel execution. Shape banks and collision arenas aren't thread-safe, so each worker thread
+  // has its own.
+  JobPool* job_pool = nullptr;
+  std::vector<std::unique_ptr<geom::ShapeBank>> worker_shape_banks;
+  std::vector<SimInterface::collision_arena> worker_collision_arenas;
+
   // Per-frame output.
   aggregate_output output;
   render_output render;
+  struct render_chunk {
+    std::vector<render::shape> shapes;
+    std::vector<render::combo_panel> panels;
+  };
+  std::vector<render_chunk> render_chunks;
   // Run output.
   sim_results results;
 };
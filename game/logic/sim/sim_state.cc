@@ -1,4 +1,5 @@
 #include "game/logic/sim/sim_state.h"
+#include "game/common/binary.h"
 #include "game/data/replay.h"
 #include "game/logic/ecs/call.h"
 #include "game/logic/legacy/components.h"
@@ -8,11 +9,27 @@
 #include "game/logic/v0/ai/ai_player.h"
 #include "game/logic/v0/lib/components.h"
 #include "game/logic/v0/lib/setup.h"
+#include "game/version.h"
 #include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <string>
 #include <unordered_set>
+#include <utility>
 
 namespace ii {
 namespace {
+constexpr std::array<char, 8> kSnapshotMagic = {'i', 'i', 's', 'n', 'a', 'p', 's', 'h'};
+constexpr std::uint32_t kSnapshotVersion = 2;
+// Snapshots also depend on the ECS storage layout, which is a build option.
+#ifdef II_ECS_DEQUE_STORAGE
+constexpr std::uint64_t kSnapshotBuildFingerprint =
+    detail::fingerprint_hash(kBuildFingerprint, "ecs_deque_storage");
+#else
+constexpr std::uint64_t kSnapshotBuildFingerprint = kBuildFingerprint;
+#endif
 
 std::unique_ptr<SimSetup> make_sim_setup(const initial_conditions& conditions) {
   if (conditions.mode == game_mode::kStandardRun) {
@@ -29,11 +46,161 @@ void initialise_systems(SimInternals& internals) {
       [&internals](ecs::handle h, const Destroy&) { internals.collision_index->remove(h); });
 }
 
+// Spreads the low 16 bits of x out to the even bits of the result.
+std::uint64_t morton_spread(std::uint32_t x) {
+  std::uint64_t v = x & 0xffff;
+  v = (v | (v << 8)) & 0x00ff00ff;
+  v = (v | (v << 4)) & 0x0f0f0f0f;
+  v = (v | (v << 2)) & 0x33333333;
+  v = (v | (v << 1)) & 0x55555555;
+  return v;
+}
+
+// Z-order curve key of an entity's position, at whole-unit resolution. Only depends on sim state,
+// so the resulting layout is the same on every replay of a game.
+std::uint64_t spatial_compaction_key(ecs::const_handle h) {
+  auto* transform = h.get<Transform>();
+  if (!transform) {
+    return std::numeric_limits<std::uint64_t>::max();
+  }
+  auto coordinate = [](fixed v) {
+    return static_cast<std::uint32_t>(std::clamp(v.to_int() + 32768, 0, 65535));
+  };
+  return morton_spread(coordinate(transform->centre.x)) |
+      morton_spread(coordinate(transform->centre.y)) << 1;
+}
+
+std::unique_ptr<CollisionIndex>
+make_collision_index(const initial_conditions& conditions,
+                     const SimSetup::game_parameters& parameters) {
+  uvec2 cell_dimensions{64, 64};
+  ivec2 min_point{-128, -128};
+  ivec2 max_point = ivec2{parameters.dimensions.x.to_int(), parameters.dimensions.y.to_int()} +
+      ivec2{128, 128};
+  if (conditions.compatibility == compatibility_level::kLegacy) {
+    return std::make_unique<LegacyCollisionIndex>();
+  } else if (parameters.collision_index == SimSetup::collision_index_type::kPackedGrid) {
+    return std::make_unique<PackedGridCollisionIndex>(cell_dimensions, min_point, max_point);
+  }
+  return std::make_unique<GridCollisionIndex>(cell_dimensions, min_point, max_point);
+}
+
+void set_compaction_order(const initial_conditions& conditions,
+                          const SimSetup::game_parameters& parameters, ecs::EntityIndex& index) {
+  if (conditions.compatibility != compatibility_level::kLegacy &&
+      parameters.compaction == SimSetup::compaction_order::kSpatial) {
+    index.set_compaction_order<Transform>(&spatial_compaction_key);
+    index.set_compaction_order<Collision>(&spatial_compaction_key);
+  }
+}
+
+void write_conditions(BinaryWriter& writer, const initial_conditions& conditions) {
+  writer.put(conditions.compatibility)
+      .put(conditions.seed)
+      .put(conditions.player_count)
+      .put_size(conditions.players.size());
+  for (const auto& p : conditions.players) {
+    writer.put(p.player_name);
+  }
+  writer.put(conditions.mode).put(conditions.flags).put(conditions.biomes);
+}
+
+void read_conditions(BinaryReader& reader, initial_conditions& conditions) {
+  std::size_t size = 0;
+  reader.get(conditions.compatibility)
+      .get(conditions.seed)
+      .get(conditions.player_count)
+      .get_size(size);
+  conditions.players.resize(size);
+  for (auto& p : conditions.players) {
+    reader.get(p.player_name);
+  }
+  reader.get(conditions.mode).get(conditions.flags).get(conditions.biomes);
+}
+
+void write_results(BinaryWriter& writer, const sim_results& results) {
+  writer.put(results.tick_count)
+      .put(results.seed)
+      .put(results.lives_remaining)
+      .put_size(results.players.size());
+  for (const auto& p : results.players) {
+    writer.put(p.number).put(p.score).put(p.deaths);
+  }
+  writer.put_size(results.events.size());
+  for (const auto& e : results.events) {
+    writer.put(e.boss_kill);
+  }
+  writer.put(results.score);
+}
+
+void read_results(BinaryReader& reader, sim_results& results) {
+  std::size_t size = 0;
+  reader.get(results.tick_count).get(results.seed).get(results.lives_remaining).get_size(size);
+  results.players.resize(size);
+  for (auto& p : results.players) {
+    reader.get(p.number).get(p.score).get(p.deaths);
+  }
+  reader.get_size(size);
+  results.events.resize(size);
+  for (auto& e : results.events) {
+    reader.get(e.boss_kill);
+  }
+  reader.get(results.score);
+}
+
+// Adds the time until destruction to the given total, if any. Timing is compiled out unless the
+// profiler is enabled.
+class ScopedTimer {
+public:
+  using clock = std::chrono::steady_clock;
+  explicit ScopedTimer(std::chrono::nanoseconds* total)
+  : total_{SimState::kProfilerEnabled ? total : nullptr} {
+    if (total_) {
+      start_ = clock::now();
+    }
+  }
+  ~ScopedTimer() {
+    if (total_) {
+      *total_ += clock::now() - start_;
+    }
+  }
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+  std::chrono::nanoseconds* total_ = nullptr;
+  clock::time_point start_;
+};
+
+std::chrono::nanoseconds& update_function_time(SimState::phase_timings& timings,
+                                               const ecs::EntityIndex& index, ecs::const_handle h,
+                                               const Update& c) {
+  auto [it, inserted] =
+      timings.update_functions.try_emplace(reinterpret_cast<std::uintptr_t>(c.update));
+  if (inserted) {
+    // Game-specific components have higher IDs than the common ones.
+    it->second.name = "update";
+    for (auto i = +sim_component::kMax; i > 0; --i) {
+      if (auto cid = ecs::component_id{static_cast<ecs::index_type>(i - 1)}; h.has(cid)) {
+        it->second.name = index.debug_name(cid) + " update";
+        break;
+      }
+    }
+  }
+  ++it->second.calls;
+  return it->second.time;
+}
+
 void refresh_handles(const SimInterface& interface, SimInternals& internals) {
   internals.collision_index->refresh_handles(interface, internals.index);
   internals.global_entity_handle = internals.index.get(internals.global_entity_id);
 }
 
+void refresh_handles(SimInternals& internals, std::span<const ecs::entity_id> ids) {
+  internals.collision_index->refresh_handles(internals.index, ids);
+  internals.global_entity_handle = internals.index.get(internals.global_entity_id);
+}
+
 }  // namespace
 
 SimState::~SimState() = default;
@@ -53,21 +220,16 @@ SimState::SimState(const initial_conditions& conditions, data::ReplayWriter* rep
 , interface_{std::make_unique<SimInterface>(internals_.get())} {
   setup_ = make_sim_setup(conditions);
   internals_->conditions = conditions;
-  internals_->dimensions = setup_->parameters(internals_->conditions).dimensions;
+  auto parameters = setup_->parameters(internals_->conditions);
+  internals_->dimensions = parameters.dimensions;
   for (std::uint32_t i = internals_->conditions.players.size();
        i < internals_->conditions.player_count; ++i) {
     auto& player = internals_->conditions.players.emplace_back();
     player.player_name = ustring::ascii("Player " + std::to_string(i + 1));
   }
 
-  if (conditions.compatibility == compatibility_level::kLegacy) {
-    internals_->collision_index = std::make_unique<LegacyCollisionIndex>();
-  } else {
-    internals_->collision_index = std::make_unique<GridCollisionIndex>(
-        uvec2{64, 64}, ivec2{-128, -128},
-        ivec2{internals_->dimensions.x.to_int(), internals_->dimensions.y.to_int()} +
-            ivec2{128, 128});
-  }
+  internals_->collision_index = make_collision_index(conditions, parameters);
+  set_compaction_order(conditions, parameters, internals_->index);
 
   internals_->global_entity_id = setup_->start_game(conditions, *interface_);
   internals_->index.iterate_dispatch<Player>([&](ecs::handle h, const Player& p) {
@@ -100,7 +262,29 @@ std::uint32_t SimState::checksum() const {
   return static_cast<std::uint32_t>(result);
 }
 
-void SimState::copy_to(SimState& target) const {
+std::uint32_t SimState::checksum(checksum_tier tier) const {
+  if (tier == checksum_tier::kFast) {
+    return checksum();
+  }
+  if (tier == checksum_tier::kDeep) {
+    auto result = hash_bytes(snapshot());
+    return static_cast<std::uint32_t>(result ^ (result >> 32));
+  }
+  // Everything else is a handful of scalars, hashed directly.
+  std::size_t result = internals_->index.checksum();
+  hash_combine(result, close_timer_);
+  hash_combine(result, game_over_);
+  hash_combine(result, internals_->game_state_random.state());
+  hash_combine(result, internals_->game_sequence_random.state());
+  hash_combine(result, internals_->aesthetic_random.state());
+  hash_combine(result, +internals_->global_entity_id);
+  hash_combine(result, static_cast<std::size_t>(internals_->tick_count));
+  hash_combine(result, internals_->results.lives_remaining);
+  hash_combine(result, static_cast<std::size_t>(internals_->results.score));
+  return static_cast<std::uint32_t>(result ^ (static_cast<std::uint64_t>(result) >> 32));
+}
+
+void SimState::copy_to(SimState& target, bool delta) const {
   if (&target == this) {
     return;
   }
@@ -111,9 +295,9 @@ void SimState::copy_to(SimState& target) const {
   target.close_timer_ = close_timer_;
   target.colour_cycle_ = colour_cycle_;
   target.game_over_ = game_over_;
-  target.compact_counter_ = 0;
+  target.compact_counter_ = compact_counter_;
 
-  internals_->index.copy_to(target.internals_->index);
+  internals_->index.copy_to(target.internals_->index, delta);
   target.internals_->input_frames.clear();
   target.internals_->game_state_random.set_state(internals_->game_state_random.state());
   target.internals_->game_sequence_random.set_state(internals_->game_sequence_random.state());
@@ -123,12 +307,106 @@ void SimState::copy_to(SimState& target) const {
   target.internals_->global_entity_id = internals_->global_entity_id;
   target.internals_->global_entity_handle.reset();
   target.internals_->tick_count = internals_->tick_count;
-  target.internals_->collision_index = internals_->collision_index->clone();
+  target.internals_->predicted_effects = internals_->predicted_effects;
+  internals_->collision_index->copy_to(target.internals_->collision_index);
   target.internals_->results = internals_->results;
   target.internals_->output.clear();
   refresh_handles(*target.interface_, *target.internals_);
 }
 
+std::vector<std::uint8_t> SimState::snapshot() const {
+  BinaryWriter writer;
+  for (auto c : kSnapshotMagic) {
+    writer.put(c);
+  }
+  // Snapshots are only valid for the build that wrote them.
+  writer.put(kSnapshotVersion).put(std::string{kGameVersion}).put(kSnapshotBuildFingerprint);
+  write_conditions(writer, internals_->conditions);
+
+  writer.put(close_timer_)
+      .put(colour_cycle_)
+      .put(static_cast<std::uint64_t>(compact_counter_))
+      .put(game_over_)
+      .put(internals_->game_state_random)
+      .put(internals_->game_sequence_random)
+      .put(internals_->aesthetic_random)
+      .put(internals_->dimensions)
+      .put(internals_->global_entity_id)
+      .put(internals_->tick_count);
+  write_results(writer, internals_->results);
+  internals_->index.write(writer);
+  internals_->collision_index->write(writer);
+  return writer.extract();
+}
+
+result<void> SimState::restore(std::span<const std::uint8_t> snapshot) {
+  BinaryReader reader{snapshot};
+  std::array<char, 8> magic{};
+  for (auto& c : magic) {
+    reader.get(c);
+  }
+  std::uint32_t version = 0;
+  std::string game_version;
+  std::uint64_t build_fingerprint = 0;
+  reader.get(version).get(game_version).get(build_fingerprint);
+  if (!reader.ok() || magic != kSnapshotMagic) {
+    return unexpected("invalid snapshot");
+  }
+  if (version != kSnapshotVersion || game_version != kGameVersion ||
+      build_fingerprint != kSnapshotBuildFingerprint) {
+    return unexpected("snapshot is from a different build");
+  }
+
+  initial_conditions conditions;
+  read_conditions(reader, conditions);
+  if (!reader.ok()) {
+    return unexpected("invalid snapshot");
+  }
+  // The setup's systems are registered on the index, so it can't be replaced.
+  bool is_v0 = conditions.mode == game_mode::kStandardRun;
+  if (setup_ && is_v0 != (internals_->conditions.mode == game_mode::kStandardRun)) {
+    return unexpected("snapshot is for a different game mode");
+  }
+  if (!setup_) {
+    setup_ = make_sim_setup(conditions);
+    setup_->initialise_systems(*interface_);
+  }
+  auto parameters = setup_->parameters(conditions);
+  if (internals_->collision_index_override) {
+    parameters.collision_index = *internals_->collision_index_override;
+  }
+  internals_->conditions = std::move(conditions);
+
+  std::uint64_t compact_counter = 0;
+  reader.get(close_timer_)
+      .get(colour_cycle_)
+      .get(compact_counter)
+      .get(game_over_)
+      .get(internals_->game_state_random)
+      .get(internals_->game_sequence_random)
+      .get(internals_->aesthetic_random)
+      .get(internals_->dimensions)
+      .get(internals_->global_entity_id)
+      .get(internals_->tick_count);
+  compact_counter_ = static_cast<std::size_t>(compact_counter);
+  read_results(reader, internals_->results);
+  internals_->predicted_effects = false;
+  internals_->input_frames.clear();
+  internals_->global_entity_handle.reset();
+  internals_->output.clear();
+
+  auto& index = internals_->index;
+  internals_->collision_index = make_collision_index(internals_->conditions, parameters);
+  if (!reader.ok() || !index.read(reader) || !internals_->collision_index->read(reader, index) ||
+      !reader.at_end()) {
+    return unexpected("invalid snapshot");
+  }
+  // The snapshot restores compaction order of the storage it contains; this covers the rest.
+  set_compaction_order(internals_->conditions, parameters, index);
+  refresh_handles(*interface_, *internals_);
+  return {};
+}
+
 void SimState::ai_think(std::vector<input_frame>& input) const {
   ai_think(input, ai_state_);
 }
@@ -136,11 +414,21 @@ void SimState::ai_think(std::vector<input_frame>& input) const {
 void SimState::ai_think(std::vector<input_frame>& input, std::vector<ai_state>& state) const {
   input.resize(internals_->conditions.player_count);
   state.resize(internals_->conditions.player_count);
-  internals_->index.iterate_dispatch<Player>([&](ecs::handle h, const Player& p) {
-    if (auto f = v0::ai_think(*interface_, h, state[p.player_number]); f) {
-      input[p.player_number] = *f;
+  // Each player thinks independently, touching only its own AI state.
+  using player_frames = std::vector<std::pair<std::uint32_t, input_frame>>;
+  std::vector<player_frames> chunks;
+  internals_->index.iterate_dispatch_parallel<Player>(
+      internals_->job_pool, chunks,
+      [&](ecs::const_handle h, const Player& p, player_frames& frames) {
+        if (auto f = v0::ai_think(*interface_, h, state[p.player_number]); f) {
+          frames.emplace_back(p.player_number, *f);
+        }
+      });
+  for (const auto& frames : chunks) {
+    for (const auto& [player_number, frame] : frames) {
+      input[player_number] = frame;
     }
-  });
+  }
 }
 
 void SimState::update(std::vector<input_frame> input) {
@@ -148,45 +436,87 @@ void SimState::update(std::vector<input_frame> input) {
       : internals_->conditions.mode == game_mode::kLegacy_Fast           ? 192
       : internals_->conditions.mode == game_mode::kLegacy_What           ? (colour_cycle_ + 3) % 256
                                                                          : 0;
-  internals_->input_frames = std::move(input);
-  internals_->input_frames.resize(internals_->conditions.player_count);
-  internals_->collision_index->begin_tick();
-  setup_->begin_tick(*interface_);
-
-  internals_->index.iterate_dispatch_if<Boss>([&](Boss& boss, Transform& transform) {
-    if (interface_->is_on_screen(transform.centre)) {
-      boss.show_hp_bar = true;
-    }
-  });
-  internals_->index.iterate<Health>([](Health& h) { h.hit_timer && --h.hit_timer; });
-  internals_->index.iterate_dispatch<Update>([&](ecs::handle h, Update& c) {
-    if (!h.has<Destroy>()) {
-      if (!c.skip_update) {
-        c.update(h, *interface_);
+  auto* timings = kProfilerEnabled ? phase_timings_ : nullptr;
+  auto phase = [timings](std::chrono::nanoseconds phase_timings::*p) {
+    return timings ? &(timings->*p) : nullptr;
+  };
+
+  {
+    ScopedTimer timer{phase(&phase_timings::begin_tick)};
+    internals_->input_frames = std::move(input);
+    internals_->input_frames.resize(internals_->conditions.player_count);
+    internals_->collision_index->begin_tick();
+    setup_->begin_tick(*interface_);
+
+    internals_->index.iterate_dispatch_if<Boss>([&](Boss& boss, const Transform& transform) {
+      if (interface_->is_on_screen(transform.centre)) {
+        boss.show_hp_bar = true;
       }
-      // TODO: we only update after the entity itself has updated: this can still lead to minor
-      // inconsistencies if the entity is moved externally.
-      internals_->collision_index->update(h);
-    }
-  });
+    });
+    internals_->index.iterate<Health>([](Health& h) { h.hit_timer && --h.hit_timer; });
+  }
 
-  internals_->index.iterate_dispatch<Destroy>([&](ecs::const_handle h) {
-    internals_->index.destroy(h.id());
-    ++compact_counter_;
-  });
+  std::chrono::nanoseconds collision_time{0};
+  {
+    ScopedTimer timer{phase(&phase_timings::update)};
+    internals_->index.iterate_dispatch<Update>([&](ecs::handle h, const Update& c) {
+      if (!h.has<Destroy>()) {
+        if (!c.skip_update) {
+          ScopedTimer update_timer{
+              timings ? &update_function_time(*timings, internals_->index, h, c) : nullptr};
+          c.update(h, *interface_);
+        }
+        // TODO: we only update after the entity itself has updated: this can still lead to minor
+        // inconsistencies if the entity is moved externally.
+        ScopedTimer collision_timer{timings ? &collision_time : nullptr};
+        internals_->collision_index->update(h);
+      }
+    });
+    internals_->commands.apply(internals_->index);
+  }
+  if (timings) {
+    timings->update -= collision_time;
+    timings->collision += collision_time;
+  }
 
-  if (compact_counter_ >= internals_->index.size()) {
-    internals_->index.compact();
-    refresh_handles(*interface_, *internals_);
-    compact_counter_ = 0;
+  {
+    ScopedTimer timer{phase(&phase_timings::destroy)};
+    internals_->index.iterate_dispatch<Destroy>([&](ecs::const_handle h) {
+      internals_->commands.destroy(h.id());
+      ++compact_counter_;
+    });
+    internals_->commands.apply(internals_->index);
   }
 
-  internals_->index.iterate_dispatch<PostUpdate>([&](ecs::handle h, PostUpdate& c) {
-    if (!h.has<Destroy>()) {
-      c.post_update(h, *interface_);
+  {
+    // Compaction is spread over many ticks, so that no single tick pays for all of it. Order of
+    // iteration is unaffected, so it has no effect on the simulation itself.
+    ScopedTimer timer{phase(&phase_timings::compaction)};
+    static constexpr std::size_t kCompactEntriesPerTick = 1024;
+    bool compact = internals_->index.is_compacting();
+    if (!compact && compact_counter_ >= internals_->index.size()) {
+      compact = true;
+      compact_counter_ = 0;
     }
-  });
+    if (compact) {
+      auto& moved = internals_->compact_moved;
+      moved.clear();
+      internals_->index.compact_step(kCompactEntriesPerTick, moved);
+      refresh_handles(*internals_, moved);
+    }
+  }
 
+  {
+    ScopedTimer timer{phase(&phase_timings::post_update)};
+    internals_->index.iterate_dispatch<PostUpdate>([&](ecs::handle h, const PostUpdate& c) {
+      if (!h.has<Destroy>()) {
+        c.post_update(h, *interface_);
+      }
+    });
+    internals_->commands.apply(internals_->index);
+  }
+
+  ScopedTimer timer{phase(&phase_timings::end_tick)};
   if (!close_timer_ && setup_->is_game_over(*interface_)) {
     close_timer_ = 100;
   }
@@ -203,6 +533,19 @@ void SimState::update(std::vector<input_frame> input) {
       replay_writer_->add_input_frame(f);
     }
   }
+  if (timings) {
+    ++timings->ticks;
+  }
+}
+
+void SimState::set_job_pool(JobPool* pool) {
+  internals_->job_pool = pool;
+  internals_->worker_shape_banks.clear();
+  for (std::uint32_t i = 0; pool && i < pool->worker_count(); ++i) {
+    internals_->worker_shape_banks.emplace_back(std::make_unique<geom::ShapeBank>());
+  }
+  internals_->worker_collision_arenas.clear();
+  internals_->worker_collision_arenas.resize(pool ? pool->worker_count() : 0);
 }
 
 bool SimState::game_over() const {
@@ -214,6 +557,11 @@ std::uint32_t SimState::fps() const {
 }
 
 render_output& SimState::render(transient_render_state& state, bool paused) const {
+  auto* timings = kProfilerEnabled ? phase_timings_ : nullptr;
+  ScopedTimer timer{timings ? &timings->render : nullptr};
+  if (timings) {
+    ++timings->frames;
+  }
   auto& result = internals_->render;
   result.boss.reset();
   result.shapes.clear();
@@ -221,12 +569,35 @@ render_output& SimState::render(transient_render_state& state, bool paused) cons
   result.panels.clear();
   result.players.clear();
 
-  internals_->index.iterate_dispatch<Render>([&](ecs::handle h, Render& r) {
-    if (!h.get<Player>()) {
-      r.render_all(h, state.entity_map[+h.id()], paused, result.shapes, result.panels, *interface_);
-      return;
+  // Transient state entries are created up front, so that extraction (which may run in parallel)
+  // only looks them up. Players are rendered afterwards, as before. Render components are only
+  // accessed mutably (marking them modified) when trails actually need clearing.
+  static constexpr std::size_t kRenderChunkSize = 64;
+  internals_->index.iterate_dispatch<Render>([&](ecs::const_handle h, const Render& r) {
+    auto& entity_state = state.entity_map[+h.id()];
+    if (r.clear_trails) {
+      internals_->index.get(h.id())->get<Render>()->update_trails(entity_state);
     }
   });
+  for (auto& chunk : internals_->render_chunks) {
+    chunk.shapes.clear();
+    chunk.panels.clear();
+  }
+  internals_->index.iterate_dispatch_parallel<Render>(
+      internals_->job_pool, internals_->render_chunks,
+      [&](ecs::const_handle h, const Render& r, SimInternals::render_chunk& chunk) {
+        if (!h.has<Player>()) {
+          r.render_all(h, state.entity_map.find(+h.id())->second, paused, chunk.shapes,
+                       chunk.panels, *interface_);
+        }
+      },
+      kRenderChunkSize);
+  for (auto& chunk : internals_->render_chunks) {
+    result.shapes.insert(result.shapes.end(), std::make_move_iterator(chunk.shapes.begin()),
+                         std::make_move_iterator(chunk.shapes.end()));
+    result.panels.insert(result.panels.end(), std::make_move_iterator(chunk.panels.begin()),
+                         std::make_move_iterator(chunk.panels.end()));
+  }
   internals_->index.iterate_dispatch<Player>([&](ecs::handle h, const Player& p, Render& r,
                                                  Transform& transform) {
     if (auto info = p.render_info(h, *interface_)) {
@@ -353,6 +724,22 @@ const sim_results& SimState::results() const {
   return r;
 }
 
+void SimState::set_collision_index(SimSetup::collision_index_type type) {
+  internals_->collision_index_override = type;
+  if (!setup_) {
+    return;
+  }
+  auto parameters = setup_->parameters(internals_->conditions);
+  parameters.collision_index = type;
+  internals_->collision_index = make_collision_index(internals_->conditions, parameters);
+  internals_->index.iterate_dispatch<Collision>([&](ecs::handle h, const Collision& c) {
+    if (!h.has<Destroy>()) {
+      internals_->collision_index->add(h, c);
+    }
+  });
+  refresh_handles(*interface_, *internals_);
+}
+
 void SimState::set_predicted_players(std::span<const std::uint32_t> player_ids) {
   internals_->index.iterate<Player>([&](Player& p) {
     p.is_predicted =
@@ -360,6 +747,10 @@ void SimState::set_predicted_players(std::span<const std::uint32_t> player_ids)
   });
 }
 
+bool SimState::has_predicted_effects() const {
+  return internals_->predicted_effects;
+}
+
 void SimState::update_smoothing(smoothing_data& data) {
   static constexpr fixed kMaxRotationSpeed = pi<fixed> / 16;
   auto smooth_rotate = [&](fixed& x, fixed target) {
@@ -422,4 +813,39 @@ void SimState::dump(Printer& printer, const query& q) const {
   internals_->index.dump(printer, q.portable, index_q);
 }
 
+ecs::index_stats SimState::stats() const {
+  return internals_->index.stats();
+}
+
+void SimState::phase_timings::add(const phase_timings& t) {
+  ticks += t.ticks;
+  frames += t.frames;
+  begin_tick += t.begin_tick;
+  update += t.update;
+  collision += t.collision;
+  destroy += t.destroy;
+  compaction += t.compaction;
+  post_update += t.post_update;
+  end_tick += t.end_tick;
+  render += t.render;
+  for (const auto& [key, f] : t.update_functions) {
+    auto& e = update_functions[key];
+    e.name = f.name;
+    e.calls += f.calls;
+    e.time += f.time;
+  }
+}
+
+std::vector<const SimState::phase_timings::function_timing*>
+SimState::phase_timings::sorted_update_functions() const {
+  std::vector<const function_timing*> result;
+  for (const auto& [_, f] : update_functions) {
+    result.emplace_back(&f);
+  }
+  std::sort(result.begin(), result.end(), [](const function_timing* a, const function_timing* b) {
+    return a->time != b->time ? a->time > b->time : a->name < b->name;
+  });
+  return result;
+}
+
 }  // namespace ii
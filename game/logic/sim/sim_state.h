@@ -1,11 +1,16 @@
 #ifndef II_GAME_LOGIC_SIM_SIM_STATE_H
 #define II_GAME_LOGIC_SIM_SIM_STATE_H
 #include "game/common/math.h"
+#include "game/common/result.h"
+#include "game/logic/ecs/stats.h"
 #include "game/logic/sim/io/player.h"
+#include "game/logic/sim/setup.h"
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <optional>
 #include <span>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -14,6 +19,7 @@ namespace ii {
 namespace data {
 class ReplayWriter;
 }  // namespace data
+class JobPool;
 class Printer;
 class SimInterface;
 class SimSetup;
@@ -54,8 +60,32 @@ public:
 
   uvec2 dimensions() const override;
   std::uint64_t tick_count() const override;
-  std::uint32_t checksum() const;  // Fast checksum.
-  void copy_to(SimState&) const;
+  // Fast checksum of entity positions only. Predicted states are expected to match canonical ones
+  // by this measure.
+  std::uint32_t checksum() const;
+  // Checksums for detecting desyncs. The fast checksum is the one above. The others cover the full
+  // simulation state, and are opt-in for tools, tests and debugging: the incremental checksum
+  // covers all component data and RNG states, but only rehashes component storage modified since
+  // it was last computed; the deep checksum hashes a complete snapshot(), so doesn't rely on
+  // modification tracking, but is much more expensive.
+  enum class checksum_tier : std::uint32_t {
+    kFast,
+    kIncremental,
+    kDeep,
+  };
+  // The incremental checksum updates cached hashes and modification epochs inside the entity index,
+  // so despite being const it must not run concurrently with any other use of the same state.
+  std::uint32_t checksum(checksum_tier) const;
+  // If delta is set, only rewrites entities and components modified since the target was last
+  // copied to from this state, where possible.
+  void copy_to(SimState&, bool delta = false) const;
+  // Serialise the complete simulation state to a compact binary snapshot, which restore() (on this
+  // or any other state) reproduces exactly; much faster than re-simulating to the same tick.
+  // Snapshots refer to functions by address, so they can only be restored by the same build.
+  std::vector<std::uint8_t> snapshot() const;
+  // As with copy_to(), replay writer, job pool and other configuration of this state is kept. On
+  // failure, the state must not be used until successfully restored or copied to.
+  result<void> restore(std::span<const std::uint8_t> snapshot);
   void ai_think(std::vector<input_frame>& input) const override;
   void ai_think(std::vector<input_frame>& input, std::vector<ai_state>& state) const;
   void update(std::vector<input_frame> input);
@@ -78,7 +108,14 @@ public:
     std::unordered_map<std::uint32_t, player_data> players;
   };
 
+  // Replaces the collision index used outside of legacy compatibility mode, for testing that each
+  // produces identical results. Kept across restore().
+  void set_collision_index(SimSetup::collision_index_type);
   void set_predicted_players(std::span<const std::uint32_t>);
+  // Whether predicted players have done anything (e.g. dealt predicted damage) that canonical
+  // simulation would do differently, since this state was last copied from one where they hadn't.
+  // Until then, the state is identical to canonical state simulated with the same input.
+  bool has_predicted_effects() const;
   void update_smoothing(smoothing_data& data);
 
   // Debug query API.
@@ -89,6 +126,51 @@ public:
     std::unordered_set<std::string> component_names;
   };
   void dump(Printer&, const query& q = {}) const;
+  // Memory usage and fragmentation of the entity index.
+  ecs::index_stats stats() const;
+
+  // Profiling API: if set, time spent in each phase of update() and render() is added to the given
+  // timings. Collision is the time spent updating the collision index after each entity updates,
+  // and is excluded from the update phase. Timing is compiled out (leaving the timings untouched)
+  // unless built with --sim_profiler.
+#ifdef II_SIM_PROFILER
+  static constexpr bool kProfilerEnabled = true;
+#else
+  static constexpr bool kProfilerEnabled = false;
+#endif
+  struct phase_timings {
+    struct function_timing {
+      std::string name;
+      std::uint64_t calls = 0;
+      std::chrono::nanoseconds time{0};
+    };
+
+    std::uint64_t ticks = 0;
+    std::uint64_t frames = 0;
+    std::chrono::nanoseconds begin_tick{0};
+    std::chrono::nanoseconds update{0};
+    std::chrono::nanoseconds collision{0};
+    std::chrono::nanoseconds destroy{0};
+    std::chrono::nanoseconds compaction{0};
+    std::chrono::nanoseconds post_update{0};
+    std::chrono::nanoseconds end_tick{0};
+    std::chrono::nanoseconds render{0};
+    // Breakdown of the update phase by Update function, keyed by function address. Each is named
+    // after the most specific component of the first entity seen using it.
+    std::unordered_map<std::uintptr_t, function_timing> update_functions;
+
+    void add(const phase_timings&);
+    // Update functions ordered by decreasing total time.
+    std::vector<const function_timing*> sorted_update_functions() const;
+  };
+  void set_phase_timings(phase_timings* timings) { phase_timings_ = timings; }
+
+  // If set, read-only passes (AI and render extraction) are spread across the pool's threads. The
+  // results are identical either way. The pool must outlive this state (or be unset first).
+  void set_job_pool(JobPool* pool);
+  // Input frames are written to the replay writer (if any) as each tick is simulated.
+  data::ReplayWriter* replay_writer() const { return replay_writer_; }
+  void set_replay_writer(data::ReplayWriter* writer) { replay_writer_ = writer; }
 
 private:
   data::ReplayWriter* replay_writer_ = nullptr;
@@ -97,6 +179,7 @@ private:
   std::size_t compact_counter_ = 0;
   bool game_over_ = false;
   smoothing_data smoothing_data_;
+  phase_timings* phase_timings_ = nullptr;
 
   std::unique_ptr<SimSetup> setup_;
   std::unique_ptr<SimInternals> internals_;
@@ -6,13 +6,14 @@ namespace ii::v0 {
 namespace {
 
 struct AiPlayer : ecs::component {
-  input_frame
-  think(ecs::const_handle h, const Transform& transform, const SimInterface& sim, ai_state& state);
+  static constexpr auto kComponentId = sim_component::kV0AiPlayer;
+  input_frame think(ecs::const_handle h, const Transform& transform, const SimInterface& sim,
+                    ai_state& state) const;
 };
 DEBUG_STRUCT_TUPLE(AiPlayer);
 
 input_frame AiPlayer::think(ecs::const_handle h, const Transform& transform,
-                            const SimInterface& sim, ai_state& state) {
+                            const SimInterface& sim, ai_state& state) const {
   struct target {
     fixed distance_sq = 0;
     vec2 position{0};
@@ -208,7 +209,8 @@ void add_ai(ecs::handle h) {
   h.emplace<AiPlayer>();
 }
 
-std::optional<input_frame> ai_think(const SimInterface& sim, ecs::handle h, ai_state& state) {
+std::optional<input_frame>
+ai_think(const SimInterface& sim, ecs::const_handle h, ai_state& state) {
   if (auto* ai = h.get<AiPlayer>(); ai) {
     return ecs::call<&AiPlayer::think>(h, sim, state);
   }
@@ -13,6 +13,7 @@ namespace {
 using namespace geom;
 
 struct SquareBoss : public ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0SquareBoss;
   static constexpr std::uint32_t kBaseHp = 3250;
   static constexpr std::uint32_t kBiomeHp = 750;
   static constexpr std::uint32_t kTimer = 120;
@@ -89,6 +90,7 @@ struct SquareBoss : public ecs::component {
     bool anti = false;
   };
 
+  SquareBoss() = default;
   SquareBoss(std::uint32_t biome_index, std::uint32_t corner_index)
   : biome_index{biome_index}
   , waypoints{kTurningRadius}
@@ -339,8 +341,8 @@ struct SquareBoss : public ecs::component {
 };
 DEBUG_STRUCT_TUPLE(SquareBoss::special_t, players, timer, rotate);
 DEBUG_STRUCT_TUPLE(SquareBoss::corner_tag, index, anti);
-DEBUG_STRUCT_TUPLE(SquareBoss, waypoints, start, rotation, speed, timer, spawn_timer,
-                   spawn_timer_extra, special_counter, special_attack);
+DEBUG_STRUCT_TUPLE(SquareBoss, biome_index, attack_colour, waypoints, start, rotation, speed, timer,
+                   spawn_timer, spawn_timer_extra, special_counter, special_attack);
 
 }  // namespace
 
@@ -7,6 +7,7 @@ namespace {
 using namespace geom;
 
 struct FollowHub : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0FollowHub;
   static constexpr sound kDestroySound = sound::kPlayerDestroy;
   static constexpr rumble_type kDestroyRumble = rumble_type::kLarge;
 
@@ -57,6 +58,7 @@ struct FollowHub : ecs::component {
     parameters.add(key{'v'}, transform.centre).add(key{'r'}, transform.rotation);
   }
 
+  FollowHub() = default;
   FollowHub(bool big, bool chaser, bool fast) : big{big}, chaser{chaser}, fast{fast} {}
   std::uint32_t timer = 0;
   std::uint32_t count = 0;
@@ -113,6 +115,7 @@ DEBUG_STRUCT_TUPLE(FollowHub, timer, count, dir, big, chaser, fast);
 
 // TODO: add hard variant that... lays bombs when going fast?
 struct Shielder : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0Shielder;
   static constexpr sound kDestroySound = sound::kPlayerDestroy;
   static constexpr rumble_type kDestroyRumble = rumble_type::kLarge;
 
@@ -172,6 +175,7 @@ struct Shielder : ecs::component {
         .add(key{'R'}, shield_angle + pi<fixed> / 2 - pi<fixed> / 8);
   }
 
+  Shielder() = default;
   Shielder(SimInterface& sim, bool power)
   : timer{sim.random(random_source::kGameSequence).uint(kTimer)}
   , power{power}
@@ -229,6 +233,7 @@ DEBUG_STRUCT_TUPLE(Shielder, timer, velocity, target, next_target, spreader, pow
 
 // TODO: add hard variant that shoots... bounces?
 struct Tractor : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0Tractor;
   static constexpr sound kDestroySound = sound::kPlayerDestroy;
   static constexpr rumble_type kDestroyRumble = rumble_type::kLarge;
 
@@ -280,6 +285,7 @@ struct Tractor : ecs::component {
         .add(key{'P'}, power);
   }
 
+  Tractor() = default;
   Tractor(bool power) : power{power} {}
   std::uint32_t timer = kTimer * 4;
   vec2 dir{0};
@@ -365,6 +371,7 @@ DEBUG_STRUCT_TUPLE(Tractor, timer, dir, power, ready, spinning, spoke_r);
 // TODO: redesign look.
 // TODO: redesign shield status effect visuals.
 struct ShieldHub : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0ShieldHub;
   static constexpr sound kDestroySound = sound::kPlayerDestroy;
   static constexpr rumble_type kDestroyRumble = rumble_type::kLarge;
 
@@ -409,6 +416,7 @@ struct ShieldHub : ecs::component {
     parameters.add(key{'v'}, transform.centre).add(key{'r'}, transform.rotation);
   }
 
+  ShieldHub() = default;
   ShieldHub(ecs::const_handle h) : effect_id{h.id()} {}
   ecs::entity_id effect_id;
   std::uint32_t timer = 0;
@@ -463,6 +471,7 @@ struct ShieldHub : ecs::component {
   }
 
   struct ShieldEffect : ecs::component {
+    static constexpr auto kComponentId = sim_component::kV0ShieldEffect;
     static constexpr std::uint32_t kFadeInTime = 90;
     static constexpr std::uint32_t kAnimTime = 240;
     static constexpr std::uint32_t kAnimFadeTime = 40;
@@ -505,7 +514,8 @@ struct ShieldHub : ecs::component {
     }
   };
 };
-DEBUG_STRUCT_TUPLE(ShieldHub, timer, count, dir);
+DEBUG_STRUCT_TUPLE(ShieldHub::ShieldEffect, anim, fade_in, destroy);
+DEBUG_STRUCT_TUPLE(ShieldHub, effect_id, timer, count, dir, target_dir, targets);
 
 }  // namespace
 
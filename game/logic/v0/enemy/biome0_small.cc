@@ -14,6 +14,7 @@ ecs::handle spawn_chaser(SimInterface& sim, std::uint32_t size, const vec2& posi
                          fixed rotation = 0, std::uint32_t stagger = 0);
 
 struct Follow : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0Follow;
   static constexpr sound kDestroySound = sound::kEnemyShatter;
   static constexpr rumble_type kDestroyRumble = rumble_type::kSmall;
 
@@ -47,6 +48,7 @@ struct Follow : ecs::component {
         .add(key{'f'}, colour ? colour::alpha(colour->colour, colour::a::kFill0) : cf);
   }
 
+  Follow() = default;
   Follow(std::uint32_t size, std::optional<vec2> direction, bool in_formation)
   : size{size}
   , in_formation{in_formation}
@@ -185,6 +187,7 @@ ecs::handle spawn_follow(SimInterface& sim, std::uint32_t size, const vec2& posi
 }
 
 struct Chaser : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0Chaser;
   static constexpr sound kDestroySound = sound::kEnemyShatter;
   static constexpr rumble_type kDestroyRumble = rumble_type::kSmall;
 
@@ -214,6 +217,7 @@ struct Chaser : ecs::component {
     parameters.add(key{'v'}, transform.centre).add(key{'r'}, transform.rotation);
   }
 
+  Chaser() = default;
   Chaser(std::uint32_t size, std::uint32_t stagger)
   : timer{kTime - stagger}, size{size}, spreader{.max_distance = 24_fx, .max_n = 6u} {}
   std::uint32_t timer = 0;
@@ -315,6 +319,7 @@ ecs::handle spawn_chaser(SimInterface& sim, std::uint32_t size, const vec2& posi
 }
 
 struct FollowSponge : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0FollowSponge;
   static constexpr sound kDestroySound = sound::kPlayerDestroy;
   static constexpr rumble_type kDestroyRumble = rumble_type::kLarge;
 
@@ -8,6 +8,7 @@ namespace {
 using namespace geom;
 
 struct Square : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0Square;
   static constexpr sound kDestroySound = sound::kEnemyDestroy;
   static constexpr rumble_type kDestroyRumble = rumble_type::kLow;
   static constexpr fixed kSpeed = 1_fx + 3_fx / 4_fx;
@@ -49,6 +50,7 @@ struct Square : ecs::component {
         .add(key{'f'}, cf);
   }
 
+  Square() = default;
   Square(SimInterface& sim, const vec2& dir) : dir{dir}, timer{sim.random(80) + 40} {}
   vec2 dir{0};
   std::uint32_t timer = 0;
@@ -108,6 +110,7 @@ DEBUG_STRUCT_TUPLE(Square, dir, timer, invisible_flash);
 
 // TODO: should wall go faster offscreen?
 struct Wall : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0Wall;
   static constexpr sound kDestroySound = sound::kEnemyDestroy;
   static constexpr rumble_type kDestroyRumble = rumble_type::kLow;
 
@@ -143,6 +146,7 @@ struct Wall : ecs::component {
                  (weak ? shape_flag::kWeakVulnerable : shape_flag::kVulnerable));
   }
 
+  Wall() = default;
   Wall(const vec2& dir, bool anti) : dir{dir}, anti{anti} {}
   vec2 dir{0};
   std::uint32_t timer = 0;
@@ -206,7 +210,7 @@ struct Wall : ecs::component {
     }
   }
 };
-DEBUG_STRUCT_TUPLE(Wall, dir, timer, is_rotating, anti);
+DEBUG_STRUCT_TUPLE(Wall, dir, timer, is_rotating, anti, weak);
 }  // namespace
 
 ecs::handle spawn_square(SimInterface& sim, const vec2& position, const vec2& dir, bool drop) {
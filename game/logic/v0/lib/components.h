@@ -14,16 +14,19 @@ struct drop_data {
 DEBUG_STRUCT_TUPLE(drop_data, counter, compensation);
 
 struct AiFocusTag : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0AiFocusTag;
   std::uint32_t priority = 1;
 };
 DEBUG_STRUCT_TUPLE(AiFocusTag, priority);
 
 struct AiClickTag : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0AiClickTag;
   std::optional<vec2> position;
 };
 DEBUG_STRUCT_TUPLE(AiClickTag, position);
 
 struct GlobalData : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0GlobalData;
   bool is_run_complete = false;
   drop_data shield_drop;
   drop_data bomb_drop;
@@ -36,17 +39,20 @@ DEBUG_STRUCT_TUPLE(GlobalData, is_run_complete, shield_drop, bomb_drop, walls_vu
                    overmind_wave_count, debug_text);
 
 struct DropTable : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0DropTable;
   std::uint32_t shield_drop_chance = 0;
   std::uint32_t bomb_drop_chance = 0;
 };
 DEBUG_STRUCT_TUPLE(DropTable, shield_drop_chance, bomb_drop_chance);
 
 struct ColourOverride : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0ColourOverride;
   cvec4 colour = colour::kWhite0;
 };
-DEBUG_STRUCT_TUPLE(ColourOverride);
+DEBUG_STRUCT_TUPLE(ColourOverride, colour);
 
 struct Physics : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0Physics;
   fixed mass = 1_fx;
   fixed drag_coefficient = mass;
   vec2 velocity{0};
@@ -64,6 +70,7 @@ struct Physics : ecs::component {
 DEBUG_STRUCT_TUPLE(Physics, mass, drag_coefficient, velocity);
 
 struct EnemyStatus : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0EnemyStatus;
   static constexpr std::uint32_t kStunTicks = 40u;
   static constexpr std::uint32_t kStunHit = 8u;
   static constexpr std::uint32_t kStunResistDecayTime = 12u;
@@ -40,6 +40,8 @@ auto V0SimSetup::parameters(const initial_conditions&) const -> game_parameters
   game_parameters result;
   result.fps = 60;
   result.dimensions = {960, 540};
+  result.collision_index = collision_index_type::kPackedGrid;
+  result.compaction = compaction_order::kSpatial;
   return result;
 }
 
@@ -78,13 +78,11 @@ void render_entity_shape(ecs::const_handle h, const Health* health, const EnemyS
 // Collision.
 //////////////////////////////////////////////////////////////////////////////////
 template <typename ShapeDefinition>
-geom::hit_result
-check_entity_collision(ecs::const_handle h, const geom::check_t& check, const SimInterface& sim) {
-  geom::hit_result result;
+void check_entity_collision(ecs::const_handle h, const geom::check_t& check,
+                            const SimInterface& sim, geom::hit_result& result) {
   geom::check_collision(
       result, check, sim.shape_bank(), ShapeDefinition::construct_shape,
       [&h](geom::parameter_set& parameters) { ShapeDefinition::set_parameters(h, parameters); });
-  return result;
 }
 
 //////////////////////////////////////////////////////////////////////////////////
@@ -20,6 +20,7 @@ TEMPLATE_DEBUG_STRUCT_TUPLE(waypoint_t, v, tag);
 
 template <typename Tag = std::monostate>
 struct WaypointFollower {
+  WaypointFollower() = default;
   WaypointFollower(fixed turn_radius) : turn_radius{turn_radius} {}
   fixed turn_radius = 0_fx;
   std::optional<vec2> direction;
@@ -16,6 +16,7 @@ namespace ii::v0 {
 namespace {
 
 struct Overmind : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0Overmind;
   static constexpr std::uint32_t kSpawnTimer = 60;
   static constexpr std::uint32_t kSpawnTimerBoss = 300;
   static constexpr std::uint32_t kSpawnTimerUpgrade = 180;
@@ -196,7 +197,7 @@ struct Overmind : ecs::component {
     return index >= biomes.size() ? nullptr : v0::get_biome(biomes[index]);
   }
 };
-DEBUG_STRUCT_TUPLE(Overmind, next_wave, spawn_timer, current_wave, wave_list);
+DEBUG_STRUCT_TUPLE(Overmind, next_wave, spawn_timer, current_wave, wave_list, boss_progress);
 
 }  // namespace
 
@@ -2,6 +2,7 @@
 #define II_GAME_LOGIC_V0_PLAYER_LOADOUT_H
 #include "game/common/struct_tuple.h"
 #include "game/logic/ecs/index.h"
+#include "game/logic/sim/component_ids.h"
 #include "game/logic/sim/io/conditions.h"
 #include "game/logic/v0/player/loadout_mods.h"
 #include <map>
@@ -16,6 +17,7 @@ namespace v0 {
 using player_loadout = std::map<mod_id, std::uint32_t>;
 
 struct PlayerLoadout : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0PlayerLoadout;
   player_loadout loadout;
   void add(ecs::handle h, mod_id, const SimInterface&);
   bool has(mod_id) const;
@@ -8,6 +8,7 @@
 #include "game/logic/v0/player/loadout.h"
 #include "game/logic/v0/player/powerup.h"
 #include "game/logic/v0/player/shot.h"
+#include <vector>
 
 namespace ii::v0 {
 namespace {
@@ -23,6 +24,7 @@ struct player_mod_data {
 DEBUG_STRUCT_TUPLE(player_mod_data, shield_refill_timer, bomb_double_trigger_timer);
 
 struct PlayerLogic : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0PlayerLogic;
   static constexpr std::uint32_t kReviveTime = 150;
   static constexpr std::uint32_t kShieldTime = 50;
   static constexpr std::uint32_t kInputTimer = 30;
@@ -66,6 +68,7 @@ struct PlayerLogic : ecs::component {
         .add(key{'o'}, colour::alpha(colour::kOutline, colour.a));
   }
 
+  PlayerLogic() = default;
   PlayerLogic(const vec2& target) : fire_target{target} {}
   std::optional<ecs::entity_id> bubble_id;
   std::uint32_t invulnerability_timer = kReviveTime;
@@ -147,7 +150,7 @@ struct PlayerLogic : ecs::component {
     }
 
     // Click.
-    if (!pc.is_predicted && !click_timer && input.keys & input_frame::kClick) {
+    if (!click_timer && input.keys & input_frame::kClick && !sim.suppress_predicted(pc)) {
       pc.is_clicking = true;
       click_timer = kInputTimer;
     }
@@ -157,8 +160,8 @@ struct PlayerLogic : ecs::component {
       trigger_bomb(h, pc, loadout, transform.centre, sim);
       bomb_timer = kInputTimer;
     }
-    if (!pc.is_predicted && pc.bomb_count && !bomb_timer && !data.bomb_double_trigger_timer &&
-        input.keys & input_frame::kBomb) {
+    if (pc.bomb_count && !bomb_timer && !data.bomb_double_trigger_timer &&
+        input.keys & input_frame::kBomb && !sim.suppress_predicted(pc)) {
       trigger_bomb(h, pc, loadout, transform.centre, sim);
       --pc.bomb_count;
       bomb_timer = kInputTimer;
@@ -176,7 +179,7 @@ struct PlayerLogic : ecs::component {
 
     // Damage.
     auto collision = sim.collide(check_point(shape_flag::kDangerous, transform.centre));
-    if (!pc.is_predicted && !collision.empty()) {
+    if (!collision.empty() && !sim.suppress_predicted(pc)) {
       std::optional<vec2> source;
       for (const auto& c : collision) {
         if (auto* t = c.h.get<Transform>(); t) {
@@ -290,9 +293,12 @@ struct PlayerLogic : ecs::component {
     }
 
     e.rumble(pc.player_number, 20, 1.f, .5f).play(sound::kExplosion, position);
-    for (const auto& c : sim.collide(check_ball(
-             shape_flag::kVulnerable | shape_flag::kWeakVulnerable | shape_flag::kBombVulnerable,
-             position, radius))) {
+    auto check = check_ball(
+        shape_flag::kVulnerable | shape_flag::kWeakVulnerable | shape_flag::kBombVulnerable,
+        position, radius);
+    // Copied out of the arena, since damage may make batched checks of its own.
+    auto hits = sim.collide(std::span{&check, 1}).hits(0);
+    for (const auto& c : std::vector(hits.begin(), hits.end())) {
       if (auto* health = c.h.get<Health>(); health) {
         health->damage(c.h, sim, kBombDamage, damage_type::kBomb, h.id(), position);
       }
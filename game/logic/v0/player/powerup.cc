@@ -38,6 +38,7 @@ void wobble_movement(SimInterface& sim, const Transform& transform, vec2& dir,
 }
 
 struct PlayerBubble : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0PlayerBubble;
   static constexpr std::uint32_t kRotateTime = 120;
   static constexpr fixed kBoundingWidth = 16;
   static constexpr fixed kSpeed = 1;
@@ -71,6 +72,7 @@ struct PlayerBubble : ecs::component {
         .add(key{'O'}, colour::alpha(colour::kOutline, fade(tick_count)));
   }
 
+  PlayerBubble() = default;
   PlayerBubble(std::uint32_t player_number) : player_number{player_number} {}
   std::uint32_t player_number = 0;
   std::uint32_t tick_count = 0;
@@ -101,9 +103,11 @@ struct PlayerBubble : ecs::component {
     }
   }
 };
-DEBUG_STRUCT_TUPLE(PlayerBubble, player_number, tick_count, dir, first_frame, rotate_anti);
+DEBUG_STRUCT_TUPLE(PlayerBubble, player_number, tick_count, dir, first_frame, rotate_anti,
+                   on_screen);
 
 struct ShieldPowerup : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0ShieldPowerup;
   static constexpr std::uint32_t kRotateTime = 150;
   static constexpr fixed kSpeed = 3_fx / 4_fx;
   static constexpr fixed kBoundingWidth = 0;
@@ -151,8 +155,8 @@ struct ShieldPowerup : ecs::component {
 
     transform.rotate(pi<fixed> / 120);
     transform.move(dir * kSpeed * (required ? 3 : 1));
-    if (required && !p.is_predicted &&
-        length_squared(pv) <= kPowerupCollectDistance * kPowerupCollectDistance) {
+    if (required && length_squared(pv) <= kPowerupCollectDistance * kPowerupCollectDistance &&
+        !sim.suppress_predicted(p)) {
       collect(h, transform, sim, ph);
     }
   }
@@ -177,6 +181,7 @@ struct ShieldPowerup : ecs::component {
 DEBUG_STRUCT_TUPLE(ShieldPowerup, timer, dir, first_frame, rotate_anti);
 
 struct BombPowerup : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0BombPowerup;
   static constexpr std::uint32_t kRotateTime = 150;
   static constexpr fixed kSpeed = 3_fx / 4_fx;
   static constexpr fixed kBoundingWidth = 0;
@@ -240,8 +245,8 @@ struct BombPowerup : ecs::component {
 
     transform.rotate(pi<fixed> / 120);
     transform.move(dir * kSpeed * (required ? 3 : 1));
-    if (required && !p.is_predicted &&
-        length_squared(pv) <= kPowerupCollectDistance * kPowerupCollectDistance) {
+    if (required && length_squared(pv) <= kPowerupCollectDistance * kPowerupCollectDistance &&
+        !sim.suppress_predicted(p)) {
       collect(h, transform, sim, ph);
     }
   }
@@ -5,6 +5,9 @@
 #include "game/logic/v0/lib/particles.h"
 #include "game/logic/v0/lib/ship_template.h"
 #include "game/logic/v0/player/loadout.h"
+#include <array>
+#include <span>
+#include <vector>
 
 namespace ii::v0 {
 namespace {
@@ -71,6 +74,7 @@ struct shot_mod_data {
 DEBUG_STRUCT_TUPLE(shot_mod_data, flags, speed, distance_travelled, max_distance, damage);
 
 struct PlayerShot : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0PlayerShot;
   static constexpr fixed kBoundingWidth = 0;
   static constexpr auto kFlags = shape_flag::kNone;
   static constexpr auto z = colour::z::kPlayerShot;
@@ -96,6 +100,7 @@ struct PlayerShot : ecs::component {
   cvec4 colour{0.f};
   shot_mod_data data;
 
+  PlayerShot() = default;
   PlayerShot(ecs::entity_id player, std::uint32_t player_number, bool is_predicted,
              const PlayerLoadout& loadout, const vec2& direction)
   : player{player}
@@ -125,17 +130,26 @@ struct PlayerShot : ecs::component {
       return;
     }
 
-    if (+(data.flags & shot_flags::kHomingShots) && !(data.flags & shot_flags::kSniperSplit)) {
+    // Both checks are against the current position, so they can be made in one batch.
+    bool homing =
+        +(data.flags & shot_flags::kHomingShots) && !(data.flags & shot_flags::kSniperSplit);
+    std::array checks{
+        check_point(shape_flag::kVulnerable | shape_flag::kWeakVulnerable | shape_flag::kShield |
+                        shape_flag::kWeakShield,
+                    transform.centre),
+        check_ball(shape_flag::kVulnerable | shape_flag::kWeakVulnerable, transform.centre,
+                   shot_mod_data::kHomingScanRadius)};
+    const auto& collision_arena = sim.collide(std::span{checks}.first(homing ? 2 : 1));
+
+    if (homing) {
       std::optional<vec2> target;
       fixed max_t = 0;
-      auto c_list = sim.collide(check_ball(shape_flag::kVulnerable | shape_flag::kWeakVulnerable,
-                                           transform.centre, shot_mod_data::kHomingScanRadius));
       // TODO: really want to use closest point on potential target shape to our shot, rather
       // than target centre. Otherwise e.g. bosses less likely to be targeted since big, so far
       // away.
       // TODO: also, ignore offscreen enemies, and shielded ones.
-      for (const auto& c : c_list) {
-        for (const auto& vc : c.shape_centres) {
+      for (const auto& c : collision_arena.hits(1)) {
+        for (const auto& vc : collision_arena.shape_centres(c)) {
           if (vc == transform.centre) {
             continue;
           }
@@ -169,9 +183,10 @@ struct PlayerShot : ecs::component {
       destroy = true;
       destroy_particles = direction;
     }
-    auto collision = sim.collide(check_point(shape_flag::kVulnerable | shape_flag::kWeakVulnerable |
-                                                 shape_flag::kShield | shape_flag::kWeakShield,
-                                             transform.centre));
+    // Damage runs arbitrary game code, which may make its own batched checks and so overwrite the
+    // arena, so the hits are copied out first.
+    auto hits = collision_arena.hits(0);
+    std::vector collision(hits.begin(), hits.end());
     for (const auto& e : collision) {
       if (e.h.has<Destroy>() ||
           !(e.hit_mask & (shape_flag::kVulnerable | shape_flag::kWeakVulnerable))) {
@@ -233,7 +248,7 @@ struct PlayerShot : ecs::component {
     }
   }
 };
-DEBUG_STRUCT_TUPLE(PlayerShot, player, player_number, is_predicted, direction, data);
+DEBUG_STRUCT_TUPLE(PlayerShot, player, player_number, is_predicted, direction, colour, data);
 
 ecs::handle
 spawn_player_shot(SimInterface& sim, const vec2& position, const PlayerShot& shot_data) {
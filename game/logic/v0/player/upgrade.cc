@@ -106,6 +106,7 @@ render_mod_icon(const SimInterface& sim, const mod_data& data, std::uint32_t ani
 
 // TODO: needs a better effect on pickup.
 struct ModUpgrade : ecs::component {
+  static constexpr auto kComponentId = sim_component::kV0ModUpgrade;
   static constexpr std::int32_t kPanelPadding = 8;
   static constexpr std::uint32_t kTitleFontSize = 14;
   static constexpr std::uint32_t kSlotFontSize = 12;
@@ -115,6 +116,7 @@ struct ModUpgrade : ecs::component {
   static constexpr fixed kPanelBorder = 48;
   static constexpr float kIconWidth = kPanelHeight.to_float() - 3 * kPanelPadding - kTitleFontSize;
 
+  ModUpgrade() = default;
   ModUpgrade(v0::mod_id id, upgrade_position position) : mod_id{id}, position{position} {}
   v0::mod_id mod_id = v0::mod_id::kNone;
   upgrade_position position = upgrade_position::kL0;
@@ -235,6 +235,15 @@ result<game_options_t> parse_args(std::vector<std::string>& args) {
     return unexpected(r.error());
   }
 
+  if (auto r = flag_parse<bool>(args, "canonical_worker", options.canonical_worker, false); !r) {
+    return unexpected(r.error());
+  }
+  if (auto r = flag_parse<bool>(args, "speculative_prediction", options.speculative_prediction,
+                                false);
+      !r) {
+    return unexpected(r.error());
+  }
+
   if (auto r = flag_parse<bool>(args, "windowed", options.windowed, false); !r) {
     return unexpected(r.error());
   }
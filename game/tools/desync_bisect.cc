@@ -0,0 +1,312 @@
+#include "game/common/printer.h"
+#include "game/common/result.h"
+#include "game/data/replay.h"
+#include "game/flags.h"
+#include "game/io/file/std_filesystem.h"
+#include "game/logic/sim/io/conditions.h"
+#include "game/logic/sim/io/output.h"
+#include "game/logic/sim/sim_state.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Finds the first tick at which two simulations of a game diverge, and what differs. Each side is
+// a replay; given one replay, it's simulated twice to check for nondeterminism. Both sides are
+// advanced together, comparing snapshots every checkpoint interval; once a mismatch is found, the
+// interval since the last matching checkpoint is bisected by restoring snapshots, so that only a
+// few ticks are re-simulated. Finally, portable dumps of the first diverging states are compared
+// entity-by-entity.
+//
+// Snapshots are only comparable within a build, so this can't compare two builds directly (use
+// tools/replay_diff.sh to compare their dumps once this has narrowed things down).
+namespace ii {
+namespace {
+
+struct options_t {
+  std::uint64_t checkpoint_interval = 0;
+  std::optional<std::uint64_t> max_ticks;
+  std::uint32_t max_entities = 0;
+};
+
+struct side_t {
+  std::string name;
+  initial_conditions conditions;
+  // Input frames for each tick. Ticks past the end of the replay get default input.
+  std::vector<std::vector<input_frame>> inputs;
+  std::optional<SimState> sim;
+
+  std::vector<input_frame> input(std::uint64_t tick) const {
+    return tick < inputs.size() ? inputs[tick] : std::vector<input_frame>{};
+  }
+};
+
+struct checkpoint_t {
+  std::uint64_t tick = 0;
+  std::vector<std::uint8_t> a;
+  std::vector<std::uint8_t> b;
+};
+
+result<side_t> load_side(const std::string& path) {
+  io::StdFilesystem fs{".", ".", "."};
+  auto bytes = fs.read(path);
+  if (!bytes) {
+    return unexpected("error: couldn't read " + path + ": " + bytes.error());
+  }
+  auto reader = data::ReplayReader::create(*bytes);
+  if (!reader) {
+    return unexpected("error: " + path + ": " + reader.error());
+  }
+  side_t side;
+  side.name = path;
+  side.conditions = reader->initial_conditions();
+  while (reader->current_input_frame() < reader->total_input_frames()) {
+    side.inputs.emplace_back(reader->next_tick_input_frames());
+    if (auto r = reader->status(); !r) {
+      return unexpected("error: " + path + ": " + r.error());
+    }
+  }
+  side.sim.emplace(side.conditions);
+  return {std::move(side)};
+}
+
+bool game_over(const side_t& a, const side_t& b) {
+  return a.sim->game_over() && b.sim->game_over();
+}
+
+void advance(side_t& side, std::uint64_t to_tick) {
+  while (side.sim->tick_count() < to_tick) {
+    side.sim->update(side.input(side.sim->tick_count()));
+    side.sim->output().clear();
+  }
+}
+
+result<void> restore(side_t& a, side_t& b, const checkpoint_t& checkpoint) {
+  if (auto r = a.sim->restore(checkpoint.a); !r) {
+    return unexpected("error: restoring snapshot: " + r.error());
+  }
+  if (auto r = b.sim->restore(checkpoint.b); !r) {
+    return unexpected("error: restoring snapshot: " + r.error());
+  }
+  return {};
+}
+
+checkpoint_t make_checkpoint(const side_t& a, const side_t& b) {
+  return {a.sim->tick_count(), a.sim->snapshot(), b.sim->snapshot()};
+}
+
+// Returns the first tick at which the states differ, if any, leaving both sides at that tick (or at
+// the end of the game).
+result<std::optional<std::uint64_t>>
+find_divergence(const options_t& options, side_t& a, side_t& b) {
+  auto good = make_checkpoint(a, b);
+  if (good.a != good.b) {
+    return {std::optional<std::uint64_t>{0u}};
+  }
+  std::optional<checkpoint_t> bad;
+  while (!game_over(a, b) && !(options.max_ticks && good.tick >= *options.max_ticks)) {
+    auto tick = good.tick + options.checkpoint_interval;
+    if (options.max_ticks) {
+      tick = std::min(tick, *options.max_ticks);
+    }
+    advance(a, tick);
+    advance(b, tick);
+    auto checkpoint = make_checkpoint(a, b);
+    if (checkpoint.a != checkpoint.b) {
+      bad = std::move(checkpoint);
+      break;
+    }
+    good = std::move(checkpoint);
+  }
+  if (!bad) {
+    return {std::optional<std::uint64_t>{}};
+  }
+  std::cout << "diverged between checkpoints at ticks " << good.tick << " and " << bad->tick
+            << ", bisecting..." << std::endl;
+
+  while (bad->tick - good.tick > 1) {
+    auto mid = good.tick + (bad->tick - good.tick) / 2;
+    if (auto r = restore(a, b, good); !r) {
+      return unexpected(r.error());
+    }
+    advance(a, mid);
+    advance(b, mid);
+    auto checkpoint = make_checkpoint(a, b);
+    if (checkpoint.a == checkpoint.b) {
+      good = std::move(checkpoint);
+    } else {
+      bad = std::move(checkpoint);
+    }
+  }
+  if (auto r = restore(a, b, good); !r) {
+    return unexpected(r.error());
+  }
+  advance(a, bad->tick);
+  advance(b, bad->tick);
+  return {std::optional<std::uint64_t>{bad->tick}};
+}
+
+// Portable state dump split into the global header and one block of lines per entity.
+struct dump_t {
+  std::vector<std::string> header;
+  std::map<std::string, std::vector<std::string>> entities;
+};
+
+dump_t dump_state(const SimState& sim) {
+  SimState::query query;
+  query.portable = true;
+  Printer printer;
+  sim.dump(printer, query);
+
+  dump_t dump;
+  std::istringstream ss{printer.extract()};
+  std::vector<std::string>* block = &dump.header;
+  for (std::string line; std::getline(ss, line);) {
+    if (line.starts_with("[@ ")) {
+      block = &dump.entities[line];
+    } else if (!line.empty()) {
+      block->emplace_back(line);
+    }
+  }
+  return dump;
+}
+
+// Prints the first differing line of each block, along with the component it belongs to.
+void report_block(const std::string& name, const std::vector<std::string>& a,
+                  const std::vector<std::string>& b) {
+  auto trim = [](const std::string& s) {
+    return s.substr(std::min(s.find_first_not_of(' '), s.size()));
+  };
+  std::string component = "?";
+  for (std::size_t i = 0; i < std::max(a.size(), b.size()); ++i) {
+    if (i < a.size() && trim(a[i]).starts_with('[')) {
+      component = trim(a[i]);
+    }
+    if (i < a.size() && i < b.size() && a[i] == b[i]) {
+      continue;
+    }
+    std::cout << "  " << name << " " << component << "\n"
+              << "    a: " << (i < a.size() ? trim(a[i]) : "<missing>") << "\n"
+              << "    b: " << (i < b.size() ? trim(b[i]) : "<missing>") << std::endl;
+    return;
+  }
+}
+
+void report_difference(const options_t& options, const side_t& a, const side_t& b,
+                       std::uint64_t tick) {
+  std::cout << "first diverging tick: " << tick << std::endl;
+  if (tick) {
+    auto input_a = a.input(tick - 1);
+    auto input_b = b.input(tick - 1);
+    for (std::size_t i = 0; i < std::max(input_a.size(), input_b.size()); ++i) {
+      if (i >= input_a.size() || i >= input_b.size() || input_a[i] != input_b[i]) {
+        std::cout << "  input for player " << i << " differs at tick " << tick - 1 << std::endl;
+      }
+    }
+  }
+
+  auto dump_a = dump_state(*a.sim);
+  auto dump_b = dump_state(*b.sim);
+  if (dump_a.header != dump_b.header) {
+    report_block("[sim]", dump_a.header, dump_b.header);
+  }
+  std::uint32_t count = 0;
+  auto it_a = dump_a.entities.begin();
+  auto it_b = dump_b.entities.begin();
+  while ((it_a != dump_a.entities.end() || it_b != dump_b.entities.end()) &&
+         count < options.max_entities) {
+    if (it_b == dump_b.entities.end() ||
+        (it_a != dump_a.entities.end() && it_a->first < it_b->first)) {
+      std::cout << "  " << (it_a++)->first << " only exists in a" << std::endl;
+      ++count;
+    } else if (it_a == dump_a.entities.end() || it_b->first < it_a->first) {
+      std::cout << "  " << (it_b++)->first << " only exists in b" << std::endl;
+      ++count;
+    } else {
+      if (it_a->second != it_b->second) {
+        report_block(it_a->first, it_a->second, it_b->second);
+        ++count;
+      }
+      ++it_a;
+      ++it_b;
+    }
+  }
+  if (!count && dump_a.header == dump_b.header) {
+    std::cout << "  dumps are identical: states differ only in internal layout, function pointers "
+                 "or collision index"
+              << std::endl;
+  }
+}
+
+bool run(const options_t& options, const std::vector<std::string>& paths) {
+  auto a = load_side(paths.front());
+  if (!a) {
+    std::cerr << a.error() << std::endl;
+    return false;
+  }
+  auto b = load_side(paths.back());
+  if (!b) {
+    std::cerr << b.error() << std::endl;
+    return false;
+  }
+  std::cout << "a: " << a->name << " (" << a->inputs.size() << " ticks)\n"
+            << "b: " << b->name << " (" << b->inputs.size() << " ticks)" << std::endl;
+
+  auto tick = find_divergence(options, *a, *b);
+  if (!tick) {
+    std::cerr << tick.error() << std::endl;
+    return false;
+  }
+  if (!*tick) {
+    std::cout << "no divergence after " << a->sim->tick_count() << " ticks" << std::endl;
+    return true;
+  }
+  report_difference(options, *a, *b, **tick);
+  return false;
+}
+
+result<options_t> parse_args(std::vector<std::string>& args) {
+  options_t options;
+  if (auto r = flag_parse<std::uint64_t>(args, "checkpoint_interval", options.checkpoint_interval,
+                                         256u);
+      !r) {
+    return unexpected(r.error());
+  }
+  if (!has_help_flag() && !options.checkpoint_interval) {
+    return unexpected("error: invalid checkpoint interval");
+  }
+  if (auto r = flag_parse(args, "max_ticks", options.max_ticks); !r) {
+    return unexpected(r.error());
+  }
+  if (auto r = flag_parse<std::uint32_t>(args, "max_entities", options.max_entities, 8u); !r) {
+    return unexpected(r.error());
+  }
+  return {std::move(options)};
+}
+
+}  // namespace
+}  // namespace ii
+
+int main(int argc, const char** argv) {
+  std::vector<std::string> args;
+  ii::args_init(args, argc, argv);
+  auto options = ii::parse_args(args);
+  if (!options) {
+    std::cerr << options.error() << std::endl;
+    return 1;
+  }
+  if (auto result = ii::args_finish(args); !result) {
+    std::cerr << result.error() << std::endl;
+    return 1;
+  }
+  if (args.empty() || args.size() > 2) {
+    std::cerr << "expected one or two replay paths" << std::endl;
+    return 1;
+  }
+  return ii::run(*options, args) ? 0 : 1;
+}
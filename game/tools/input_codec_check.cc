@@ -0,0 +1,194 @@
+#include "game/data/input_codec.h"
+#include "game/flags.h"
+#include "game/logic/sim/io/player.h"
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Checks that the input frame codec round-trips, and that the decoder rejects malformed data
+// (which it can be given straight off the network) rather than reading past it.
+namespace ii {
+namespace {
+using bytes_t = std::vector<std::uint8_t>;
+
+input_frame frame(vec2 velocity, std::uint32_t keys = 0) {
+  input_frame f;
+  f.velocity = velocity;
+  f.keys = keys;
+  return f;
+}
+
+input_frame absolute(vec2 target) {
+  input_frame f;
+  f.target_absolute = target;
+  return f;
+}
+
+input_frame relative(vec2 target) {
+  input_frame f;
+  f.target_relative = target;
+  return f;
+}
+
+fixed internal(std::int64_t v) {
+  return fixed::from_internal(v);
+}
+
+// Encodes each chunk with one encoder, and decodes them in turn with one decoder.
+result<void>
+round_trip(std::uint32_t player_count, const std::vector<std::vector<input_frame>>& chunks) {
+  data::InputFrameEncoder encoder{player_count};
+  data::InputFrameDecoder decoder{player_count};
+  for (std::size_t i = 0; i < chunks.size(); ++i) {
+    bytes_t bytes;
+    encoder.encode(chunks[i], bytes);
+    std::vector<input_frame> decoded;
+    if (auto r = decoder.decode(bytes, chunks[i].size(), decoded); !r) {
+      return unexpected("chunk " + std::to_string(i) + ": " + r.error());
+    }
+    if (decoded.size() != chunks[i].size()) {
+      return unexpected("chunk " + std::to_string(i) + ": wrong frame count");
+    }
+    for (std::size_t j = 0; j < decoded.size(); ++j) {
+      // A relative target takes precedence over an absolute one.
+      auto expected = chunks[i][j];
+      if (expected.target_relative) {
+        expected.target_absolute.reset();
+      }
+      if (decoded[j] != expected) {
+        return unexpected("chunk " + std::to_string(i) + ": frame " + std::to_string(j) +
+                          " differs");
+      }
+    }
+  }
+  return {};
+}
+
+// Expects decoding the bytes as the given number of frames to fail.
+result<void> reject(std::uint32_t player_count, const bytes_t& bytes, std::size_t frame_count) {
+  data::InputFrameDecoder decoder{player_count};
+  std::vector<input_frame> decoded;
+  if (decoder.decode(bytes, frame_count, decoded)) {
+    return unexpected("malformed data was accepted");
+  }
+  return {};
+}
+
+bytes_t encode(std::uint32_t player_count, const std::vector<input_frame>& frames) {
+  bytes_t bytes;
+  data::InputFrameEncoder{player_count}.encode(frames, bytes);
+  return bytes;
+}
+
+struct test_case {
+  std::string name;
+  std::function<result<void>()> run;
+};
+
+std::vector<test_case> test_cases() {
+  auto max = std::numeric_limits<std::int64_t>::max();
+  auto min = std::numeric_limits<std::int64_t>::min();
+  std::vector<input_frame> changing = {frame({1, 2}, input_frame::kFire), frame({-3, 4}),
+                                       absolute({100, 200}), frame({5, -6}, input_frame::kBomb)};
+
+  return {
+      {"empty", [] { return round_trip(2, {{}, {}}); }},
+      {"runs",
+       [] {
+         std::vector<input_frame> frames(40);
+         frames[7] = frame({1, 0}, input_frame::kFire);
+         frames[8] = frames[7];
+         frames[30] = frame({0, -1});
+         return round_trip(3, {frames, frames, std::vector<input_frame>(9)});
+       }},
+      {"runs_per_player",
+       [] {
+         // Each player repeats its own previous frame, though consecutive frames all differ.
+         std::vector<input_frame> frames;
+         for (std::uint32_t i = 0; i < 32; ++i) {
+           frames.emplace_back(
+               frame({i % 2, 0}, i % 2 ? static_cast<std::uint32_t>(input_frame::kBomb) : 0u));
+         }
+         return round_trip(2, {frames});
+       }},
+      {"target_switches",
+       [] {
+         input_frame both = absolute({7, 8});
+         both.target_relative = vec2{-1, 1};
+         return round_trip(1,
+                           {{absolute({10, 20}), relative({1, -1}), relative({1, -1}),
+                             absolute({10, 20}), input_frame{}, relative({0, 0}), both,
+                             absolute({7, 8}), absolute({-7, 8})},
+                            {relative({3, 3}), input_frame{}}});
+       }},
+      {"zigzag_wraparound",
+       [=] {
+         return round_trip(1,
+                           {{frame({internal(max), internal(min)}),
+                             frame({internal(min), internal(max)}), frame({0, internal(-1)}),
+                             absolute({internal(max), 0}), absolute({internal(min), 0}),
+                             relative({internal(min + 1), internal(max - 1)})}});
+       }},
+      {"all_keys",
+       [] {
+         return round_trip(1, {{frame({0, 0}, std::numeric_limits<std::uint32_t>::max()),
+                                frame({0, 0}, 0u), frame({0, 0}, input_frame::kClick)}});
+       }},
+
+      {"truncated_varint", [] { return reject(1, {0x80}, 1); }},
+      {"overlong_varint", [] { return reject(1, bytes_t(11, 0x80), 1); }},
+      {"truncated_frame",
+       [=] {
+         auto bytes = encode(1, changing);
+         bytes.pop_back();
+         return reject(1, bytes, changing.size());
+       }},
+      {"truncated_delta",
+       [=] {
+         auto bytes = encode(1, {frame({internal(max), 0})});
+         bytes.resize(3);
+         return reject(1, bytes, 1);
+       }},
+      {"empty_run", [] { return reject(1, {0x01}, 1); }},
+      {"overlong_run",
+       [] {
+         auto bytes = encode(2, std::vector<input_frame>(6));
+         return reject(2, bytes, 5);
+       }},
+      {"missing_frames",
+       [=] { return reject(1, encode(1, changing), changing.size() + 1); }},
+      {"trailing_bytes",
+       [=] {
+         auto bytes = encode(1, changing);
+         bytes.emplace_back(0);
+         return reject(1, bytes, changing.size());
+       }},
+      {"trailing_frames",
+       [=] { return reject(1, encode(1, changing), changing.size() - 1); }},
+  };
+}
+
+}  // namespace
+}  // namespace ii
+
+int main(int argc, const char** argv) {
+  std::vector<std::string> args;
+  ii::args_init(args, argc, argv);
+  if (auto result = ii::args_finish(args); !result) {
+    std::cerr << result.error() << std::endl;
+    return 1;
+  }
+  int exit = 0;
+  for (const auto& test : ii::test_cases()) {
+    if (auto result = test.run(); !result) {
+      std::cerr << test.name << ": " << result.error() << std::endl;
+      exit = 1;
+    } else {
+      std::cout << test.name << ": ok" << std::endl;
+    }
+  }
+  return exit;
+}
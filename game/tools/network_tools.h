@@ -52,6 +52,9 @@ struct network_options_t {
   std::string topology;
   std::uint64_t max_tick_difference = 0;
   std::uint64_t max_tick_delivery_delay = 0;
+  bool canonical_worker = false;
+  bool speculative_prediction = false;
+  std::uint32_t checksum_tier = 0;
 };
 
 inline result<void> parse_network_args(std::vector<std::string>& args, network_options_t& options) {
@@ -68,6 +71,20 @@ inline result<void> parse_network_args(std::vector<std::string>& args, network_o
       !r) {
     return unexpected(r.error());
   }
+  if (auto r = flag_parse<bool>(args, "canonical_worker", options.canonical_worker, false); !r) {
+    return unexpected(r.error());
+  }
+  if (auto r = flag_parse<bool>(args, "speculative_prediction", options.speculative_prediction,
+                                false);
+      !r) {
+    return unexpected(r.error());
+  }
+  if (auto r = flag_parse<std::uint32_t>(args, "checksum_tier", options.checksum_tier, 0u); !r) {
+    return unexpected(r.error());
+  }
+  if (options.checksum_tier > static_cast<std::uint32_t>(SimState::checksum_tier::kDeep)) {
+    return unexpected("invalid checksum_tier");
+  }
   return {};
 }
 
@@ -82,6 +99,11 @@ struct peer_t {
   , sim{conditions, mapping, &replay_writer, ai_players}
   , peers{peers}
   , engine{std::hash<std::string>{}(id)} {
+    if (this->options.canonical_worker) {
+      sim.enable_canonical_worker();
+    }
+    sim.set_speculative_prediction(this->options.speculative_prediction);
+    sim.set_checksum_tier(static_cast<SimState::checksum_tier>(this->options.checksum_tier));
     for (const auto& pair : mapping.remote) {
       inbox[pair.first];
     }
@@ -16,7 +16,10 @@ namespace {
 struct options_t {
   SimState::query query;
   std::optional<std::uint64_t> dump_state_from_tick;
+  std::uint64_t dump_state_interval = 1;
   std::optional<std::uint64_t> max_ticks;
+  bool stats = false;
+  std::optional<SimSetup::collision_index_type> collision_index;
 
   std::optional<std::uint64_t> verify_ticks;
   std::optional<std::uint64_t> verify_score;
@@ -30,19 +33,22 @@ bool run(const options_t& options, const std::string& replay_path) {
     std::cerr << replay_bytes.error() << std::endl;
     return false;
   }
-  auto results =
-      replay_results(*replay_bytes, options.max_ticks, options.dump_state_from_tick, options.query);
+  auto results = replay_results(*replay_bytes, options.max_ticks, options.dump_state_from_tick,
+                                options.query, options.dump_state_interval, options.stats,
+                                options.collision_index);
   if (!results) {
     std::cerr << results.error() << std::endl;
     return false;
   }
   print_replay_info(std::cout, replay_path, *results);
+  print_index_stats(std::cout, *results);
   for (std::size_t i = 0; i < results->state_dumps.size(); ++i) {
     if (results->state_dumps[i].empty()) {
       continue;
     }
+    auto tick = options.dump_state_from_tick.value_or(0u) + i * options.dump_state_interval;
     std::cout << "\n================================================\n"
-              << "tick " << (options.dump_state_from_tick.value_or(0u) + i) << " state dump\n"
+              << "tick " << tick << " state dump\n"
               << "================================================\n";
     std::cout << results->state_dumps[i] << std::flush;
   }
@@ -86,12 +92,11 @@ bool run(const options_t& options, const std::string& replay_path) {
         ++frames_written;
       }
     }
-    auto out_bytes = writer.write();
-    if (!out_bytes) {
-      std::cerr << out_bytes.error() << std::endl;
+    if (auto r = reader->status(); !r) {
+      std::cerr << r.error() << std::endl;
       return false;
     }
-    auto result = fs.write(*options.convert_out_path, *out_bytes);
+    auto result = writer.flush(fs, *options.convert_out_path);
     if (!result) {
       std::cerr << result.error() << std::endl;
       return false;
@@ -115,6 +120,14 @@ result<options_t> parse_args(std::vector<std::string>& args) {
   if (auto r = flag_parse(args, "dump_tick_to", options.max_ticks); !r) {
     return unexpected(r.error());
   }
+  if (auto r = flag_parse<std::uint64_t>(args, "dump_tick_interval", options.dump_state_interval,
+                                         1u);
+      !r) {
+    return unexpected(r.error());
+  }
+  if (!has_help_flag() && !options.dump_state_interval) {
+    return unexpected("error: invalid dump tick interval");
+  }
 
   std::optional<std::uint64_t> dump_tick;
   if (auto r = flag_parse(args, "dump_tick", dump_tick); !r) {
@@ -134,9 +147,24 @@ result<options_t> parse_args(std::vector<std::string>& args) {
   if (auto r = flag_parse(args, "dump_components", options.query.component_names); !r) {
     return unexpected(r.error());
   }
+  if (auto r = flag_parse<bool>(args, "stats", options.stats, false); !r) {
+    return unexpected(r.error());
+  }
   if (auto r = flag_parse(args, "output", options.convert_out_path); !r) {
     return unexpected(r.error());
   }
+
+  std::optional<std::string> collision_index;
+  if (auto r = flag_parse(args, "collision_index", collision_index); !r) {
+    return unexpected(r.error());
+  }
+  if (collision_index == "grid") {
+    options.collision_index = SimSetup::collision_index_type::kGrid;
+  } else if (collision_index == "packed_grid") {
+    options.collision_index = SimSetup::collision_index_type::kPackedGrid;
+  } else if (collision_index) {
+    return unexpected("error: unknown collision index " + *collision_index);
+  }
   return {std::move(options)};
 }
 
@@ -0,0 +1,178 @@
+#include "game/flags.h"
+#include "game/io/file/std_filesystem.h"
+#include "game/tools/replay_tools.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ii {
+namespace {
+
+struct options_t {
+  std::optional<std::uint64_t> max_ticks;
+  std::uint32_t thread_count = 0;
+};
+
+struct replay_report_t {
+  std::string path;
+  std::uintmax_t file_size = 0;
+  result<replay_results_t> results = unexpected("not run");
+  double seconds = 0.;
+};
+
+result<void> verify(const options_t& options, const replay_results_t& results) {
+  auto frames_read = results.replay_frames_read;
+  if (results.conditions.compatibility == compatibility_level::kLegacy) {
+    ++frames_read;
+  }
+  if (!options.max_ticks && frames_read < results.replay_frames_total) {
+    return unexpected("only " + std::to_string(results.replay_frames_read) + " of " +
+                      std::to_string(results.replay_frames_total) + " replay frames consumed");
+  }
+  return {};
+}
+
+void run_replay(const options_t& options, replay_report_t& report) {
+  io::StdFilesystem fs{".", ".", "."};
+  auto start = std::chrono::steady_clock::now();
+  auto replay_bytes = fs.read(report.path);
+  if (!replay_bytes) {
+    report.results = unexpected(replay_bytes.error());
+    return;
+  }
+  report.results = replay_results(*replay_bytes, options.max_ticks);
+  if (report.results) {
+    if (auto r = verify(options, *report.results); !r) {
+      report.results = unexpected(r.error());
+    }
+  }
+  report.seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool run(const options_t& options, const std::vector<std::string>& paths) {
+  std::vector<replay_report_t> reports;
+  for (const auto& path : paths) {
+    auto& report = reports.emplace_back();
+    report.path = path;
+    std::error_code ec;
+    report.file_size = std::filesystem::file_size(path, ec);
+  }
+  // Threads claim replays largest-first, so that a long replay claimed last doesn't hold up the
+  // whole batch.
+  std::vector<std::size_t> order;
+  for (std::size_t i = 0; i < reports.size(); ++i) {
+    order.emplace_back(i);
+  }
+  std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+    return reports[a].file_size > reports[b].file_size;
+  });
+
+  std::atomic<std::size_t> next_index{0};
+  std::size_t completed = 0;
+  std::mutex mutex;
+  auto thread_count = std::clamp<std::size_t>(options.thread_count, 1u, reports.size());
+  auto batch_start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> threads;
+  for (std::size_t k = 0; k < thread_count; ++k) {
+    threads.emplace_back([&] {
+      for (auto i = next_index++; i < order.size(); i = next_index++) {
+        auto& report = reports[order[i]];
+        run_replay(options, report);
+
+        std::lock_guard lock{mutex};
+        auto p = static_cast<std::uint32_t>(100 * static_cast<float>(++completed) / order.size());
+        std::cout << "[" << p << "%] " << report.path
+                  << (report.results ? "" : " failed: " + report.results.error()) << std::endl;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto batch_seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - batch_start).count();
+
+  std::size_t failures = 0;
+  std::uint64_t total_ticks = 0;
+  std::cout << "================================================\n"
+            << "status\tticks\tticks/s\tscore\tpath\n"
+            << "================================================\n";
+  for (const auto& report : reports) {
+    if (!report.results) {
+      ++failures;
+      std::cout << "FAIL\t-\t-\t-\t" << report.path << ": " << report.results.error() << "\n";
+      continue;
+    }
+    const auto& sim = report.results->sim;
+    total_ticks += sim.tick_count;
+    auto ticks_per_second = report.seconds > 0. ? sim.tick_count / report.seconds : 0.;
+    std::cout << "ok\t" << sim.tick_count << "\t" << std::fixed << std::setprecision(0)
+              << ticks_per_second << "\t" << sim.score << "\t" << report.path << "\n";
+  }
+  std::cout << "================================================\n"
+            << "replays:\t" << reports.size() << " (" << failures << " failed)\n"
+            << "threads:\t" << thread_count << "\n"
+            << "ticks:  \t" << total_ticks << "\n"
+            << "time:   \t" << std::setprecision(2) << batch_seconds << "s\n"
+            << "ticks/s:\t" << std::setprecision(0)
+            << (batch_seconds > 0. ? total_ticks / batch_seconds : 0.) << std::endl;
+  return !failures;
+}
+
+result<options_t> parse_args(std::vector<std::string>& args) {
+  options_t options;
+  if (auto r = flag_parse(args, "max_ticks", options.max_ticks); !r) {
+    return unexpected(r.error());
+  }
+  if (auto r = flag_parse<std::uint32_t>(args, "threads", options.thread_count,
+                                         std::max(1u, std::thread::hardware_concurrency()));
+      !r) {
+    return unexpected(r.error());
+  }
+  if (!has_help_flag() && !options.thread_count) {
+    return unexpected("error: invalid thread count");
+  }
+  return {std::move(options)};
+}
+
+}  // namespace
+}  // namespace ii
+
+int main(int argc, const char** argv) {
+  std::vector<std::string> args;
+  ii::args_init(args, argc, argv);
+  auto options = ii::parse_args(args);
+  if (!options) {
+    std::cerr << options.error() << std::endl;
+    return 1;
+  }
+  if (auto result = ii::args_finish(args); !result) {
+    std::cerr << result.error() << std::endl;
+    return 1;
+  }
+  if (args.empty()) {
+    std::cerr << "no paths" << std::endl;
+    return 1;
+  }
+  auto paths = ii::expand_replay_paths(args);
+  if (!paths) {
+    std::cerr << paths.error() << std::endl;
+    return 1;
+  }
+  if (paths->empty()) {
+    std::cerr << "no replays found" << std::endl;
+    return 1;
+  }
+  return ii::run(*options, *paths) ? 0 : 1;
+}
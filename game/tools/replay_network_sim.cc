@@ -53,6 +53,10 @@ bool run(const network_options_t& options, const std::string& replay_path) {
   std::size_t canonical_frames_written = 0;
   while (replay_reader->current_input_frame() < replay_reader->total_input_frames()) {
     auto inputs = replay_reader->next_tick_input_frames();
+    if (auto r = replay_reader->status(); !r) {
+      std::cerr << r.error() << std::endl;
+      return false;
+    }
     for (std::size_t i = 0; i < inputs.size(); ++i) {
       per_player_inputs[i].emplace_back(inputs[i]);
       if (canonical_frames_written < canonical_results->replay_frames_read) {
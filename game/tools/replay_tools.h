@@ -6,24 +6,87 @@
 #include "game/logic/sim/io/conditions.h"
 #include "game/logic/sim/io/output.h"
 #include "game/logic/sim/sim_state.h"
+#include <algorithm>
+#include <filesystem>
 #include <optional>
 #include <ostream>
 #include <span>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace ii {
 
+inline bool match_glob(std::string_view pattern, std::string_view name) {
+  if (pattern.empty()) {
+    return name.empty();
+  }
+  if (pattern.front() == '*') {
+    for (std::size_t i = 0; i <= name.size(); ++i) {
+      if (match_glob(pattern.substr(1), name.substr(i))) {
+        return true;
+      }
+    }
+    return false;
+  }
+  return !name.empty() && (pattern.front() == '?' || pattern.front() == name.front()) &&
+      match_glob(pattern.substr(1), name.substr(1));
+}
+
+// Expands each argument: directories are searched recursively for replay files, and wildcards
+// (* and ?) in the final path component are matched against the files in its directory.
+inline result<std::vector<std::string>>
+expand_replay_paths(const std::vector<std::string>& args) {
+  std::vector<std::string> paths;
+  for (const auto& arg : args) {
+    std::filesystem::path path{arg};
+    std::error_code ec;
+    if (auto filename = path.filename().string();
+        filename.find_first_of("*?") != std::string::npos) {
+      auto directory = path.has_parent_path() ? path.parent_path() : std::filesystem::path{"."};
+      for (const auto& entry : std::filesystem::directory_iterator{directory, ec}) {
+        if (entry.is_regular_file() && match_glob(filename, entry.path().filename().string())) {
+          paths.emplace_back(entry.path().string());
+        }
+      }
+    } else if (std::filesystem::is_directory(path, ec)) {
+      for (const auto& entry : std::filesystem::recursive_directory_iterator{path, ec}) {
+        if (entry.is_regular_file() && entry.path().extension() == ".wrp") {
+          paths.emplace_back(entry.path().string());
+        }
+      }
+    } else if (std::filesystem::is_regular_file(path, ec)) {
+      paths.emplace_back(arg);
+    } else {
+      return unexpected("error: no such file or directory: " + arg);
+    }
+    if (ec) {
+      return unexpected("error: couldn't read " + arg + ": " + ec.message());
+    }
+  }
+  std::sort(paths.begin(), paths.end());
+  paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+  return {std::move(paths)};
+}
+
 struct replay_results_t {
   initial_conditions conditions;
   sim_results sim;
   std::size_t replay_frames_read = 0;
   std::size_t replay_frames_total = 0;
   std::vector<std::string> state_dumps;
+  // Entity index statistics at the end of the replay, and peak values during it (if collected).
+  std::optional<ecs::index_stats> stats;
+  std::size_t peak_entities = 0;
+  std::size_t peak_bytes = 0;
 };
 
 result<replay_results_t> inline replay_results(
     std::span<const std::uint8_t> replay_bytes,
     std::optional<std::uint64_t> max_ticks = std::nullopt,
-    std::optional<std::uint64_t> dump_state_from_tick = std::nullopt, SimState::query query = {}) {
+    std::optional<std::uint64_t> dump_state_from_tick = std::nullopt, SimState::query query = {},
+    std::uint64_t dump_state_interval = 1, bool collect_stats = false,
+    std::optional<SimSetup::collision_index_type> collision_index = std::nullopt) {
   auto reader = data::ReplayReader::create(replay_bytes);
   if (!reader) {
     return unexpected(reader.error());
@@ -32,9 +95,14 @@ result<replay_results_t> inline replay_results(
   results.conditions = reader->initial_conditions();
   SimState sim{reader->initial_conditions()};
   SimState double_buffer;
+  if (collision_index) {
+    sim.set_collision_index(*collision_index);
+    double_buffer.set_collision_index(*collision_index);
+  }
   std::size_t i = 0;
   while (!sim.game_over()) {
-    if (dump_state_from_tick && sim.tick_count() >= *dump_state_from_tick) {
+    if (dump_state_from_tick && sim.tick_count() >= *dump_state_from_tick &&
+        !((sim.tick_count() - *dump_state_from_tick) % dump_state_interval)) {
       Printer printer;
       sim.dump(printer, query);
       results.state_dumps.emplace_back(printer.extract());
@@ -43,10 +111,29 @@ result<replay_results_t> inline replay_results(
       break;
     }
     sim.update(reader->next_tick_input_frames());
+    if (auto r = reader->status(); !r) {
+      return unexpected("replay failure: " + r.error());
+    }
+    if (collect_stats) {
+      auto stats = sim.stats();
+      results.peak_entities = std::max(results.peak_entities, stats.entities);
+      results.peak_bytes = std::max(results.peak_bytes, stats.total_bytes());
+    }
     if (!(++i % 16)) {
-      auto checksum = sim.checksum();
-      sim.copy_to(double_buffer);
-      if (sim.checksum() != checksum || double_buffer.checksum() != checksum) {
+      // The incremental checksum of the copy is computed from scratch, so this also verifies
+      // modification tracking.
+      auto tier = SimState::checksum_tier::kIncremental;
+      if (!(i % 64)) {
+        // Continue from a restored snapshot now and then, so that replays verify it's exact.
+        tier = SimState::checksum_tier::kDeep;
+        if (auto r = double_buffer.restore(sim.snapshot()); !r) {
+          return unexpected("snapshot failure: " + r.error());
+        }
+      } else {
+        sim.copy_to(double_buffer);
+      }
+      auto checksum = sim.checksum(tier);
+      if (sim.checksum(tier) != checksum || double_buffer.checksum(tier) != checksum) {
         return unexpected("checksum failure");
       }
       std::swap(sim, double_buffer);
@@ -55,6 +142,9 @@ result<replay_results_t> inline replay_results(
     }
   }
   results.sim = sim.results();
+  if (collect_stats) {
+    results.stats = sim.stats();
+  }
   results.replay_frames_read = reader->current_input_frame();
   results.replay_frames_total = reader->total_input_frames();
   return results;
@@ -123,6 +213,27 @@ inline void print_replay_info(std::ostream& os, const std::string& replay_path,
      << "score:          \t" << results.sim.score << std::endl;
 }
 
+inline void print_index_stats(std::ostream& os, const replay_results_t& results) {
+  if (!results.stats) {
+    return;
+  }
+  const auto& s = *results.stats;
+  os << "================================================\n"
+     << "entity index stats\n"
+     << "================================================\n"
+     << "entities:       \t" << s.entities << " (peak " << results.peak_entities << ")\n"
+     << "entity tables:  \t" << s.entity_tables << " / " << s.entity_table_capacity << "\n"
+     << "index bytes:    \t" << s.index_bytes << "\n"
+     << "total bytes:    \t" << s.total_bytes() << " (peak " << results.peak_bytes << ")\n"
+     << "compactions:    \t" << s.compaction_passes << " (" << s.compaction_moves << " moves)\n"
+     << "\nid\tlive\ttomb\tcapacity\tbytes\tname\n";
+  for (const auto& c : s.components) {
+    os << c.id << "\t" << c.live << "\t" << c.tombstones << "\t" << c.capacity << "\t\t"
+       << c.bytes << "\t" << (c.name.empty() ? "?" : c.name) << "\n";
+  }
+  os << std::flush;
+}
+
 }  // namespace ii
 
 #endif
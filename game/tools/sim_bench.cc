@@ -0,0 +1,312 @@
+#include "game/common/job_pool.h"
+#include "game/flags.h"
+#include "game/io/file/std_filesystem.h"
+#include "game/logic/sim/io/output.h"
+#include "game/logic/sim/sim_state.h"
+#include "game/mode_flags.h"
+#include "game/tools/conditions.h"
+#include "game/tools/replay_tools.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ii {
+namespace {
+
+struct options_t {
+  std::optional<std::uint64_t> max_ticks;
+  std::uint32_t repeat = 0;
+  // Worker threads for the sim's job pool; if zero, everything runs on the main thread.
+  std::uint32_t threads = 0;
+
+  std::uint32_t ai_runs = 0;
+  std::uint32_t ai_players = 0;
+  std::uint32_t ai_seed = 0;
+  std::uint64_t ai_max_ticks = 0;
+  compatibility_level compatibility = compatibility_level::kIispaceV0;
+  game_mode mode = game_mode::kStandardRun;
+  initial_conditions::flag flags = initial_conditions::flag::kNone;
+};
+
+struct bench_input_t {
+  std::string name;
+  std::vector<std::uint8_t> replay_bytes;
+};
+
+struct bench_result_t {
+  std::string name;
+  std::uint64_t ticks = 0;
+  double seconds = 0.;
+  // Wall-clock time of each call to SimState::update(), over all repeats.
+  std::vector<std::chrono::nanoseconds> tick_latencies;
+  SimState::phase_timings phases;
+  std::chrono::nanoseconds render{0};
+};
+
+double to_us(std::chrono::nanoseconds d) {
+  return std::chrono::duration<double, std::micro>(d).count();
+}
+
+std::chrono::nanoseconds percentile(const std::vector<std::chrono::nanoseconds>& sorted, double p) {
+  if (sorted.empty()) {
+    return std::chrono::nanoseconds{0};
+  }
+  auto i = static_cast<std::size_t>(p * static_cast<double>(sorted.size()));
+  return sorted[std::min(i, sorted.size() - 1)];
+}
+
+std::string json_string(std::string_view s) {
+  std::string result = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      result += '\\';
+      result += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      std::ostringstream ss;
+      ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << +c;
+      result += ss.str();
+    } else {
+      result += c;
+    }
+  }
+  return result + "\"";
+}
+
+// Runs the replay to completion (or max ticks) the given number of times, timing each tick. Render
+// extraction is timed separately after each update, as the game would do once per frame.
+result<bench_result_t>
+run_bench(const options_t& options, JobPool* pool, const bench_input_t& input) {
+  using clock = std::chrono::steady_clock;
+  bench_result_t bench;
+  bench.name = input.name;
+  for (std::uint32_t k = 0; k < options.repeat; ++k) {
+    auto reader = data::ReplayReader::create(input.replay_bytes);
+    if (!reader) {
+      return unexpected(reader.error());
+    }
+    SimState sim{reader->initial_conditions()};
+    sim.set_phase_timings(&bench.phases);
+    sim.set_job_pool(pool);
+    transient_render_state transients;
+
+    auto start = clock::now();
+    while (!sim.game_over() && !(options.max_ticks && sim.tick_count() >= *options.max_ticks)) {
+      auto frames = reader->next_tick_input_frames();
+      if (auto r = reader->status(); !r) {
+        return unexpected(r.error());
+      }
+      auto tick_start = clock::now();
+      sim.update(std::move(frames));
+      auto tick_end = clock::now();
+      sim.render(transients, /* paused */ false);
+      bench.render += clock::now() - tick_end;
+      bench.tick_latencies.emplace_back(tick_end - tick_start);
+      sim.output().clear();
+    }
+    bench.seconds += std::chrono::duration<double>(clock::now() - start).count();
+    bench.ticks += sim.tick_count();
+  }
+  return {std::move(bench)};
+}
+
+void print_bench(std::ostream& os, bench_result_t& bench) {
+  std::sort(bench.tick_latencies.begin(), bench.tick_latencies.end());
+  std::chrono::nanoseconds update_total{0};
+  for (auto d : bench.tick_latencies) {
+    update_total += d;
+  }
+  // Throughput counts update() time only; render extraction is reported separately.
+  auto ticks_per_second =
+      update_total.count() ? static_cast<double>(bench.ticks) * 1e9 / update_total.count() : 0.;
+
+  os << "    {\"name\": " << json_string(bench.name) << ", \"ticks\": " << bench.ticks
+     << std::fixed << std::setprecision(3) << ", \"seconds\": " << bench.seconds
+     << ", \"ticks_per_second\": " << ticks_per_second
+     << ", \"tick_p50_us\": " << to_us(percentile(bench.tick_latencies, .5))
+     << ", \"tick_p99_us\": " << to_us(percentile(bench.tick_latencies, .99))
+     << ", \"tick_max_us\": " << to_us(percentile(bench.tick_latencies, 1.))
+     << ", \"render_us\": " << to_us(bench.render);
+  // Update phases are only timed when built with --sim_profiler; otherwise they're reported as null
+  // rather than left out, so that an empty breakdown can't be mistaken for a free one.
+  if (!SimState::kProfilerEnabled) {
+    os << ", \"phases_us\": null, \"update_functions_us\": null}";
+    return;
+  }
+  const auto& phases = bench.phases;
+  os << ", \"phases_us\": {\"begin_tick\": " << to_us(phases.begin_tick)
+     << ", \"update\": " << to_us(phases.update) << ", \"collision\": " << to_us(phases.collision)
+     << ", \"destroy\": " << to_us(phases.destroy)
+     << ", \"compaction\": " << to_us(phases.compaction)
+     << ", \"post_update\": " << to_us(phases.post_update)
+     << ", \"end_tick\": " << to_us(phases.end_tick) << "}";
+  os << ", \"update_functions_us\": {";
+  bool first = true;
+  for (const auto* f : phases.sorted_update_functions()) {
+    os << (first ? "" : ", ") << json_string(f->name) << ": " << to_us(f->time);
+    first = false;
+  }
+  os << "}}";
+}
+
+result<std::vector<bench_input_t>>
+load_inputs(const options_t& options, const std::vector<std::string>& args) {
+  std::vector<bench_input_t> inputs;
+  if (!args.empty()) {
+    auto paths = expand_replay_paths(args);
+    if (!paths) {
+      return unexpected(paths.error());
+    }
+    io::StdFilesystem fs{".", ".", "."};
+    for (const auto& path : *paths) {
+      auto bytes = fs.read(path);
+      if (!bytes) {
+        return unexpected("error: couldn't read " + path + ": " + bytes.error());
+      }
+      inputs.emplace_back(bench_input_t{path, std::move(*bytes)});
+    }
+  }
+
+  // Synthesized runs use consecutive fixed seeds, so that results are comparable across commits.
+  for (std::uint32_t i = 0; i < options.ai_runs; ++i) {
+    initial_conditions conditions;
+    conditions.compatibility = options.compatibility;
+    conditions.mode = options.mode;
+    conditions.flags = options.flags;
+    conditions.player_count = options.ai_players;
+    conditions.seed = options.ai_seed + i;
+    fill_standard_run_conditions(conditions);
+
+    std::cerr << "synthesizing ai run (seed " << conditions.seed << ")..." << std::endl;
+    auto run = synthesize_replay(conditions, options.ai_max_ticks, /* save replay */ true);
+    if (!run) {
+      return unexpected("error: ai run failed: " + run.error());
+    }
+    inputs.emplace_back(bench_input_t{"ai:players=" + std::to_string(conditions.player_count) +
+                                          ":seed=" + std::to_string(conditions.seed),
+                                      std::move(*run->replay_bytes)});
+  }
+  return {std::move(inputs)};
+}
+
+bool run(const options_t& options, const std::vector<bench_input_t>& inputs) {
+  std::optional<JobPool> pool;
+  if (options.threads) {
+    pool.emplace(options.threads);
+  }
+  if (!SimState::kProfilerEnabled) {
+    std::cerr << "note: built without --sim_profiler, so per-phase timings are unavailable"
+              << std::endl;
+  }
+  std::vector<bench_result_t> benches;
+  for (const auto& input : inputs) {
+    std::cerr << "running " << input.name << "..." << std::endl;
+    auto bench = run_bench(options, pool ? &*pool : nullptr, input);
+    if (!bench) {
+      std::cerr << "error: " << input.name << ": " << bench.error() << std::endl;
+      return false;
+    }
+    benches.emplace_back(std::move(*bench));
+  }
+
+  bench_result_t total;
+  total.name = "total";
+  for (const auto& bench : benches) {
+    total.ticks += bench.ticks;
+    total.seconds += bench.seconds;
+    total.tick_latencies.insert(total.tick_latencies.end(), bench.tick_latencies.begin(),
+                                bench.tick_latencies.end());
+    total.phases.add(bench.phases);
+    total.render += bench.render;
+  }
+
+  std::cout << "{\n  \"repeat\": " << options.repeat << ",\n  \"threads\": " << options.threads
+            << ",\n  \"profiler\": " << (SimState::kProfilerEnabled ? "true" : "false")
+            << ",\n  \"benchmarks\": [\n";
+  for (auto& bench : benches) {
+    print_bench(std::cout, bench);
+    std::cout << ",\n";
+  }
+  print_bench(std::cout, total);
+  std::cout << "\n  ]\n}" << std::endl;
+  return true;
+}
+
+result<options_t> parse_args(std::vector<std::string>& args) {
+  options_t options;
+  if (auto r = flag_parse(args, "max_ticks", options.max_ticks); !r) {
+    return unexpected(r.error());
+  }
+  if (auto r = flag_parse<std::uint32_t>(args, "repeat", options.repeat, 1u); !r) {
+    return unexpected(r.error());
+  }
+  if (!has_help_flag() && !options.repeat) {
+    return unexpected("error: invalid repeat count");
+  }
+  if (auto r = flag_parse<std::uint32_t>(args, "threads", options.threads, 0u); !r) {
+    return unexpected(r.error());
+  }
+
+  if (auto r = flag_parse<std::uint32_t>(args, "ai_runs", options.ai_runs, 0u); !r) {
+    return unexpected(r.error());
+  }
+  if (auto r = flag_parse<std::uint32_t>(args, "ai_players", options.ai_players, 1u); !r) {
+    return unexpected(r.error());
+  }
+  if (!has_help_flag() && !options.ai_players) {
+    return unexpected("error: invalid player count");
+  }
+  if (auto r = flag_parse<std::uint32_t>(args, "ai_seed", options.ai_seed, 1u); !r) {
+    return unexpected(r.error());
+  }
+  if (auto r = flag_parse<std::uint64_t>(args, "ai_max_ticks", options.ai_max_ticks, 16384u); !r) {
+    return unexpected(r.error());
+  }
+  if (auto r = parse_game_mode(args, options.mode); !r) {
+    return unexpected(r.error());
+  }
+  if (auto r = parse_compatibility_level(args, options.compatibility); !r) {
+    return unexpected(r.error());
+  }
+  if (auto r = parse_initial_conditions_flags(args, options.flags); !r) {
+    return unexpected(r.error());
+  }
+  return {std::move(options)};
+}
+
+}  // namespace
+}  // namespace ii
+
+int main(int argc, const char** argv) {
+  std::vector<std::string> args;
+  ii::args_init(args, argc, argv);
+  auto options = ii::parse_args(args);
+  if (!options) {
+    std::cerr << options.error() << std::endl;
+    return 1;
+  }
+  if (auto result = ii::args_finish(args); !result) {
+    std::cerr << result.error() << std::endl;
+    return 1;
+  }
+  if (args.empty() && !options->ai_runs) {
+    std::cerr << "no paths or ai runs" << std::endl;
+    return 1;
+  }
+  auto inputs = ii::load_inputs(*options, args);
+  if (!inputs) {
+    std::cerr << inputs.error() << std::endl;
+    return 1;
+  }
+  if (inputs->empty()) {
+    std::cerr << "no replays found" << std::endl;
+    return 1;
+  }
+  return ii::run(*options, *inputs) ? 0 : 1;
+}
@@ -1,8 +1,50 @@
 #ifndef II_GAME_VERSION_H
 #define II_GAME_VERSION_H
+#include <cstdint>
+#include <string_view>
+
+// Release builds can pass a unique build ID (e.g. with --copt=-DII_BUILD_ID=\"<commit>\").
+#ifndef II_BUILD_ID
+#define II_BUILD_ID ""
+#endif
 
 namespace ii {
 constexpr const char* kGameVersion = "alpha-1";
+
+namespace detail {
+constexpr std::uint64_t fingerprint_hash(std::uint64_t hash, std::string_view s) {
+  for (char c : s) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+  }
+  return (hash ^ 0xff) * 0x100000001b3;
+}
+
+constexpr std::uint64_t fingerprint_hash(std::uint64_t hash, std::uint64_t v) {
+  for (std::uint32_t i = 0; i < 8; ++i) {
+    hash = (hash ^ ((v >> (8 * i)) & 0xff)) * 0x100000001b3;
+  }
+  return hash;
+}
+}  // namespace detail
+
+// Identifies the build: the game version, build ID, compiler and target. Data that depends on the
+// exact build, like sim snapshots, can record it to reject data from other builds.
+constexpr std::uint64_t kBuildFingerprint = [] {
+  std::uint64_t hash = 0xcbf29ce484222325;
+  hash = detail::fingerprint_hash(hash, kGameVersion);
+  hash = detail::fingerprint_hash(hash, II_BUILD_ID);
+#if defined(__VERSION__)
+  hash = detail::fingerprint_hash(hash, __VERSION__);
+#elif defined(_MSC_FULL_VER)
+  hash = detail::fingerprint_hash(hash, static_cast<std::uint64_t>(_MSC_FULL_VER));
+#endif
+  hash = detail::fingerprint_hash(hash, static_cast<std::uint64_t>(sizeof(void*)));
+#ifdef NDEBUG
+  hash = detail::fingerprint_hash(hash, std::uint64_t{1});
+#endif
+  return hash;
+}();
+
 }  // namespace ii
 
-#endif
\ No newline at end of file
+#endif
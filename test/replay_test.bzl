@@ -1,11 +1,11 @@
 load("//test:exe_test.bzl", "exe_test")
 
-def replay_test(replay = "", score = 0, **kwargs):
+def replay_test(replay = "", score = 0, prefix = "", extra_args = [], **kwargs):
   exe_test(
-    name = Label(replay).name,
+    name = "%s%s" % (prefix + "_" if prefix else "", Label(replay).name),
     bin = "//game/tools:replay",
     deps = [replay],
-    args = ["--verify_score", "%s" % score, "$(location %s)" % replay],
+    args = ["--verify_score", "%s" % score, "$(location %s)" % replay] + extra_args,
     size = "medium",
     **kwargs,
   )
\ No newline at end of file
@@ -13,13 +13,24 @@ TICK_INCREMENT="${6}"
 echo "Finding diff between ${REPLAY_TOOL_A} and ${REPLAY_TOOL_B} of ${REPLAY_FILE}..."
 echo "Ticks from ${TICK_START} to ${TICK_END} incrementing by ${TICK_INCREMENT}:"
 
+# Each tool simulates the replay once, dumping every tick to be checked; the output is then split
+# into one file per tick.
 TMP_DIR=$(mktemp -d)
+for SIDE in a b; do
+  [[ "${SIDE}" == a ]] && REPLAY_TOOL="${REPLAY_TOOL_A}" || REPLAY_TOOL="${REPLAY_TOOL_B}"
+  echo "Running ${REPLAY_TOOL}"
+  "${REPLAY_TOOL}" "${REPLAY_FILE}" "--dump_portable" "--dump_tick_from=${TICK_START}" \
+    "--dump_tick_to=${TICK_END}" "--dump_tick_interval=${TICK_INCREMENT}" |
+    awk -v dir="${TMP_DIR}" -v side="${SIDE}" '
+      /^tick [0-9]+ state dump$/ { if (out) close(out); out = dir "/" $2 "_" side ".txt" }
+      out && !/^=+$/ { print > out }'
+done
+
 for ((I=TICK_START; I <= TICK_END; I += TICK_INCREMENT)); do
   echo "Checking tick ${I}"
   DUMP_A="${TMP_DIR}/${I}_a.txt"
   DUMP_B="${TMP_DIR}/${I}_b.txt"
-  "${REPLAY_TOOL_A}" "${REPLAY_FILE}" "--dump_portable" "--dump_tick=${I}" > "${DUMP_A}"
-  "${REPLAY_TOOL_B}" "${REPLAY_FILE}" "--dump_portable" "--dump_tick=${I}" > "${DUMP_B}"
+  touch "${DUMP_A}" "${DUMP_B}"
   echo "    diff ${DUMP_A} ${DUMP_B}"
   diff "${DUMP_A}" "${DUMP_B}" || (echo "Found diff at tick ${I}" && exit 1)
 done